@@ -71,6 +71,40 @@ typedef struct
 	} core;
 } DualPID_t;
 
+#define PID_BANK_MAX 16U //< 一个PID组可容纳的单环PID数
+
+/**
+ * @brief PID组：多个单环PID的参数和状态按字段分开成数组，PIDBank_Update()一次遍历计算全部，
+ *        每个PID的结果与 One_Pid_Ctrl() 逐位一致
+ * @note  下标为 PIDBank_Add() 的添加顺序
+ */
+typedef struct
+{
+	uint8_t num;
+	float P[PID_BANK_MAX];
+	float I[PID_BANK_MAX];
+	float D[PID_BANK_MAX];
+	float p_part_maxlimit[PID_BANK_MAX];
+	float i_part_maxlimit[PID_BANK_MAX];
+	float d_part_maxlimit[PID_BANK_MAX];
+	float i_part_detach_lower[PID_BANK_MAX];
+	float i_part_detach_upper[PID_BANK_MAX];
+	float max_limit[PID_BANK_MAX];
+	float i_delta_sum[PID_BANK_MAX];
+	float delta_last[PID_BANK_MAX];
+	float out[PID_BANK_MAX];
+} PIDBank_t;
+
+/**
+ * @brief PIDBank_Benchmark() 的结果，DEBUG构建中用调试器查看
+ */
+typedef struct
+{
+	uint32_t scalar_cycles; // 逐个调用 One_Pid_Ctrl() 计算一组PID的最少周期数
+	uint32_t bank_cycles;   // PIDBank_Update() 计算同一组PID的最少周期数
+	uint8_t match;          // 两种方式的输出和状态逐位一致时为1
+} PIDBank_Bench_t;
+
 float One_Pid_Ctrl(float target, float feedback, SinglePID_t *PID);
 float Double_Pid_Ctrl(float shell_target, float shell_feedback, float core_feedback, DualPID_t *PID);
 void BasePID_Init(SinglePID_t *single_pid,
@@ -79,5 +113,11 @@ void BasePID_Init(SinglePID_t *single_pid,
 					float iPartDetach_lower, float iPartDetach_upper,
 					float OutputLimit);
 void DualPID_Init(DualPID_t *dual_pid, SinglePID_t *shell_single_pid, SinglePID_t *core_single_pid);
+uint8_t PIDBank_Add(PIDBank_t *bank, const SinglePID_t *pid);
+void PIDBank_Reset(PIDBank_t *bank, uint8_t index);
+const float *PIDBank_Update(PIDBank_t *bank, const float *target, const float *feedback);
+#ifdef DEBUG
+void PIDBank_Benchmark(PIDBank_Bench_t *result);
+#endif
 
 #endif
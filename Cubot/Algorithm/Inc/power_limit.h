@@ -0,0 +1,47 @@
+#ifndef _POWER_LIMIT_H_
+#define _POWER_LIMIT_H_
+
+#include "stm32h7xx_hal.h"
+
+/**
+ * @brief 底盘功率模型与缓冲能量策略的参数
+ * @note  电流为电调控制量（M3508为正负16384对应正负20A），转速为转子转速（rpm）。
+ *        单个电机的电功率 = k_mech·I·ω + k_copper·I² + k_iron·ω²，底盘总功率再加 p_static
+ */
+typedef struct
+{
+    float k_mech;          //< 机械功率系数（W / (控制量·rpm)），即转矩常数换算到控制量和rpm
+    float k_copper;        //< 铜损系数（W / 控制量²），含电调导通损耗
+    float k_iron;          //< 随转速的损耗系数（W / rpm²），含铁损和摩擦
+    float p_static;        //< 与电流、转速无关的底盘静态功率（W）
+    float buffer_reserve;  //< 保留的缓冲能量（J），低于该值时允许功率低于上限，使缓冲能量回升
+    float buffer_spend_s;  //< 超出保留部分的缓冲能量按该时间常数用掉（s）
+    float boost_max;       //< 用缓冲能量时允许超出功率上限的最大值（W）
+    float trim_gain;       //< 缓冲能量低于保留值时允许功率的积分修正速率（W / (J·s)），补偿模型低估的功率
+    float fallback_limit;  //< 尚未收到裁判系统功率上限时使用的上限（W）
+} PowerLimit_Config_t;
+
+/**
+ * @brief 功率控制器状态，每个控制周期由 PowerLimit_Apply() 更新，各字段可直接用于遥测
+ */
+typedef struct
+{
+    PowerLimit_Config_t config;
+    float limit_w;         //< 裁判系统给出的底盘功率上限（W）
+    float buffer_j;        //< 缓冲能量估计（J）：裁判系统更新时取测量值，两次更新之间按预测的超出功率扣减
+    float trim_w;          //< 允许功率的积分修正（W），不大于0，缓冲能量回到保留值以上后逐渐回零
+    float allow_w;         //< 本周期允许的功率（W）
+    float predict_w;       //< 缩放前的预测功率（W）
+    float output_w;        //< 缩放后的预测功率（W）
+    float scale;           //< 本周期电流缩放比例，1表示未限制
+    uint32_t limited_cnt;  //< 电流被缩放的周期数
+} PowerLimit_t;
+
+extern const PowerLimit_Config_t POWER_LIMIT_CONFIG_3508;
+
+void PowerLimit_Init(PowerLimit_t *power, const PowerLimit_Config_t *config);
+void PowerLimit_SetReferee(PowerLimit_t *power, uint16_t limitW, uint16_t bufferJ);
+float PowerLimit_Predict(const PowerLimit_Config_t *config, const float *current, const float *rpm, uint8_t num);
+float PowerLimit_Apply(PowerLimit_t *power, float *current, const float *rpm, uint8_t num, float dt);
+
+#endif
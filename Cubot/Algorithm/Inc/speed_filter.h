@@ -0,0 +1,52 @@
+#ifndef _SPEED_FILTER_H_
+#define _SPEED_FILTER_H_
+
+#include "stm32h7xx_hal.h"
+
+#define SPEED_FILTER_MA_MAX 16U //< 滑动平均窗口长度上限
+
+/**
+ * @brief 转速估计方式
+ */
+typedef enum {
+    SPEED_FILTER_NONE   = 0x00U, // 直接使用电调上报的转速
+    SPEED_FILTER_MA     = 0x01U, // 上报转速的滑动平均，窗口内按帧计
+    SPEED_FILTER_IIR    = 0x02U, // 上报转速的一阶低通，系数按实际帧间隔计算
+    SPEED_FILTER_KALMAN = 0x03U  // 位置-速度两状态卡尔曼滤波，融合编码器累计刻度与上报转速
+} SpeedFilterType;
+
+/**
+ * @brief 转速估计器，每帧反馈更新一次，各方式每次更新均为常数时间
+ */
+typedef struct
+{
+    uint8_t type;              // SpeedFilterType
+    uint8_t ready;             // 已用第一帧初始化状态
+    float out;                 // 估计的转速（rpm）
+
+    /* 滑动平均 */
+    int16_t ma_buf[SPEED_FILTER_MA_MAX];
+    uint8_t ma_len;            // 窗口长度
+    uint8_t ma_head;           // 下一个写入位置
+    int32_t ma_sum;            // 窗口内转速之和
+
+    /* 一阶低通 */
+    float iir_tau_us;          // 时间常数（微秒）
+
+    /* 卡尔曼滤波，状态为 [位置偏差（刻度）, 转速（rpm）] */
+    float ecd_per_rpm_us;      // 1rpm 每微秒转过的刻度，即 每圈刻度数 / 6e7
+    float q;                   // 转速过程噪声谱密度（rpm^2/s），越大跟踪越快
+    float r_pos;               // 编码器位置测量噪声方差（刻度^2）
+    float r_vel;               // 上报转速测量噪声方差（rpm^2）
+    int64_t pos_ref;           // 位置状态的整数基准，位置状态只保存相对它的小量，避免浮点精度随圈数下降
+    float pos;                 // 相对 pos_ref 的位置（刻度）
+    float p00, p01, p11;       // 协方差矩阵（对称）
+} SpeedFilter_t;
+
+void SpeedFilter_InitMA(SpeedFilter_t *filter, uint8_t len);
+void SpeedFilter_InitIIR(SpeedFilter_t *filter, float tauMs);
+void SpeedFilter_InitKalman(SpeedFilter_t *filter, uint16_t ecdPerRev, float q, float rPos, float rVel);
+void SpeedFilter_Reset(SpeedFilter_t *filter);
+float SpeedFilter_Update(SpeedFilter_t *filter, int64_t ecdCount, int16_t rpm, uint32_t dtUs);
+
+#endif
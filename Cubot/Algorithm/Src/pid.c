@@ -1,5 +1,10 @@
 #include "pid.h"
 #include "user_lib.h"
+#include <math.h>
+#include <string.h>
+#ifdef DEBUG
+#include "driver_timebase.h"
+#endif
 
 /**
  * @brief 单环PID初始化
@@ -146,3 +151,137 @@ float Double_Pid_Ctrl(float shell_target, float shell_feedback, float core_feedb
     PID->core.core_out = LIMIT((PID->core.core_out), -(PID->core.core_max_limit), (PID->core.core_max_limit));
     return PID->core.core_out;
 }
+
+/**
+ * @brief 把一个已初始化的单环PID加入PID组，参数和积分、上次误差等状态一并复制
+ *
+ * @param bank PID组
+ * @param pid  单环PID，加入后不再使用
+ * @return 0表示成功，1表示PID组已满；成功时该PID在组中的下标为加入前的 bank->num
+ */
+uint8_t PIDBank_Add(PIDBank_t *bank, const SinglePID_t *pid)
+{
+	if (bank->num >= PID_BANK_MAX) return 1;
+
+	uint8_t k = bank->num;
+	bank->P[k]                   = pid->P;
+	bank->I[k]                   = pid->I;
+	bank->D[k]                   = pid->D;
+	bank->p_part_maxlimit[k]     = pid->p_part_maxlimit;
+	bank->i_part_maxlimit[k]     = pid->i_part_maxlimit;
+	bank->d_part_maxlimit[k]     = pid->d_part_maxlimit;
+	bank->i_part_detach_lower[k] = pid->i_part_detach_lower;
+	bank->i_part_detach_upper[k] = pid->i_part_detach_upper;
+	bank->max_limit[k]           = pid->max_limit;
+	bank->i_delta_sum[k]         = pid->i_delta_sum;
+	bank->delta_last[k]          = pid->delta_last;
+	bank->out[k]                 = pid->out;
+	bank->num++;
+	return 0;
+}
+
+/**
+ * @brief 清除PID组中一个PID的积分、上次误差和输出，如电机离线或切换模式时
+ *
+ * @param bank  PID组
+ * @param index 下标
+ */
+void PIDBank_Reset(PIDBank_t *bank, uint8_t index)
+{
+	if (index >= bank->num) return;
+	bank->i_delta_sum[index] = 0.0f;
+	bank->delta_last[index]  = 0.0f;
+	bank->out[index]         = 0.0f;
+}
+
+/**
+ * @brief 与LIMIT宏相同的限幅，上下限颠倒或输入为NaN时的结果也相同
+ * @note  写成两次条件选择，Cortex-M7的FPv5编译为比较加VSEL，没有分支
+ */
+static inline float PIDBank_Limit(float x, float lo, float hi)
+{
+	float y = (x > hi) ? hi : x;
+	return (x < lo) ? lo : y;
+}
+
+/**
+ * @brief 计算PID组中的全部PID
+ *
+ * @param bank     PID组
+ * @param target   各PID的目标值，按下标排列
+ * @param feedback 各PID的反馈值
+ * @return 各PID的输出（bank->out），下次调用前有效
+ * @note 每个PID的运算顺序与 One_Pid_Ctrl() 相同，结果逐位一致：积分先累加再计算积分项，
+ *       误差绝对值超出积分分离上下限时在计算积分项之后清零累加值。
+ *       各字段连续存放，一次调用完成全部PID，不经过结构体指针逐个访问；
+ *       N约为10，CMSIS-DSP的逐元素向量函数在M7上只是展开的标量循环，分成多次调用反而多读写中间数组，这里不使用
+ */
+const float *PIDBank_Update(PIDBank_t *bank, const float *target, const float *feedback)
+{
+	for (uint8_t k = 0; k < bank->num; k++)
+	{
+		float delta = target[k] - feedback[k];
+		float p     = PIDBank_Limit(delta * bank->P[k], -bank->p_part_maxlimit[k], bank->p_part_maxlimit[k]);
+
+		float sum = bank->i_delta_sum[k] + delta;
+		float i   = PIDBank_Limit(sum * bank->I[k], -bank->i_part_maxlimit[k], bank->i_part_maxlimit[k]);
+		float mag = fabsf(delta);
+		bank->i_delta_sum[k] = ((mag > bank->i_part_detach_upper[k]) | (mag < bank->i_part_detach_lower[k])) ? 0.0f : sum;
+
+		float d = PIDBank_Limit((delta - bank->delta_last[k]) * bank->D[k], -bank->d_part_maxlimit[k], bank->d_part_maxlimit[k]);
+		bank->delta_last[k] = delta;
+
+		bank->out[k] = PIDBank_Limit(p + i + d, -bank->max_limit[k], bank->max_limit[k]);
+	}
+	return bank->out;
+}
+
+#ifdef DEBUG
+#define PID_BANK_BENCH_NUM    10U // 3个摩擦轮、拨弹盘、4个底盘轮、2个云台轴
+#define PID_BANK_BENCH_ROUNDS 64U
+
+/**
+ * @brief 用DWT周期计数对比逐个调用 One_Pid_Ctrl() 和 PIDBank_Update() 计算同一组PID的耗时，并检查结果逐位一致
+ *
+ * @param result 结果，各取所有轮次中的最少周期数，排除中断的影响
+ * @note 须在Timebase_Init()之后调用，只在DEBUG构建中编译
+ */
+void PIDBank_Benchmark(PIDBank_Bench_t *result)
+{
+	static SinglePID_t pid[PID_BANK_BENCH_NUM];
+	static PIDBank_t bank;
+	float target[PID_BANK_BENCH_NUM], feedback[PID_BANK_BENCH_NUM];
+
+	memset(pid, 0, sizeof(pid));
+	memset(&bank, 0, sizeof(bank));
+	for (uint8_t k = 0; k < PID_BANK_BENCH_NUM; k++)
+	{
+		BasePID_Init(&pid[k], 10.0f + k, 0.1f, 1.0f, 16000.0f, 5000.0f, 3000.0f, 0.0f, 2000.0f, 16000.0f);
+		PIDBank_Add(&bank, &pid[k]);
+	}
+
+	result->scalar_cycles = UINT32_MAX;
+	result->bank_cycles   = UINT32_MAX;
+	result->match         = 1;
+	for (uint32_t r = 0; r < PID_BANK_BENCH_ROUNDS; r++)
+	{
+		for (uint8_t k = 0; k < PID_BANK_BENCH_NUM; k++)
+		{
+			target[k]   = (float)((r * 37U + k * 101U) % 4000U) - 2000.0f;
+			feedback[k] = (float)((r * 53U + k * 29U) % 3000U) - 1500.0f;
+		}
+
+		uint32_t t0 = Timebase_Cycles();
+		for (uint8_t k = 0; k < PID_BANK_BENCH_NUM; k++) One_Pid_Ctrl(target[k], feedback[k], &pid[k]);
+		uint32_t t1 = Timebase_Cycles();
+		PIDBank_Update(&bank, target, feedback);
+		uint32_t t2 = Timebase_Cycles();
+
+		if (t1 - t0 < result->scalar_cycles) result->scalar_cycles = t1 - t0;
+		if (t2 - t1 < result->bank_cycles)   result->bank_cycles   = t2 - t1;
+		for (uint8_t k = 0; k < PID_BANK_BENCH_NUM; k++)
+			if (memcmp(&pid[k].out, &bank.out[k], sizeof(float)) || memcmp(&pid[k].i_delta_sum, &bank.i_delta_sum[k], sizeof(float)))
+				result->match = 0;
+	}
+}
+#endif
@@ -0,0 +1,148 @@
+/**
+ **********************************************************************************
+ * @file        power_limit.c
+ * @brief       算法层，底盘功率控制
+ * @details     由各底盘电机的控制电流和转速按拟合的电机模型预测底盘电功率，
+ *              预测超过允许功率时把所有电机的电流按同一比例缩小，保持各轮电流的比例（即运动方向）不变。
+ *              允许功率 = 裁判系统功率上限 + (缓冲能量 - 保留能量) / 消耗时间常数：
+ *              缓冲能量充足时有计划地超功率加速，接近保留值时收回到上限，低于保留值时低于上限使其回升，
+ *              模型误差由裁判系统反馈的缓冲能量闭环修正，低于保留值的部分同时积分，模型持续低估功率时逐渐压低允许功率。
+ *              缩放比例由预测功率关于比例的二次方程直接求出，每周期常数时间。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * 硬件平台: STM32H750VBT \n
+ * SDK版本：-++++
+ **********************************************************************************
+ ==============================================================================
+                        How to use this module
+ ==============================================================================
+
+    添加power_limit.h
+
+    1. 用PowerLimit_Init()初始化，M3508底盘可直接使用POWER_LIMIT_CONFIG_3508，
+       换用其他电机或减速箱时按实测功率重新拟合 k_mech、k_copper、k_iron、p_static
+
+    2. 裁判系统数据更新后调用PowerLimit_SetReferee()，传入
+       referee2024.game_robot_status.chassis_power_limit 和 referee2024.power_heat_data.buffer_energy
+
+    3. 每个控制周期在速度环算出各轮电流之后、MotorFillData()之前调用PowerLimit_Apply()，
+       传入电流数组（原地缩放）、对应电机的转速和周期（秒）
+
+    4. 用 cubot_power 在主机上对照仿真功率计检查参数：./build-sim/cubot_power
+
+ **********************************************************************************
+ */
+#include "power_limit.h"
+#include <math.h>
+
+/**
+ * @brief M3508（C620，19:1减速箱）的默认参数
+ * @note  k_mech 由转子转矩常数 0.3/19.2 N·m/A、控制量 20/16384 A 和 2π/60 rad/s 换算，
+ *        k_copper 按相电阻与电调导通电阻合计约0.3Ω，k_iron 与 p_static 为空转实测量级
+ */
+const PowerLimit_Config_t POWER_LIMIT_CONFIG_3508 = {
+    .k_mech = 1.997e-6f, .k_copper = 4.47e-7f, .k_iron = 6.0e-8f, .p_static = 3.0f,
+    .buffer_reserve = 10.0f, .buffer_spend_s = 0.4f, .boost_max = 200.0f, .trim_gain = 5.0f,
+    .fallback_limit = 45.0f,
+};
+
+/**
+ * @brief 初始化功率控制器
+ * @param power  功率控制器
+ * @param config 模型与策略参数，NULL时使用POWER_LIMIT_CONFIG_3508
+ * @note  收到裁判系统数据之前按 fallback_limit 限制，缓冲能量按保留值计，不超功率
+ */
+void PowerLimit_Init(PowerLimit_t *power, const PowerLimit_Config_t *config)
+{
+    power->config      = (config != NULL) ? *config : POWER_LIMIT_CONFIG_3508;
+    power->limit_w     = power->config.fallback_limit;
+    power->buffer_j    = power->config.buffer_reserve;
+    power->trim_w      = 0.0f;
+    power->allow_w     = power->limit_w;
+    power->predict_w   = 0.0f;
+    power->output_w    = 0.0f;
+    power->scale       = 1.0f;
+    power->limited_cnt = 0;
+}
+
+/**
+ * @brief 更新裁判系统的功率上限和缓冲能量
+ * @param power   功率控制器
+ * @param limitW  底盘功率上限（W），为0（尚未收到）时使用 fallback_limit
+ * @param bufferJ 缓冲能量（J）
+ */
+void PowerLimit_SetReferee(PowerLimit_t *power, uint16_t limitW, uint16_t bufferJ)
+{
+    power->limit_w  = limitW ? (float)limitW : power->config.fallback_limit;
+    power->buffer_j = (float)bufferJ;
+}
+
+/**
+ * @brief 按电机模型预测底盘电功率
+ * @param config  模型参数
+ * @param current 各电机控制电流（控制量）
+ * @param rpm     各电机转子转速（rpm）
+ * @param num     电机数
+ * @return        预测功率（W），制动电机的回馈功率不计入（按0计），预测偏保守
+ */
+float PowerLimit_Predict(const PowerLimit_Config_t *config, const float *current, const float *rpm, uint8_t num)
+{
+    float p = config->p_static;
+
+    for (uint8_t i = 0; i < num; i++)
+        p += fmaxf(config->k_mech * current[i] * rpm[i], 0.0f) + config->k_copper * current[i] * current[i]
+             + config->k_iron * rpm[i] * rpm[i];
+    return p;
+}
+
+/**
+ * @brief 按允许功率缩放本周期的电流
+ * @param power   功率控制器
+ * @param current 各电机控制电流（控制量），超出允许功率时原地按同一比例缩小
+ * @param rpm     各电机转子转速（rpm）
+ * @param num     电机数
+ * @param dt      控制周期（秒），用于积分修正和在两次裁判系统更新之间扣减缓冲能量估计
+ * @return        缩放比例，0~1
+ * @note  比例为k时预测功率 P(k) = B·k² + A·k + C（A为驱动电机的机械功率之和，B为铜损之和，C为转速损耗和静态功率），
+ *        A、B非负，P(k)单调，取 P(k) = 允许功率 的正根；转速损耗和静态功率已超过允许功率时电流置零
+ */
+float PowerLimit_Apply(PowerLimit_t *power, float *current, const float *rpm, uint8_t num, float dt)
+{
+    const PowerLimit_Config_t *cfg = &power->config;
+    float a = 0.0f, b = 0.0f, c = cfg->p_static;
+
+    for (uint8_t i = 0; i < num; i++)
+    {
+        a += fmaxf(cfg->k_mech * current[i] * rpm[i], 0.0f);
+        b += cfg->k_copper * current[i] * current[i];
+        c += cfg->k_iron * rpm[i] * rpm[i];
+    }
+
+    float margin = power->buffer_j - cfg->buffer_reserve;
+    power->trim_w = fminf(fmaxf(power->trim_w + cfg->trim_gain * margin * dt, -power->limit_w), 0.0f);
+
+    float allow = power->limit_w + margin / cfg->buffer_spend_s + power->trim_w;
+    allow = fminf(fmaxf(allow, 0.0f), power->limit_w + cfg->boost_max);
+
+    float predict = a + b + c;
+    float scale   = 1.0f;
+    if (predict > allow)
+    {
+        // 用 2r/(A+√(A²+4Br)) 求根，B为0（电流全为0）时不除零
+        float room = allow - c;
+        scale = (room > 0.0f) ? 2.0f * room / (a + sqrtf(a * a + 4.0f * b * room)) : 0.0f;
+        for (uint8_t i = 0; i < num; i++) current[i] *= scale;
+        power->limited_cnt++;
+    }
+
+    power->allow_w   = allow;
+    power->predict_w = predict;
+    power->output_w  = (b * scale + a) * scale + c;
+    power->scale     = scale;
+    // 裁判系统两次更新之间（50Hz）按预测的超出功率扣减，下一次更新时由测量值校正
+    power->buffer_j  = fmaxf(power->buffer_j - fmaxf(power->output_w - power->limit_w, 0.0f) * dt, 0.0f);
+    return scale;
+}
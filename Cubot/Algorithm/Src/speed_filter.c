@@ -0,0 +1,195 @@
+/**
+ **********************************************************************************
+ * @file        speed_filter.c
+ * @brief       算法层，电机转速估计
+ * @details     电调上报的转速是量化后的整数，噪声较大。提供三种每帧常数时间的估计方式：
+ *              滑动平均（环形缓冲加累计和）、按实际帧间隔计算系数的一阶低通、
+ *              以及融合编码器累计刻度与上报转速的位置-速度两状态卡尔曼滤波（两个标量观测依次更新，无矩阵求逆）。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * 硬件平台: STM32H750VBT \n
+ * SDK版本：-++++
+ **********************************************************************************
+ ==============================================================================
+                        How to use this module
+ ==============================================================================
+
+    添加speed_filter.h
+
+    1. 用SpeedFilter_InitMA()、SpeedFilter_InitIIR()或SpeedFilter_InitKalman()选择估计方式并设置参数，
+       未初始化（全零）的估计器直接输出上报转速
+
+    2. 每帧反馈调用SpeedFilter_Update()，传入编码器累计刻度、上报转速和与上一帧的实际间隔；
+       间隔为0表示首帧或中断后重新开始，估计器用本帧数据重新初始化
+
+    电机的估计器在rm_motor.c的反馈解算中调用，结果写入TreatedData_t.filter_speed_rpm
+
+ **********************************************************************************
+ */
+#include "speed_filter.h"
+#include <string.h>
+
+/**
+ * @brief 滑动平均初始化
+ * @param filter 估计器
+ * @param len    窗口长度（帧），限制在1~SPEED_FILTER_MA_MAX
+ */
+void SpeedFilter_InitMA(SpeedFilter_t *filter, uint8_t len)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->type   = SPEED_FILTER_MA;
+    filter->ma_len = (len == 0U) ? 1U : (len > SPEED_FILTER_MA_MAX ? SPEED_FILTER_MA_MAX : len);
+}
+
+/**
+ * @brief 一阶低通初始化
+ * @param filter 估计器
+ * @param tauMs  时间常数（毫秒），截止频率为 1/(2*PI*tau)
+ */
+void SpeedFilter_InitIIR(SpeedFilter_t *filter, float tauMs)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->type       = SPEED_FILTER_IIR;
+    filter->iir_tau_us = tauMs * 1000.0f;
+}
+
+/**
+ * @brief 卡尔曼滤波初始化
+ * @param filter    估计器
+ * @param ecdPerRev 编码器每圈刻度数，大疆电机为8192
+ * @param q         转速过程噪声谱密度（rpm^2/s），越大跟踪越快、滤波越弱
+ * @param rPos      编码器位置测量噪声方差（刻度^2），量化噪声约为 1/12
+ * @param rVel      上报转速测量噪声方差（rpm^2）
+ */
+void SpeedFilter_InitKalman(SpeedFilter_t *filter, uint16_t ecdPerRev, float q, float rPos, float rVel)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->type           = SPEED_FILTER_KALMAN;
+    filter->ecd_per_rpm_us = (float)ecdPerRev / 60.0e6f;
+    filter->q              = q;
+    filter->r_pos          = rPos;
+    filter->r_vel          = rVel;
+}
+
+/**
+ * @brief 清除估计器状态，下一帧重新初始化，参数不变
+ */
+void SpeedFilter_Reset(SpeedFilter_t *filter)
+{
+    filter->ready = 0;
+}
+
+/**
+ * @brief 内部函数：用一帧数据初始化状态
+ */
+static void SpeedFilter_Start(SpeedFilter_t *filter, int64_t ecdCount, int16_t rpm)
+{
+    filter->out = rpm;
+
+    switch (filter->type)
+    {
+        case SPEED_FILTER_MA:
+            for (uint8_t i = 0; i < filter->ma_len; i++) filter->ma_buf[i] = rpm;
+            filter->ma_sum  = (int32_t)rpm * filter->ma_len;
+            filter->ma_head = 0;
+            break;
+        case SPEED_FILTER_KALMAN:
+            filter->pos_ref = ecdCount;
+            filter->pos     = 0.0f;
+            filter->p00     = filter->r_pos;
+            filter->p01     = 0.0f;
+            filter->p11     = filter->r_vel;
+            break;
+        default: break;
+    }
+    filter->ready = 1;
+}
+
+/**
+ * @brief 内部函数：卡尔曼滤波一步。匀速模型预测，再依次用位置和转速两个标量观测更新
+ */
+static void SpeedFilter_Kalman(SpeedFilter_t *filter, int64_t ecdCount, int16_t rpm, uint32_t dtUs)
+{
+    float dt  = (float)dtUs * 1.0e-6f;
+    float a   = filter->ecd_per_rpm_us * (float)dtUs; // 1rpm 在本帧间隔内转过的刻度
+    float qdt = filter->q * dt;
+    float vel = filter->out;
+    float s, k0, k1, y, p00, p01, p11;
+
+    /* 预测：pos += a * vel，P = F P F' + Q */
+    filter->pos += a * vel;
+    p00 = filter->p00 + 2.0f * a * filter->p01 + a * a * filter->p11 + qdt * a * a / 3.0f;
+    p01 = filter->p01 + a * filter->p11 + qdt * a / 2.0f;
+    p11 = filter->p11 + qdt;
+
+    /* 位置观测，H = [1 0] */
+    y   = (float)(ecdCount - filter->pos_ref) - filter->pos;
+    s   = p00 + filter->r_pos;
+    k0  = p00 / s;
+    k1  = p01 / s;
+    filter->pos += k0 * y;
+    vel         += k1 * y;
+    p11 -= k1 * p01;
+    p01 -= k0 * p01;
+    p00 -= k0 * p00;
+
+    /* 转速观测，H = [0 1] */
+    y   = (float)rpm - vel;
+    s   = p11 + filter->r_vel;
+    k0  = p01 / s;
+    k1  = p11 / s;
+    filter->pos += k0 * y;
+    vel         += k1 * y;
+    p00 -= k0 * p01;
+    p01 -= k1 * p01;
+    p11 -= k1 * p11;
+
+    /* 位置状态的整数部分移入基准 */
+    int32_t shift    = (int32_t)filter->pos;
+    filter->pos_ref += shift;
+    filter->pos     -= (float)shift;
+
+    filter->p00 = p00;
+    filter->p01 = p01;
+    filter->p11 = p11;
+    filter->out = vel;
+}
+
+/**
+ * @brief 用一帧反馈更新转速估计
+ * @param filter   估计器
+ * @param ecdCount 编码器累计刻度（多圈，不回绕）
+ * @param rpm      电调上报的转速
+ * @param dtUs     与上一帧的实际间隔（微秒），0表示重新开始
+ * @return 估计的转速（rpm）
+ */
+float SpeedFilter_Update(SpeedFilter_t *filter, int64_t ecdCount, int16_t rpm, uint32_t dtUs)
+{
+    if (filter->type == SPEED_FILTER_NONE) return filter->out = rpm;
+    if (!filter->ready || dtUs == 0U)
+    {
+        SpeedFilter_Start(filter, ecdCount, rpm);
+        return filter->out;
+    }
+
+    switch (filter->type)
+    {
+        case SPEED_FILTER_MA:
+            filter->ma_sum += rpm - filter->ma_buf[filter->ma_head];
+            filter->ma_buf[filter->ma_head] = rpm;
+            if (++filter->ma_head >= filter->ma_len) filter->ma_head = 0;
+            filter->out = (float)filter->ma_sum / filter->ma_len;
+            break;
+        case SPEED_FILTER_IIR:
+            filter->out += (float)dtUs / (filter->iir_tau_us + (float)dtUs) * ((float)rpm - filter->out);
+            break;
+        case SPEED_FILTER_KALMAN:
+            SpeedFilter_Kalman(filter, ecdCount, rpm, dtUs);
+            break;
+        default: break;
+    }
+    return filter->out;
+}
@@ -0,0 +1,44 @@
+#ifndef _MOTOR_CYCLE_H_
+#define _MOTOR_CYCLE_H_
+
+#include "stm32h7xx_hal.h"
+#include "driver_can.h"
+
+#define MOTOR_CYCLE_MOTOR_MAX   16U     //< 每路CAN参与同步的电机上限，与电机类型和反馈ID无关
+#define MOTOR_CYCLE_WAITER_MAX  4U      //< 可等待控制周期的任务数上限
+#define MOTOR_CYCLE_TIMEOUT_MS  2U      //< 等待反馈的超时，整条总线无反馈时按该周期运行（1ms节拍下实际为1~2ms）
+
+/**
+ * @brief  控制周期协调器状态，电机位图中 CAN1 的电机占第0-15位，CAN2 的电机占第16-31位，
+ *         按MotorInit()的顺序在各路CAN上依次分配，与电机类型和反馈ID无关
+ * @note   位图和计数在临界区内更新，遥测可直接读取
+ */
+typedef struct
+{
+    uint32_t expected;                      //< 已注册、每周期应到达的电机位图
+    uint32_t arrived;                       //< 本周期已到达的电机位图
+    uint32_t offline;                       //< 判为掉线、不再等待的电机位图，重新收到反馈后恢复
+    uint32_t first_ts;                      //< 本周期最早到达的反馈帧起始时刻（微秒）
+    uint32_t fire_ts;                       //< 最近一次触发时最后到达的反馈帧起始时刻（微秒）
+    volatile uint32_t cycle_cnt;            //< 触发次数（含不完整周期）
+    volatile uint32_t partial_cnt;          //< 不完整周期数：某电机的下一帧先于其他电机到达，缺失的电机本周期沿用旧数据
+    volatile uint32_t timeout_cnt;          //< 等待超时、按固定周期运行的次数
+    volatile uint32_t missing;              //< 最近一个不完整周期缺失的电机位图
+    volatile uint32_t spread_us;            //< 最近一个周期最早与最晚反馈的时间差（微秒）
+    volatile uint32_t wake_latency_us;      //< 最后一帧反馈帧起始到唤醒控制任务（微秒）
+    volatile uint32_t actuate_latency_us;   //< 最后一帧反馈帧起始到控制帧入队（微秒）
+    volatile uint32_t actuate_latency_max;  //< 上述延迟的最大值（微秒）
+    uint8_t motor_num[2];                   //< 每路CAN已分配的位数（含撤销后未回收的位）
+    TaskHandle_t waiter[MOTOR_CYCLE_WAITER_MAX];
+    uint8_t waiter_num;
+} MotorCycle_t;
+
+uint32_t MotorCycle_Expect(CanNumber canx);
+void MotorCycle_Release(CanNumber canx, uint32_t bit);
+void MotorCycle_Arrive(uint32_t bit, uint32_t timestamp);
+uint8_t MotorCycle_Subscribe(TaskHandle_t task);
+uint8_t MotorCycle_Wait(void);
+void MotorCycle_Actuated(void);
+const MotorCycle_t *MotorCycle_Get(void);
+
+#endif
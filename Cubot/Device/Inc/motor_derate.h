@@ -0,0 +1,47 @@
+#ifndef _MOTOR_DERATE_H_
+#define _MOTOR_DERATE_H_
+
+#include "stm32h7xx_hal.h"
+#include "rm_motor.h"
+
+#define MOTOR_DERATE_MAX          16U     //< 可注册降额的电机数上限（不超过32，降额位图为32位）
+#define MOTOR_DERATE_DT_MAX_US    20000U  //< 两次更新间隔超过该值时按该值计算，避免任务长时间挂起后一步跳变
+
+/**
+ * @brief  一个电机的降额参数，电流均以反馈满量程 current_full 归一化
+ */
+typedef struct
+{
+    float soft_temp;      //< 估计温度超过该值开始降额（℃）
+    float hard_temp;      //< 估计温度达到该值时降到 min_scale（℃）
+    float min_scale;      //< 达到硬限时保留的输出比例，0表示切断
+    float current_full;   //< 反馈转矩电流的满量程（M3508/GM6020为16384）
+    float heat_rate;      //< 满量程电流下绕组相对传感器的温升速率（℃/s）
+    float cool_tau_s;     //< 绕组温升回落到传感器温度的时间常数（s）
+    float i2t_cont;       //< 可长时间持续的电流（归一化）
+    float i2t_budget;     //< 超过持续电流部分的 I²t 容量（归一化电流² · s）
+    float slew_per_s;     //< 输出比例每秒最大变化量，使限幅平滑变化
+} MotorDerate_Config_t;
+
+/**
+ * @brief  一个电机的降额状态，供遥测读取
+ */
+typedef struct
+{
+    float temp_est;       //< 估计绕组温度（℃）= 反馈温度 + 模型温升
+    float temp_margin;    //< 距硬限的温度裕量（℃），为负表示已超过硬限
+    float i2t_used;       //< I²t 容量已用比例，0~1
+    float scale;          //< 当前输出比例，1表示不降额
+    int16_t limit;        //< 当前生效的控制量限幅
+} MotorDerate_Telemetry_t;
+
+extern const MotorDerate_Config_t MOTOR_DERATE_CONFIG_3508;
+extern const MotorDerate_Config_t MOTOR_DERATE_CONFIG_6020;
+extern const MotorDerate_Config_t MOTOR_DERATE_CONFIG_2006;
+
+uint8_t MotorDerate_Register(Motor_t *motor, const MotorDerate_Config_t *config);
+void MotorDerate_Update(void);
+uint8_t MotorDerate_Get(uint8_t index, MotorDerate_Telemetry_t *telemetry);
+uint32_t MotorDerate_ActiveMask(void);
+
+#endif
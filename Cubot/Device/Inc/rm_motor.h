@@ -3,25 +3,56 @@
 
 #include "stm32h7xx_hal.h"
 #include "driver_can.h"
+#include "driver_monitor.h"
+#include "speed_filter.h"
 #include "freertos.h"
-#include "semphr.h"
 
 #define K_ECD_TO_ANGLE         0.043945f //< 角度转换编码器刻度的系数：360/8192
 #define ECD_RANGE_FOR_3508     8191      //< 编码器刻度值为0-8191
 #define CURRENT_LIMIT_FOR_3508 16000     //< 控制电流范围为正负16384
 #define ECD_RANGE_FOR_6020     8191      //< 编码器刻度值为0-8191
 #define VOLTAGE_LIMIT_FOR_6020 29000     //< 控制电压范围为正负30000
+#define CURRENT_LIMIT_FOR_6020 16000     //< 电流模式控制电流范围为正负16384
 #define ECD_RANGE_FOR_2006     8191      //< 编码器刻度值为0-8191
 #define CURRENT_LIMIT_FOR_2006 9900      //< 控制电流范围为正负10000
+#define MOTOR_SPEED_DT_MAX_US  20000U    //< 相邻两帧反馈间隔超过该值（微秒）时不做差分测速
+#define MOTOR_DEGRADED_MS      10U       //< 超过该时间没有反馈，电机状态降级
+#define MOTOR_OFFLINE_MS       50U       //< 超过该时间没有反馈，电机判为离线，输出置零
+#define MOTOR_STATS_WINDOW_US  1000000U  //< 反馈统计窗口（微秒），每个窗口结束后发布一次统计
+#define MOTOR_JITTER_BIN_NUM   8U        //< 反馈间隔抖动直方图的档数
+#define MOTOR_TX_DJI_GROUP_NUM 5U        //< 每路CAN的大疆控制帧数：0x1FF、0x200、0x2FF，以及GM6020电流模式的0x1FE、0x2FE
+#define MOTOR_TX_SINGLE_NUM    8U        //< 每路CAN可注册的独占控制帧的电机数（达妙、瓴控等）
+#define MOTOR_TX_GROUP_NUM     (MOTOR_TX_DJI_GROUP_NUM + MOTOR_TX_SINGLE_NUM) //< 每路CAN的控制帧总数
+#define MOTOR_TX_SLOT_BYTES    2U        //< 共用控制帧中每个槽位的字节数
+#define M3508_RATIO_NUM        3591U     //< M3508标准减速箱减速比 3591/187（约19.2）
+#define M3508_RATIO_DEN        187U
+#define M2006_RATIO_NUM        36U       //< M2006标准减速箱减速比 36/1
+#define M2006_RATIO_DEN        1U
+#define DM_MASTER_ID_OFFSET    0x10U     //< 达妙电机反馈ID（MST_ID）= 控制ID（CAN_ID）+ 该偏移，须在上位机中按此设置
+#define DM_P_MAX               3.1415926f//< 达妙电机位置量程 PMAX（rad），须在上位机中设为π，16位位置正好对应转子一圈
+#define DM_V_MAX               30.0f     //< 达妙电机速度量程 VMAX（rad/s），与上位机设置一致（DM4310默认30）
+#define DM_OUTPUT_LIMIT        2047      //< 达妙电机力矩指令范围，正负2047对应正负 TMAX
+#define LK_ID_MIN              0x141U    //< 瓴控电机控制与反馈ID为 0x140 + 电机ID（1-32）
+#define LK_ID_MAX              0x160U
+#define ECD_RANGE_FOR_LK       16383     //< 瓴控MF/MG系列14位编码器
+#define CURRENT_LIMIT_FOR_LK   2000      //< 瓴控转矩闭环指令 iqControl 范围为正负2000
+
 /** 
- * @brief  定义电机种类，用于发送函数的选择
- * @note   GM6020的反馈报文ID为 0x205-0x20B 之间
+ * @brief  定义电机种类，MotorInit()据此选择协议操作表
+ * @note   GM6020的反馈报文ID为 0x205-0x20B 之间，电压模式控制帧为 0x1FF/0x2FF，电流模式为 0x1FE/0x2FE（需较新的电调固件）
+ * @note   同一路CAN上每个反馈ID只能有一个电机，电压与电流模式的GM6020可以混用，各自的控制帧分开发送
  * @note   M3508的反馈报文ID为 0x201-0x208 之间
+ * @note   达妙电机的反馈ID为 MST_ID，控制ID为 MST_ID - DM_MASTER_ID_OFFSET
+ * @note   瓴控电机的反馈与控制ID均为 0x141-0x160
  */
 typedef enum {
     Motor3508 = 0x00U,
     Motor6020 = 0x01U,
-    Motor2006 = 0x02U
+    Motor2006 = 0x02U,
+    MotorDM   = 0x03U, //< 达妙电机，MIT模式，只给前馈力矩（kp = kd = 0）
+    MotorLK   = 0x04U, //< 瓴控电机，转矩闭环命令 0xA1
+    Motor6020Current = 0x05U, //< GM6020电流模式，控制帧 0x1FE/0x2FE，力矩带宽高于电压模式
+    MOTOR_TYPE_NUM
 } motor_type;
 
 /**
@@ -40,24 +71,92 @@ typedef struct
  */
 typedef struct
 {
-    SemaphoreHandle_t dataMutex;
-    int32_t ecd;              //< 当前编码器返回值处理值
+    int32_t ecd;              //< 当前编码器返回值（未做零点越界处理），用于差分测速
     int32_t last_ecd;         //< 上一时刻编码器返回值处理值
 	int32_t treated_ecd;
     float angle;              //< 解算后的编码器角度
 	float last_angle;		  //< 上一时解算后的编码器角
 	int32_t angle_demarcate;
-    int16_t angle_speed;      //< 解算后的编码器角速度
-    int32_t round_cnt;        //< 累计转动圈数
-	int16_t axis_round_cnt;   //< 累计输出轴转动圈数
-    int32_t total_ecd;        //< 编码器累计增量值
-    float total_angle;        //< 累计旋转角度
-	float axis_total_angle;   //< 累计输出轴旋转角度
+    int16_t angle_speed;      //< 编码器差分得到的转速（rpm），按反馈帧实际时间间隔计算
+    int32_t round_cnt;        //< 累计转子圈数（向下取整）
+	int32_t axis_round_cnt;   //< 累计输出轴圈数（向下取整）
+    int64_t total_ecd;        //< 编码器累计刻度，以零点为起点逐帧整数累加，不会漂移
+    double total_angle;       //< 累计转子角度，由 total_ecd 换算
+	double axis_total_angle;  //< 累计输出轴角度，由 total_ecd 按减速比换算
+    uint8_t total_valid;      //< 已收到第一帧，total_ecd 有效
     int32_t motor_output;     //< 输出给电机的值，通常为控制电流或电压
-    int16_t filter_speed_rpm; //< 滑动平均滤波器后的转速
-	uint16_t fps;
+    int16_t filter_speed_rpm; //< 转速估计器（speedFilter）输出的转速，未设置估计器时等于上报转速
+	uint16_t fps;             //< 上一个统计窗口的每秒反馈帧数
+    uint32_t rx_timestamp;     //< 最近一帧反馈的接收时刻（微秒）
+    uint32_t sample_dt_us;     //< 最近两帧反馈的实际间隔（微秒）
+    uint32_t rx_latency_us;    //< 最近一帧从总线接收到完成解算的延迟（微秒）
+    uint32_t rx_latency_max;   //< 上述延迟的最大值（微秒）
 } TreatedData_t;
 
+/**
+ * @brief  一帧电机反馈解算后的快照，控制任务通过 MotorGetSnapshot() 一次取得一致的一组数据
+ */
+typedef struct
+{
+    int16_t raw_ecd;        //< 原始编码器数据
+    int16_t speed_rpm;      //< 转速（rpm）
+    int16_t filter_speed_rpm; //< 估计的转速（rpm）
+    int16_t torque_current; //< 实际转矩电流
+    uint8_t temperature;    //< 温度
+    float angle;            //< 解算后的编码器角度（以零点为中心的±180°）
+    int64_t total_ecd;      //< 编码器累计刻度
+    double total_angle;     //< 累计转子角度
+    double axis_total_angle;//< 累计输出轴角度
+    uint32_t timestamp;     //< 反馈帧的帧起始时刻（微秒）
+} MotorSnapshot_t;
+
+/**
+ * @brief  反馈快照的发布区：序号加双缓冲的顺序锁（seqlock），CAN任务写入时从不等待，读者读取期间序号变化则重读
+ * @note   写者每次更新先加一再写 buf[0]，再加一写 buf[1]；读者按 seq 的奇偶读 buf[seq & 1]，读完复核 seq。
+ *         读者取到的那一份仍可能在读取期间被写者改写（例如读者取到偶数 seq 后开始读 buf[0]，写者随即开始下一次更新），
+ *         此时 seq 已变化，读者丢弃副本重读；读到的快照一致靠的是复核和重读，而不是两份副本互不重叠。
+ *         双缓冲只使写者写一份期间读者可以读另一份，减少重读次数
+ */
+typedef struct
+{
+    volatile uint32_t seq;
+    MotorSnapshot_t buf[2];
+} MotorFeedback_t;
+
+/**
+ * @brief  一个统计窗口内的反馈统计，遥测任务通过 MotorGetStats() 读取
+ * @note   抖动为每帧间隔与平均间隔之差的绝对值，直方图各档上界依次为 5/10/20/50/100/200/500 微秒，最后一档为500微秒以上；
+ *         控制到反馈延迟为所在控制帧入队发送到其后第一帧反馈的时间，大疆电调按自身周期反馈，该值反映两者的相位，
+ *         达妙、瓴控等应答式电机即为指令的往返时间
+ */
+typedef struct
+{
+    uint32_t window_id;        //< 窗口序号，每发布一次加一，0表示尚未发布
+    uint32_t window_us;        //< 窗口实际长度（微秒）
+    uint32_t frames;           //< 窗口内的反馈帧数
+    uint16_t fps;              //< 每秒反馈帧数
+    uint16_t period_us;        //< 平均反馈间隔（微秒）
+    uint32_t gap_max_us;       //< 相邻两帧的最大间隔（微秒），丢帧或电调卡顿时增大
+    uint16_t jitter_hist[MOTOR_JITTER_BIN_NUM]; //< 间隔抖动直方图
+    uint32_t cmd_latency_avg_us; //< 控制到反馈的平均延迟（微秒），窗口内没有新的控制帧时为0
+    uint32_t cmd_latency_max_us; //< 控制到反馈的最大延迟（微秒）
+} MotorStatsReport_t;
+
+/**
+ * @brief  反馈统计：每帧按时间戳做固定次数的累加，窗口结束时整体发布，发布方式与 MotorFeedback_t 相同（顺序锁，读者复核序号后重读）
+ */
+typedef struct
+{
+    volatile uint32_t seq;     //< 发布序号
+    MotorStatsReport_t buf[2]; //< 上一个完整窗口的统计，双缓冲
+    MotorStatsReport_t win;    //< 当前窗口的累计，只由CAN任务访问
+    uint32_t win_start;        //< 当前窗口的起始时刻（微秒）
+    uint32_t period_q4;        //< 反馈间隔的滑动平均（×16）
+    uint32_t cmd_seen;         //< 已计入延迟的最近一次控制帧入队时刻
+    uint32_t latency_sum;      //< 窗口内控制到反馈延迟之和
+    uint32_t latency_cnt;      //< 窗口内控制到反馈延迟的次数
+} MotorStats_t;
+
 /**
  * @brief   电机参数，在初始化函数中确定
  */
@@ -68,33 +167,99 @@ typedef struct
     uint8_t motor_type;       //< 电机类型
     uint16_t ecd_offset;      //< 电机初始零点
     uint16_t ecd_range;       //< 编码器分度值
-    uint16_t reduction_ratio; //< 减速比（电机转子转多少圈输出轴输出一圈）
+    uint16_t reduction_ratio; //< 减速比分子（电机转子转 reduction_ratio 圈输出轴转 ratio_den 圈）
+    uint16_t ratio_den;       //< 减速比分母，整数减速比时为1
     int16_t current_limit;    //< 电调能承受的最大电流
 } MotorParam_t;
 
 
 /**
- * @brief  筛选CAN数据，并更新电机动态数据的回调函数
+ * @brief  控制帧的组织方式
  */
-typedef uint8_t (*Motor_DataUpdate)(RawData_t *raw, TreatedData_t *treated, uint8_t *data); //< 电机发送回调
+typedef enum {
+    MOTOR_TX_GROUP  = 0x00U, //< 多个电机共用一帧，各占一个槽位（大疆 0x200/0x1FF/0x2FF/0x1FE/0x2FE）
+    MOTOR_TX_SINGLE = 0x01U  //< 每个电机独占一帧
+} MotorTxMode;
+
+/**
+ * @brief  一种电机的协议操作表，MotorInit()按电机类型选定，之后收发都按表中的函数和描述进行，不再按类型判断
+ * @note   新的电机只需增加一张操作表并登记到 rm_motor.c 的 motorOps[]，MotorProcess()等无需修改。
+ *         控制帧中只有一个16位控制量随指令变化，由 out_offset/out_le/out_bias 描述，其余字节在初始化时写好
+ */
+typedef struct
+{
+    const char *name;                  //< 名称，同时作为离线检测节点名
+    uint8_t tx_mode;                   //< MotorTxMode
+    uint16_t ecd_range;                //< 反馈中编码器的最大刻度值，一圈为 ecd_range + 1 个刻度
+    int16_t output_limit;              //< 控制量限幅
+    /**
+     * @brief  解析一帧反馈，写入编码器、转速（rpm）、转矩电流、温度
+     * @return 0表示是反馈帧，1表示不是（如命令应答），该帧被忽略
+     */
+    uint8_t (*decode)(RawData_t *raw, const uint8_t *data, uint8_t len);
+    /**
+     * @brief  由反馈ID得到控制帧ID和帧内槽位
+     * @return 0表示成功，1表示ID无效
+     */
+    uint8_t (*map)(uint16_t feedbackId, uint16_t *txId, uint8_t *slot);
+    uint8_t out_offset;                //< 16位控制量在该电机数据段（共用帧为其槽位，独占帧为整帧）中的字节偏移
+    uint8_t out_le;                    //< 控制量为小端时为1
+    int16_t out_bias;                  //< 控制量写入前加上的偏置，如达妙MIT力矩的零点2048
+    const uint8_t *tx_template;        //< 独占帧的8字节初始内容（控制量为0），控制量以外的字节不再改变；共用帧为NULL
+    const uint8_t *enable_frame;       //< 使能命令的8字节数据段，发往控制帧ID；不需要使能时为NULL
+} MotorOps_t;
+
+/**
+ * @brief  一个控制帧（大疆 0x1FF/0x200/0x2FF/0x1FE/0x2FE 或某个电机独占的帧）的发送缓冲区与发送统计
+ * @note   MotorFillData() 置位 dirty，MotorFlush() 只发送有电机注册且 dirty 的帧
+ */
+typedef struct
+{
+    CAN_TxBuffer_t buffer;     //< 发送缓冲区
+    uint8_t motor_mask;        //< 已注册电机在帧中的槽位位图，为0时从不发送
+    volatile uint8_t dirty;    //< 上次发送后有新的控制量写入
+    uint32_t sent_cnt;         //< 已入队发送的次数
+    uint32_t skip_cnt;         //< 有电机注册但无新数据而跳过的次数
+    uint32_t fail_cnt;         //< 发送队列拒绝的次数（保留 dirty，下次再发）
+    volatile uint32_t sent_ts; //< 最近一次入队发送的时刻（微秒），用于统计控制到反馈的延迟
+} MotorTxGroup_t;
 
 /**
- * @brief  电机的数据和参数，以及两个不同电机之间略有区别的成员函数
+ * @brief  电机的数据和参数，以及按电机类型选定的协议操作表
  */
 typedef struct
 {
-    int16_t online_cnt; //< 电机离线检测计数
+    Monitor_Node_t monitor;          //< 离线检测节点，收到反馈即为心跳
     RawData_t rawData;               //< 电机初始动态数据，工作中更新
     TreatedData_t treatedData;       //< 电机处理后的数据，工作中更新
     MotorParam_t param;              //< 电机参数，在初始化时设置
-    Motor_DataUpdate MotorUpdate;    //< 更新电机运行数据的函数指针
+    const MotorOps_t *ops;           //< 协议操作表，在初始化时按电机类型选定
+    MotorTxGroup_t *txGroup;         //< 所在控制帧，在初始化时确定，ID无效或反馈ID已被占用时为NULL
+    uint8_t tx_slot;                 //< 在控制帧中的槽位
+    uint32_t cycle_bit;              //< 在控制周期协调器位图中的位，在初始化时分配，初始化失败时为0
+    uint8_t *tx_hi;                  //< 控制量高字节在控制帧中的位置，在初始化时确定，初始化失败时指向丢弃缓冲区；未经MotorInit()时为NULL，不能调用MotorFillData()
+    uint8_t *tx_lo;                  //< 控制量低字节在控制帧中的位置
+    volatile uint8_t *tx_dirty;      //< 所在控制帧的 dirty 标志
+    int16_t tx_bias;                 //< 控制量写入前加上的偏置，取自操作表
+    int16_t out_min;                 //< 控制量下限，初始化时取操作表的限幅，可由MotorSetOutputLimit()收紧
+    int16_t out_max;                 //< 控制量上限
+    SpeedFilter_t speedFilter;       //< 转速估计器，MotorInit()后用 SpeedFilter_Init*() 选择估计方式
+    MotorFeedback_t feedback;        //< 供其他任务读取的反馈快照
+    MotorStats_t stats;              //< 反馈帧率、间隔抖动和控制到反馈延迟的统计
 } Motor_t;
 
 void Motor_DriverInit(void);
-void MotorInit(Motor_t *motor, uint16_t ecdOffset, motor_type type, uint16_t gearRatio, CanNumber canx, uint16_t id);
-void MotorProcess(CAN_Instance_t *canObject, CAN_RxBuffer_t *bufferRx);
+uint8_t MotorInit(Motor_t *motor, uint16_t ecdOffset, motor_type type, uint16_t gearRatio, CanNumber canx, uint16_t id);
+void MotorProcess(CAN_Instance_t *canObject, const CAN_RxFrame_t *frame, void *ctx);
+uint8_t MotorEnable(Motor_t *motor);
+void MotorSetGearRatio(Motor_t *motor, uint16_t num, uint16_t den);
+void MotorSetOutputLimit(Motor_t *motor, int16_t limit);
 void MotorFillData(Motor_t *motor, int32_t output);
-uint16_t MotorCanOutput(CAN_Instance_t can, int16_t IDforTxBuffer);
+uint32_t MotorGetSnapshot(const Motor_t *motor, MotorSnapshot_t *snapshot);
+uint32_t MotorGetStats(const Motor_t *motor, MotorStatsReport_t *report);
+uint16_t MotorCanOutput(CAN_Instance_t *can, int16_t IDforTxBuffer);
+uint8_t MotorFlush(CAN_Instance_t *can);
+const MotorTxGroup_t *MotorTxGroupGet(CanNumber canx, uint16_t IDforTxBuffer);
 
 
 #endif
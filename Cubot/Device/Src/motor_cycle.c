@@ -0,0 +1,183 @@
+/**
+ **********************************************************************************
+ * @file        motor_cycle.c
+ * @brief       设备层，由电机反馈触发的控制周期协调器
+ * @details     记录每路CAN上应有反馈的电机（任意类型和反馈ID，每路至多 MOTOR_CYCLE_MOTOR_MAX 个），所有电机的新反馈到齐后立即以任务通知唤醒控制任务，
+ *              控制量总是基于刚收到的反馈计算，反馈到控制帧入队的延迟可以直接测量。
+ *              某个电机掉线时，在线电机的下一帧到来即按不完整周期触发，之后不再等待该电机，直到它重新上线；
+ *              整条总线无反馈时控制任务等待超时，按固定周期继续运行。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * 硬件平台: STM32H750VBT \n
+ * SDK版本：-++++
+ **********************************************************************************
+ ==============================================================================
+                        How to use this module
+ ==============================================================================
+
+    添加motor_cycle.h
+
+    1. MotorInit()自动调用MotorCycle_Expect()为电机分配位图中的一位，MotorProcess()按该位调用MotorCycle_Arrive()；
+       该路CAN的位已分配完时MotorInit()返回失败
+
+    2. 控制任务开始时调用MotorCycle_Subscribe(xTaskGetCurrentTaskHandle())，
+       主循环中用MotorCycle_Wait()代替vTaskDelayUntil()，返回1表示反馈到齐触发，0表示超时
+
+    3. 控制帧发出后调用MotorCycle_Actuated()记录反馈到执行的延迟，统计量由MotorCycle_Get()读取
+
+    等待控制周期的任务不能再把任务通知用于其他用途
+
+ **********************************************************************************
+ */
+#include "motor_cycle.h"
+
+static MotorCycle_t cycle;
+
+/**
+ * @brief 登记一个每周期应有反馈的电机，由MotorInit()调用
+ * @param canx 电机所在CAN
+ * @return 分配给电机的位，该路CAN已登记 MOTOR_CYCLE_MOTOR_MAX 个电机时返回0
+ */
+uint32_t MotorCycle_Expect(CanNumber canx)
+{
+    uint8_t can_idx = (canx == CAN2) ? 1 : 0;
+    uint32_t bit    = 0;
+
+    taskENTER_CRITICAL();
+    if (cycle.motor_num[can_idx] < MOTOR_CYCLE_MOTOR_MAX)
+    {
+        bit = 1UL << (cycle.motor_num[can_idx]++ + can_idx * 16U);
+        cycle.expected |= bit;
+    }
+    taskEXIT_CRITICAL();
+    return bit;
+}
+
+/**
+ * @brief 撤销MotorCycle_Expect()的登记，用于MotorInit()中途失败
+ * @param canx 电机所在CAN
+ * @param bit  MotorCycle_Expect()分配的位
+ * @note  撤销的是该路CAN最近分配的一位时回收该位，否则该位保留不用
+ */
+void MotorCycle_Release(CanNumber canx, uint32_t bit)
+{
+    uint8_t can_idx = (canx == CAN2) ? 1 : 0;
+
+    taskENTER_CRITICAL();
+    cycle.expected &= ~bit;
+    cycle.arrived  &= ~bit;
+    cycle.offline  &= ~bit;
+    if (cycle.motor_num[can_idx] > 0U && bit == 1UL << (cycle.motor_num[can_idx] - 1U + can_idx * 16U))
+        cycle.motor_num[can_idx]--;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief 记录一帧电机反馈，本周期的反馈到齐时唤醒所有等待的控制任务，由MotorProcess()调用
+ * @param bit       MotorCycle_Expect()分配给电机的位，为0（未登记）时不处理
+ * @param timestamp 反馈帧的帧起始时刻（微秒）
+ * @note  两路CAN任务都会调用，位图在临界区内更新；唤醒在临界区外进行
+ */
+void MotorCycle_Arrive(uint32_t bit, uint32_t timestamp)
+{
+    uint8_t fire = 0, partial = 0;
+
+    if ((cycle.expected & bit) == 0U) return;
+
+    taskENTER_CRITICAL();
+    cycle.offline &= ~bit;
+
+    if ((cycle.arrived & bit) != 0U)
+    {
+        /* 该电机的下一帧先于其他电机到达：缺失的电机记为掉线，之后的周期不再等待它，
+           这一帧算作新周期的第一帧 */
+        cycle.missing  = cycle.expected & ~cycle.arrived;
+        cycle.offline |= cycle.missing;
+        cycle.partial_cnt++;
+        fire = partial = 1;
+    }
+    else
+    {
+        if (cycle.arrived == 0U) cycle.first_ts = timestamp;
+        cycle.arrived |= bit;
+        fire = ((cycle.arrived | cycle.offline) == cycle.expected);
+    }
+
+    if (fire)
+    {
+        cycle.spread_us = timestamp - cycle.first_ts;
+        cycle.fire_ts   = timestamp;
+        cycle.arrived   = partial ? bit : 0U;
+        cycle.first_ts  = timestamp;
+        cycle.cycle_cnt++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (fire)
+    {
+        cycle.wake_latency_us = Timebase_Us() - timestamp;
+        for (uint8_t i = 0; i < cycle.waiter_num; i++)
+            xTaskNotifyGive(cycle.waiter[i]);
+    }
+}
+
+/**
+ * @brief 登记等待控制周期的任务
+ * @param task 任务句柄，通常为xTaskGetCurrentTaskHandle()
+ * @return 0表示成功，1表示等待者已满
+ */
+uint8_t MotorCycle_Subscribe(TaskHandle_t task)
+{
+    uint8_t ret = 1;
+
+    taskENTER_CRITICAL();
+    if (cycle.waiter_num < MOTOR_CYCLE_WAITER_MAX)
+    {
+        cycle.waiter[cycle.waiter_num++] = task;
+        ret = 0;
+    }
+    taskEXIT_CRITICAL();
+    return ret;
+}
+
+/**
+ * @brief 等待下一个控制周期
+ * @return 1表示反馈到齐（或不完整周期）触发，0表示等待超时或没有登记电机
+ * @note  没有登记电机时等价于延时1ms；等待期间多次触发只返回一次
+ */
+uint8_t MotorCycle_Wait(void)
+{
+    if (cycle.expected == 0U)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1));
+        return 0;
+    }
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MOTOR_CYCLE_TIMEOUT_MS)) > 0U) return 1;
+
+    taskENTER_CRITICAL();
+    cycle.timeout_cnt++;
+    taskEXIT_CRITICAL();
+    return 0;
+}
+
+/**
+ * @brief 控制帧入队后调用，记录最近一个周期最后一帧反馈到执行的延迟
+ */
+void MotorCycle_Actuated(void)
+{
+    uint32_t latency = Timebase_Us() - cycle.fire_ts;
+
+    cycle.actuate_latency_us = latency;
+    if (latency > cycle.actuate_latency_max) cycle.actuate_latency_max = latency;
+}
+
+/**
+ * @brief 读取协调器状态和统计
+ */
+const MotorCycle_t *MotorCycle_Get(void)
+{
+    return &cycle;
+}
@@ -0,0 +1,214 @@
+/**
+ **********************************************************************************
+ * @file        motor_derate.c
+ * @brief       设备层，电机温度与电流降额
+ * @details     在PID输出与MotorFillData()之间按电机的发热情况收紧控制量限幅。
+ *              温度模型：估计绕组温度 = 电调反馈温度 + 模型温升，温升按电流平方上升、按时间常数回落到反馈温度，
+ *              反馈温度变化较慢，模型补上大电流时绕组比传感器先热起来的部分；
+ *              I²t：超过持续电流部分的电流平方对时间积分，用完容量后限幅收到持续电流。
+ *              两者取较小的比例，按速率限制平滑地作用到电机限幅（MotorSetOutputLimit()）。
+ *              所有电机的状态按数组分开存放，每周期一次遍历完成采集、计算和写入，计算部分没有分支。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * 硬件平台: STM32H750VBT \n
+ * SDK版本：-++++
+ **********************************************************************************
+ ==============================================================================
+                        How to use this module
+ ==============================================================================
+
+    添加motor_derate.h
+
+    1. MotorInit()之后调用MotorDerate_Register()，参数为NULL时按电机类型使用默认参数
+       （MOTOR_DERATE_CONFIG_3508等），达妙、瓴控电机须给出参数
+
+    2. Control_Task每个控制周期调用一次MotorDerate_Update()，新的限幅从下一次MotorFillData()起生效；
+       温度和I²t的变化以秒计，晚一个周期没有影响
+
+    3. 遥测用MotorDerate_Get()读取每个电机的估计温度、温度裕量、I²t用量和输出比例，
+       MotorDerate_ActiveMask()一次读取正在降额的电机
+
+    限幅只由本模块写入时，其他地方不要再调用MotorSetOutputLimit()，否则会在下一周期被覆盖
+
+ **********************************************************************************
+ */
+#include "motor_derate.h"
+#include <math.h>
+
+const MotorDerate_Config_t MOTOR_DERATE_CONFIG_3508 = {
+    .soft_temp = 70.0f, .hard_temp = 90.0f, .min_scale = 0.2f, .current_full = 16384.0f,
+    .heat_rate = 2.0f, .cool_tau_s = 60.0f, .i2t_cont = 0.5f, .i2t_budget = 3.0f, .slew_per_s = 2.0f,
+};
+const MotorDerate_Config_t MOTOR_DERATE_CONFIG_6020 = {
+    .soft_temp = 60.0f, .hard_temp = 80.0f, .min_scale = 0.2f, .current_full = 16384.0f,
+    .heat_rate = 1.5f, .cool_tau_s = 60.0f, .i2t_cont = 0.5f, .i2t_budget = 3.0f, .slew_per_s = 2.0f,
+};
+const MotorDerate_Config_t MOTOR_DERATE_CONFIG_2006 = {
+    .soft_temp = 60.0f, .hard_temp = 80.0f, .min_scale = 0.2f, .current_full = 10000.0f,
+    .heat_rate = 3.0f, .cool_tau_s = 30.0f, .i2t_cont = 0.3f, .i2t_budget = 2.0f, .slew_per_s = 2.0f,
+};
+
+/**
+ * @brief  降额状态，按字段分开成数组，计算时逐个电机连续访问
+ * @note   只由调用MotorDerate_Update()的任务写入；遥测读取的各字段均为32位以内，单独读取不会撕裂
+ */
+static struct
+{
+    Motor_t *motor[MOTOR_DERATE_MAX];
+    MotorDerate_Config_t config[MOTOR_DERATE_MAX];
+    float cur2[MOTOR_DERATE_MAX];       // 本周期归一化电流的平方
+    float temp_fb[MOTOR_DERATE_MAX];    // 最近的反馈温度（℃）
+    float rise[MOTOR_DERATE_MAX];       // 模型温升（℃）
+    float temp_est[MOTOR_DERATE_MAX];   // 估计绕组温度（℃）
+    float i2t[MOTOR_DERATE_MAX];        // 已用 I²t
+    float scale[MOTOR_DERATE_MAX];      // 输出比例
+    int16_t limit[MOTOR_DERATE_MAX];    // 已写入电机的限幅
+    uint8_t num;
+    uint8_t started;
+    uint32_t last_us;
+    volatile uint32_t active;           // 输出比例小于1的电机位图
+} derate;
+
+/**
+ * @brief 注册一个需要降额的电机
+ * @param motor  已初始化的电机
+ * @param config 降额参数，NULL表示按电机类型使用默认参数
+ * @return 0表示成功，1表示已满、参数无效或该类型没有默认参数
+ * @note  在初始化阶段调用，不与MotorDerate_Update()并发
+ */
+uint8_t MotorDerate_Register(Motor_t *motor, const MotorDerate_Config_t *config)
+{
+    if (motor == NULL || motor->ops == NULL || derate.num >= MOTOR_DERATE_MAX) return 1;
+
+    if (config == NULL)
+    {
+        switch (motor->param.motor_type)
+        {
+            case Motor3508:        config = &MOTOR_DERATE_CONFIG_3508; break;
+            case Motor6020:
+            case Motor6020Current: config = &MOTOR_DERATE_CONFIG_6020; break;
+            case Motor2006:        config = &MOTOR_DERATE_CONFIG_2006; break;
+            default: return 1;
+        }
+    }
+    if (config->hard_temp <= config->soft_temp || config->current_full <= 0.0f || config->cool_tau_s <= 0.0f
+        || config->i2t_budget <= 0.0f || config->slew_per_s <= 0.0f) return 1;
+
+    uint8_t i = derate.num;
+    derate.motor[i]    = motor;
+    derate.config[i]   = *config;
+    derate.cur2[i]     = 0.0f;
+    derate.temp_fb[i]  = 0.0f;
+    derate.rise[i]     = 0.0f;
+    derate.temp_est[i] = 0.0f;
+    derate.i2t[i]      = 0.0f;
+    derate.scale[i]    = 1.0f;
+    derate.limit[i]    = motor->ops->output_limit;
+    derate.num++;
+    return 0;
+}
+
+/**
+ * @brief 内部函数：把x限制在[lo, hi]，编译为浮点最小/最大值指令，没有分支
+ */
+static inline float MotorDerate_Clamp(float x, float lo, float hi)
+{
+    return fminf(fmaxf(x, lo), hi);
+}
+
+/**
+ * @brief 更新所有已注册电机的温度模型、I²t和限幅
+ * @note  每个控制周期调用一次，时间间隔由微秒时基测得；首次调用只记录时刻
+ */
+void MotorDerate_Update(void)
+{
+    uint32_t now  = Timebase_Us();
+    uint32_t dtUs = derate.started ? now - derate.last_us : 0U;
+    uint8_t num   = derate.num;
+
+    derate.started = 1;
+    derate.last_us = now;
+    if (dtUs > MOTOR_DERATE_DT_MAX_US) dtUs = MOTOR_DERATE_DT_MAX_US;
+    float dt = (float)dtUs * 1.0e-6f;
+
+    /* 1. 采集：一次读取快照，离线电机按零电流计，温度保持最后一次反馈 */
+    for (uint8_t i = 0; i < num; i++)
+    {
+        MotorSnapshot_t snap;
+        Motor_t *motor = derate.motor[i];
+
+        MotorGetSnapshot(motor, &snap);
+        float cur = Monitor_IsOffline(&motor->monitor) ? 0.0f : (float)snap.torque_current / derate.config[i].current_full;
+        derate.cur2[i] = cur * cur;
+        if (snap.timestamp != 0U) derate.temp_fb[i] = (float)snap.temperature;
+    }
+
+    /* 2. 计算：温升、I²t、目标比例和平滑后的比例 */
+    for (uint8_t i = 0; i < num; i++)
+    {
+        const MotorDerate_Config_t *cfg = &derate.config[i];
+        float cont2 = cfg->i2t_cont * cfg->i2t_cont;
+
+        // 温升：按电流平方上升，按时间常数回落（后向欧拉，任意步长都稳定）
+        float rise = (derate.rise[i] + cfg->heat_rate * derate.cur2[i] * dt) * cfg->cool_tau_s / (cfg->cool_tau_s + dt);
+        float temp = derate.temp_fb[i] + rise;
+        float i2t  = MotorDerate_Clamp(derate.i2t[i] + (derate.cur2[i] - cont2) * dt, 0.0f, cfg->i2t_budget);
+
+        // 软限到硬限之间线性降到 min_scale；I²t 用完时降到持续电流
+        float thermal = 1.0f - (1.0f - cfg->min_scale)
+                        * MotorDerate_Clamp((temp - cfg->soft_temp) / (cfg->hard_temp - cfg->soft_temp), 0.0f, 1.0f);
+        float overload = 1.0f - (1.0f - cfg->i2t_cont) * (i2t / cfg->i2t_budget);
+        float target   = fminf(thermal, overload);
+        float step     = cfg->slew_per_s * dt;
+
+        derate.rise[i]     = rise;
+        derate.temp_est[i] = temp;
+        derate.i2t[i]      = i2t;
+        derate.scale[i]   += MotorDerate_Clamp(target - derate.scale[i], -step, step);
+    }
+
+    /* 3. 写入：限幅有变化时才写电机 */
+    uint32_t active = 0;
+    for (uint8_t i = 0; i < num; i++)
+    {
+        Motor_t *motor = derate.motor[i];
+        int16_t limit  = (int16_t)(derate.scale[i] * (float)motor->ops->output_limit);
+
+        if (limit != derate.limit[i])
+        {
+            MotorSetOutputLimit(motor, limit);
+            derate.limit[i] = limit;
+        }
+        if (derate.scale[i] < 1.0f) active |= 1UL << i;
+    }
+    derate.active = active;
+}
+
+/**
+ * @brief 读取一个电机的降额状态
+ * @param index     注册顺序，从0开始
+ * @param telemetry 输出
+ * @return 0表示成功，1表示index无效
+ */
+uint8_t MotorDerate_Get(uint8_t index, MotorDerate_Telemetry_t *telemetry)
+{
+    if (index >= derate.num) return 1;
+
+    telemetry->temp_est    = derate.temp_est[index];
+    telemetry->temp_margin = derate.config[index].hard_temp - derate.temp_est[index];
+    telemetry->i2t_used    = derate.i2t[index] / derate.config[index].i2t_budget;
+    telemetry->scale       = derate.scale[index];
+    telemetry->limit       = derate.limit[index];
+    return 0;
+}
+
+/**
+ * @brief 正在降额（输出比例小于1）的电机位图，第i位对应注册顺序为i的电机
+ */
+uint32_t MotorDerate_ActiveMask(void)
+{
+    return derate.active;
+}
@@ -27,15 +27,31 @@
 
     1. 创建Motor结构体，作为电机实例。
 
-    2. 调用MotorInit()，初始化电机静态数据。
+    2. 调用MotorInit()，初始化电机静态数据。减速比不是整数时（如M3508的3591/187）再调用MotorSetGearRatio()，
+       多圈角度在反馈中以整数刻度累计，转子和输出轴角度由TreatedData_t的total_angle、axis_total_angle给出。
+       需要平滑转速时用SpeedFilter_InitMA()/InitIIR()/InitKalman()设置motor->speedFilter，
+       每帧反馈的估计结果写入filter_speed_rpm，未设置时等于上报转速。
 
-    3. 在启动CAN时注册的CANx_rxCallBack回调中判断ID并添加MotorRxCallback()，接收电机动态数据。
+    3. MotorInit()会通过CAN_Subscribe()为电机反馈ID注册MotorProcess()，CAN任务按ID分发后即更新电机动态数据。
+       电机同时登记到控制周期协调器（motor_cycle.c），所有电机的反馈到齐后唤醒控制任务；
+       并注册为离线检测节点（driver_monitor.c），超过 MOTOR_OFFLINE_MS 没有反馈时MotorFillData()输出置零。
 
-    4. 经过PID计算后产生待发送数据OutputCurrent。
+    4. 其他任务用MotorGetSnapshot()读取一致的反馈快照（编码器、转速、电流、温度、单圈与多圈角度、时间戳），
+       不加锁，CAN任务写入时从不等待；经过PID计算后产生待发送数据OutputCurrent。
+       每帧反馈还按时间戳累计帧率、间隔抖动直方图、最大间隔和控制到反馈延迟，每 MOTOR_STATS_WINDOW_US 发布一次，
+       遥测用MotorGetStats()读取，TreatedData_t的fps为上一个窗口的帧率。
 
-    5. 发送数据应当调用MotorFillData()填写对应控制ID下的待发送数据
+    5. 发送数据应当调用MotorFillData()填写对应控制ID下的待发送数据。
+       收发的协议由电机类型对应的操作表（MotorOps_t）决定：大疆电机共用0x200/0x1FF/0x2FF控制帧，
+       电流模式的GM6020（Motor6020Current）共用0x1FE/0x2FE，每个电机的控制模式由初始化时的类型决定；
+       达妙（MIT模式，只给前馈力矩）和瓴控（转矩闭环）电机各占一帧，在CAN_Open()后须调用MotorEnable()；
+       这两种电机的反馈ID须在init_task.c的CAN过滤器表中加入。新的电机只需增加一张操作表。
+       控制量的写入位置和限幅在MotorInit()中确定，运行中需要降额时调用MotorSetOutputLimit()，
+       按温度和电流自动降额见motor_derate.c
 
-    6. 所有数据填写完毕后调用MotorCanOutput()发送对应CAN设备下特定控制ID的CAN数据
+    6. 所有数据填写完毕后调用MotorFlush()，只发送该CAN设备上有电机注册且填写过新数据的控制帧，
+       各帧在一次临界区内连续压入发送FIFO；MotorTxGroupGet()可读取每个控制帧的发送/跳过次数。
+       MotorCanOutput()无条件发送某一控制帧，保留用于调试
 
  **********************************************************************************
  * @attention
@@ -48,88 +64,563 @@
  **********************************************************************************
  */
 #include "rm_motor.h"
+#include "motor_cycle.h"
 #include "user_lib.h"
+#include <string.h>
 
-// 定义两个CAN总线（CAN1/CAN2）上三种不同控制ID的发送缓冲区数组
-// 第一维表示CAN总线编号(0=CAN1, 1=CAN2)，第二维表示控制帧类型(共3种)
-static CAN_TxBuffer_t txBuffer[2][3];
+// 经典CAN 8字节标准数据帧的发送消息头
+#define MOTOR_TX_HEADER(id)                                                                        \
+    {                                                                                              \
+        .buffer.txHeader = {                                                                       \
+            .Identifier = (id), .IdType = FDCAN_STANDARD_ID, .TxFrameType = FDCAN_DATA_FRAME,      \
+            .DataLength = FDCAN_DLC_BYTES_8, .ErrorStateIndicator = FDCAN_ESI_ACTIVE,              \
+            .BitRateSwitch = FDCAN_BRS_OFF, .FDFormat = FDCAN_CLASSIC_CAN,                         \
+            .TxEventFifoControl = FDCAN_NO_TX_EVENTS, .MessageMarker = 0,                          \
+        },                                                                                         \
+    }
+#define MOTOR_TX_DJI_GROUPS \
+    MOTOR_TX_HEADER(0x1FF), MOTOR_TX_HEADER(0x200), MOTOR_TX_HEADER(0x2FF), MOTOR_TX_HEADER(0x1FE), MOTOR_TX_HEADER(0x2FE)
+
+// 定义两个CAN总线（CAN1/CAN2）上的控制帧发送缓冲区数组
+// 第一维表示CAN总线编号(0=CAN1, 1=CAN2)；第二维前5个为大疆控制帧 0=0x1FF, 1=0x200, 2=0x2FF, 3=0x1FE, 4=0x2FE，
+// 消息头静态初始化，MotorInit()不依赖Motor_DriverInit()的调用顺序；
+// 其余按MotorInit()的顺序分配给独占控制帧的电机，Identifier为0表示未分配
+static MotorTxGroup_t txGroup[2][MOTOR_TX_GROUP_NUM] = {{MOTOR_TX_DJI_GROUPS}, {MOTOR_TX_DJI_GROUPS}};
+_Static_assert(MOTOR_TX_DJI_GROUP_NUM == 5U, "MOTOR_TX_DJI_GROUPS lists 5 DJI control frames");
 
-// 快速查找表，用于根据CAN总线和电机ID快速定位对应的Motor_t结构体
-// 支持最多12个电机ID (0x200-0x20B)
-static Motor_t *Motor_QuickMap[2][0x0C] = {NULL};
+// ID无效或类型未知的电机写入这里，MotorFillData()因此不必判断，该帧从不发送
+static MotorTxGroup_t txDiscard;
+
+/**
+ * @brief 内部函数：设置经典CAN 8字节数据帧的发送消息头
+ */
+static void MotorTxHeaderInit(CAN_TxBuffer_t *txBuffer, uint16_t id)
+{
+    txBuffer->txHeader.Identifier = id;// 设置发送缓冲区的CAN标识符
+    txBuffer->txHeader.DataLength = FDCAN_DLC_BYTES_8;// 设置数据长度为8字节（标准CAN帧）
+    txBuffer->txHeader.IdType     = FDCAN_STANDARD_ID;// 使用标准ID格式
+    txBuffer->txHeader.TxFrameType= FDCAN_DATA_FRAME;// 数据帧类型
+    txBuffer->txHeader.ErrorStateIndicator = FDCAN_ESI_ACTIVE;// 错误状态指示器设为活跃
+    txBuffer->txHeader.BitRateSwitch = FDCAN_BRS_OFF;// 关闭比特率切换
+    txBuffer->txHeader.FDFormat = FDCAN_CLASSIC_CAN;// 使用经典CAN格式（非FD模式）
+    txBuffer->txHeader.TxEventFifoControl = FDCAN_NO_TX_EVENTS; // 不使用发送事件FIFO
+    txBuffer->txHeader.MessageMarker = 0;// 消息标记设为0
+}
+
+/**
+ * @brief 内部函数：大疆控制帧ID在 txGroup 中的下标
+ * @return 0=0x1FF, 1=0x200, 2=0x2FF, 3=0x1FE, 4=0x2FE（后两个为GM6020电流模式），不是大疆控制帧时返回 MOTOR_TX_DJI_GROUP_NUM
+ */
+static uint8_t MotorDjiGroupIndex(uint16_t txId)
+{
+    switch (txId)
+    {
+        case 0x1FF: return 0;
+        case 0x200: return 1;
+        case 0x2FF: return 2;
+        case 0x1FE: return 3;
+        case 0x2FE: return 4;
+        default:    return MOTOR_TX_DJI_GROUP_NUM;
+    }
+}
 
 /**
  * @brief 初始化电机驱动模块的发送缓冲区
- * @note 该函数在系统启动时调用一次，配置所有CAN发送缓冲区的基本参数
+ * @note 在系统启动时、注册电机之前调用一次，重写大疆控制帧的消息头（已静态初始化，调用与否不影响MotorInit()）；
+ *       独占控制帧在MotorInit()中分配
  */
 void Motor_DriverInit(void)
 {
-    // 定义三个标准控制ID: 0=0x1FF, 1=0x200, 2=0x2FF (顺序需与填充逻辑对应)
-    const uint16_t std_ids[3] = {0x1FF, 0x200, 0x2FF};
+    const uint16_t std_ids[MOTOR_TX_DJI_GROUP_NUM] = {0x1FF, 0x200, 0x2FF, 0x1FE, 0x2FE};
     
     for (int i = 0; i < 2; i++) // 遍历 CAN1, CAN2
     {
-        for (int j = 0; j < 3; j++) // 遍历 3 个控制帧
+        for (int j = 0; j < MOTOR_TX_DJI_GROUP_NUM; j++) // 遍历大疆控制帧
+            MotorTxHeaderInit(&txGroup[i][j].buffer, std_ids[j]);
+    }
+}
+
+/* ------------------------------ 大疆 M3508/GM6020/M2006 ------------------------------ */
+
+/**
+ * @brief 由电机反馈ID得到所在控制帧和帧内槽位
+ * @param id   电机反馈报文ID
+ * @param txId 输出控制帧ID
+ * @param slot 输出帧内槽位（0-3），每个槽位2字节
+ * @return 0表示成功，1表示ID无效
+ */
+static uint8_t DJI_Map(uint16_t id, uint16_t *txId, uint8_t *slot)
+{
+    if (id >= 0x201 && id <= 0x204) {
+        *slot = (uint8_t)(id - 0x201);
+        *txId = 0x200;
+        return 0;
+    }
+    if (id >= 0x205 && id <= 0x208) {
+        *slot = (uint8_t)(id - 0x205);
+        *txId = 0x1FF;
+        return 0;
+    }
+    if (id >= 0x209 && id <= 0x20B) {
+        *slot = (uint8_t)(id - 0x209);
+        *txId = 0x2FF;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief GM6020电流模式：反馈ID与电压模式相同，控制帧为 0x1FE（0x205-0x208）和 0x2FE（0x209-0x20B）
+ */
+static uint8_t GM6020Current_Map(uint16_t id, uint16_t *txId, uint8_t *slot)
+{
+    if (id >= 0x205 && id <= 0x208) {
+        *slot = (uint8_t)(id - 0x205);
+        *txId = 0x1FE;
+        return 0;
+    }
+    if (id >= 0x209 && id <= 0x20B) {
+        *slot = (uint8_t)(id - 0x209);
+        *txId = 0x2FE;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 大疆电调反馈：编码器、转速rpm、转矩电流、温度，均为大端
+ */
+static uint8_t DJI_Decode(RawData_t *raw, const uint8_t *data, uint8_t len)
+{
+    (void)len;
+    raw->raw_ecd         = (int16_t)(data[0] << 8 | data[1]);
+    raw->speed_rpm       = (int16_t)(data[2] << 8 | data[3]);
+    raw->torque_current  = (int16_t)(data[4] << 8 | data[5]);
+    raw->temperature     = data[6];
+    return 0;
+}
+
+/* 大疆控制帧：每个电机占两字节大端 */
+static const MotorOps_t motorOps3508 = {"M3508",  MOTOR_TX_GROUP, ECD_RANGE_FOR_3508, CURRENT_LIMIT_FOR_3508, DJI_Decode, DJI_Map, 0, 0, 0, NULL, NULL};
+static const MotorOps_t motorOps6020 = {"GM6020", MOTOR_TX_GROUP, ECD_RANGE_FOR_6020, VOLTAGE_LIMIT_FOR_6020, DJI_Decode, DJI_Map, 0, 0, 0, NULL, NULL};
+static const MotorOps_t motorOps2006 = {"M2006",  MOTOR_TX_GROUP, ECD_RANGE_FOR_2006, CURRENT_LIMIT_FOR_2006, DJI_Decode, DJI_Map, 0, 0, 0, NULL, NULL};
+static const MotorOps_t motorOps6020Current = {"GM6020C", MOTOR_TX_GROUP, ECD_RANGE_FOR_6020, CURRENT_LIMIT_FOR_6020, DJI_Decode, GM6020Current_Map, 0, 0, 0, NULL, NULL};
+
+/* ------------------------------ 达妙电机（MIT模式） ------------------------------ */
+
+/* MIT协议的定点换算，与user_lib.c的uint_to_float()相同；user_lib.c依赖CMSIS-DSP，未加入构建 */
+static float DM_UintToFloat(uint16_t x, float min, float max, uint8_t bits)
+{
+    return (float)x * (max - min) / (float)((1U << bits) - 1U) + min;
+}
+
+static uint8_t DM_Map(uint16_t id, uint16_t *txId, uint8_t *slot)
+{
+    if (id <= DM_MASTER_ID_OFFSET || id > 0x7FFU) return 1;
+    *txId = (uint16_t)(id - DM_MASTER_ID_OFFSET);
+    *slot = 0;
+    return 0;
+}
+
+/**
+ * @brief 达妙MIT反馈：ID|错误码、位置16位、速度12位、力矩12位、MOS温度、线圈温度
+ * @note  PMAX为π时16位位置正好是转子一圈，取高13位作为编码器；力矩保留12位原始值减去中点，与指令同一量纲
+ */
+static uint8_t DM_Decode(RawData_t *raw, const uint8_t *data, uint8_t len)
+{
+    if (len < 8U) return 1;
+
+    uint16_t pos = (uint16_t)(data[1] << 8 | data[2]);
+    uint16_t vel = (uint16_t)(data[3] << 4 | data[4] >> 4);
+    int tor      = (data[4] & 0x0F) << 8 | data[5];
+
+    raw->raw_ecd        = (int16_t)((uint16_t)(pos + 0x8000U) >> 3); // 位置零点在量程中点
+    raw->speed_rpm      = (int16_t)(DM_UintToFloat(vel, -DM_V_MAX, DM_V_MAX, 12) * (60.0f / (2.0f * 3.1415926f)));
+    raw->torque_current = (int16_t)(tor - 2048);
+    raw->temperature    = data[7];
+    return 0;
+}
+
+/**
+ * @brief 达妙MIT控制帧：位置16位、速度12位、kp 12位、kd 12位、前馈力矩12位，这里只给前馈力矩，
+ *        位置和速度取量程中点（即0），kp = kd = 0；力矩在最后两字节，kd为0时即大端的 力矩 + 2048
+ */
+static const uint8_t dmTxTemplate[8] = {0x7F, 0xFF, 0x7F, 0xF0, 0x00, 0x00, 0x08, 0x00};
+static const uint8_t dmEnableFrame[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFC};
+static const MotorOps_t motorOpsDM = {"DM", MOTOR_TX_SINGLE, 8191, DM_OUTPUT_LIMIT, DM_Decode, DM_Map, 6, 0, 2048, dmTxTemplate, dmEnableFrame};
+
+/* ------------------------------ 瓴控电机（转矩闭环） ------------------------------ */
+
+static uint8_t LK_Map(uint16_t id, uint16_t *txId, uint8_t *slot)
+{
+    if (id < LK_ID_MIN || id > LK_ID_MAX) return 1;
+    *txId = id;
+    *slot = 0;
+    return 0;
+}
+
+/**
+ * @brief 瓴控 0x9C/0xA1/0xA2 等命令的应答：命令字、温度、转矩电流、转速（dps）、编码器，均为小端
+ */
+static uint8_t LK_Decode(RawData_t *raw, const uint8_t *data, uint8_t len)
+{
+    if (len < 8U || (data[0] != 0x9C && data[0] != 0xA1 && data[0] != 0xA2 && data[0] != 0xA4)) return 1;
+
+    raw->temperature    = data[1];
+    raw->torque_current = (int16_t)(data[3] << 8 | data[2]);
+    raw->speed_rpm      = (int16_t)((int16_t)(data[5] << 8 | data[4]) / 6);
+    raw->raw_ecd        = (int16_t)((data[7] << 8 | data[6]) & ECD_RANGE_FOR_LK);
+    return 0;
+}
+
+/**
+ * @brief 瓴控转矩闭环命令 0xA1，iqControl 在第4、5字节，小端
+ */
+static const uint8_t lkTxTemplate[8] = {0xA1, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t lkEnableFrame[8] = {0x88, 0, 0, 0, 0, 0, 0, 0};
+static const MotorOps_t motorOpsLK = {"LK", MOTOR_TX_SINGLE, ECD_RANGE_FOR_LK, CURRENT_LIMIT_FOR_LK, LK_Decode, LK_Map, 4, 1, 0, lkTxTemplate, lkEnableFrame};
+
+/* ------------------------------ 未知类型：不收不发 ------------------------------ */
+
+static uint8_t None_Decode(RawData_t *raw, const uint8_t *data, uint8_t len)
+{
+    (void)raw; (void)data; (void)len;
+    return 1;
+}
+
+static uint8_t None_Map(uint16_t id, uint16_t *txId, uint8_t *slot)
+{
+    (void)id; (void)txId; (void)slot;
+    return 1;
+}
+
+static const MotorOps_t motorOpsNone = {"Unknown", MOTOR_TX_SINGLE, 8191, 0, None_Decode, None_Map, 0, 0, 0, NULL, NULL};
+
+/**
+ * @brief 电机类型到协议操作表，新的电机类型在此登记
+ */
+static const MotorOps_t *const motorOps[MOTOR_TYPE_NUM] = {
+    [Motor3508] = &motorOps3508,
+    [Motor6020] = &motorOps6020,
+    [Motor2006] = &motorOps2006,
+    [MotorDM]   = &motorOpsDM,
+    [MotorLK]   = &motorOpsLK,
+    [Motor6020Current] = &motorOps6020Current,
+};
+
+/**
+ * @brief 内部函数：取得某路CAN上ID为txId的控制帧，独占控制帧的电机分配一个新帧
+ * @return 控制帧指针，ID无效、重复注册独占帧或独占帧已满时返回NULL
+ */
+static MotorTxGroup_t *MotorTxGroupAcquire(uint8_t can_idx, uint8_t mode, uint16_t txId)
+{
+    if (mode == MOTOR_TX_GROUP)
+    {
+        uint8_t i = MotorDjiGroupIndex(txId);
+        return (i < MOTOR_TX_DJI_GROUP_NUM) ? &txGroup[can_idx][i] : NULL;
+    }
+
+    for (uint8_t i = MOTOR_TX_DJI_GROUP_NUM; i < MOTOR_TX_GROUP_NUM; i++)
+    {
+        MotorTxGroup_t *group = &txGroup[can_idx][i];
+
+        if (group->buffer.txHeader.Identifier == txId) return NULL;
+        if (group->buffer.txHeader.Identifier == 0U)
         {
-            txBuffer[i][j].txHeader.Identifier = std_ids[j];// 设置发送缓冲区的CAN标识符           
-            txBuffer[i][j].txHeader.DataLength = FDCAN_DLC_BYTES_8;// 设置数据长度为8字节（标准CAN帧）           
-            txBuffer[i][j].txHeader.IdType     = FDCAN_STANDARD_ID;// 使用标准ID格式          
-            txBuffer[i][j].txHeader.TxFrameType= FDCAN_DATA_FRAME;// 数据帧类型            
-            txBuffer[i][j].txHeader.ErrorStateIndicator = FDCAN_ESI_ACTIVE;// 错误状态指示器设为活跃            
-            txBuffer[i][j].txHeader.BitRateSwitch = FDCAN_BRS_OFF;// 关闭比特率切换           
-            txBuffer[i][j].txHeader.FDFormat = FDCAN_CLASSIC_CAN;// 使用经典CAN格式（非FD模式）            
-            txBuffer[i][j].txHeader.TxEventFifoControl = FDCAN_NO_TX_EVENTS; // 不使用发送事件FIFO            
-            txBuffer[i][j].txHeader.MessageMarker = 0;// 消息标记设为0
+            MotorTxHeaderInit(&group->buffer, txId);
+            return group;
         }
     }
+    return NULL;
+}
+
+/**
+ * @brief 内部函数：归还 MotorTxGroupAcquire() 取得但尚未有电机登记的控制帧，独占帧回到未分配状态
+ */
+static void MotorTxGroupRelease(MotorTxGroup_t *group)
+{
+    uint32_t i = (uint32_t)(group - &txGroup[0][0]) % MOTOR_TX_GROUP_NUM;
+
+    if (group->motor_mask == 0U && i >= MOTOR_TX_DJI_GROUP_NUM) group->buffer.txHeader.Identifier = 0;
+}
+
+/**
+ * @brief 内部函数：按控制帧ID查找某路CAN上的控制帧
+ */
+static MotorTxGroup_t *MotorTxGroupFind(uint8_t can_idx, uint16_t txId)
+{
+    for (uint8_t i = 0; i < MOTOR_TX_GROUP_NUM; i++)
+        if (txGroup[can_idx][i].buffer.txHeader.Identifier == txId) return &txGroup[can_idx][i];
+    return NULL;
+}
+
+/**
+ * @brief 内部函数：把编码器刻度差折算到 [-range/2, range/2)，即取最短路径
+ */
+static int32_t MotorEcdWrap(int32_t delta, int32_t range)
+{
+    if (delta >= range / 2)       delta -= range;
+    else if (delta < -range / 2)  delta += range;
+    return delta;
 }
 
 /**
- * @brief 将电机编码器数据转换为角度值
+ * @brief 内部函数：向下取整的整数除法，den > 0
+ */
+static int64_t MotorFloorDiv(int64_t num, int64_t den)
+{
+    int64_t q = num / den;
+    return (num % den < 0) ? q - 1 : q;
+}
+
+/**
+ * @brief 将电机编码器数据转换为角度值，并累计多圈角度
  * @param motor 指向电机结构体的指针，包含编码器原始数据、参数和处理后的数据
- * @note 该函数根据编码器的减速比和零点偏移量，将原始编码器数据转换为以零点为中心的±180°角度值
+ * @note 单圈角度为以零点为中心的±180°转子角度；多圈角度以第一帧相对零点的位置为起点，
+ *       每帧把编码器增量按最短路径（不超过半圈）整数累加到 total_ecd，转子和输出轴的圈数、角度都由它直接换算，
+ *       不逐帧累加浮点数，长时间运行不会漂移。相邻两帧间转子须转不到半圈（1kHz反馈下低于30000rpm）
  */
 static void MotorEcdtoAngle(Motor_t *motor)
 {
-    if ((motor->param).reduction_ratio == 1) 
+    TreatedData_t *treated = &motor->treatedData;
+    const MotorParam_t *param = &motor->param;
+    int32_t range = (int32_t)param->ecd_range + 1;
+    int32_t ecd   = motor->rawData.raw_ecd;
+
+    /* 单圈：将编码器数据特定的零点位置转换为+-180°的角度 */
+    int32_t rel = MotorEcdWrap(ecd - (int32_t)param->ecd_offset, range);
+    treated->last_angle = treated->angle;
+    treated->angle      = (float)rel * (360.0f / (float)range);
+
+    /* 多圈：第一帧从零点起算，之后累加增量 */
+    if (!treated->total_valid)
+    {
+        treated->total_ecd   = rel;
+        treated->total_valid = 1;
+    }
+    else
+        treated->total_ecd += MotorEcdWrap(ecd - treated->last_ecd, range);
+
+    treated->round_cnt   = (int32_t)MotorFloorDiv(treated->total_ecd, range);
+    treated->total_angle = (double)treated->total_ecd * 360.0 / range;
+
+    /* 输出轴转一圈对应 range * 分子 / 分母 个刻度，乘分母后按整数取圈数和余数 */
+    int64_t scaled  = treated->total_ecd * param->ratio_den;
+    int64_t perTurn = (int64_t)range * param->reduction_ratio;
+    int64_t turns   = MotorFloorDiv(scaled, perTurn);
+    treated->axis_round_cnt   = (int32_t)turns;
+    treated->axis_total_angle = (double)turns * 360.0 + (double)(scaled - turns * perTurn) * 360.0 / (double)perTurn;
+}
+
+/**
+ * @brief 用反馈帧的硬件时间戳计算采样间隔和编码器差分转速
+ * @param motor     指向电机结构体的指针，rawData已更新为本帧
+ * @param timestamp 反馈帧的帧起始时刻（微秒）
+ * @return 与上一帧的有效间隔（微秒），首帧或间隔过长时返回0
+ * @note  不假定反馈周期为1ms，总线拥塞或丢帧时按实际间隔计算；间隔过长（首帧或掉线后）只更新时间戳
+ */
+static uint32_t MotorSampleTiming(Motor_t *motor, uint32_t timestamp)
+{
+    TreatedData_t *treated = &motor->treatedData;
+    int32_t ecd   = motor->rawData.raw_ecd;
+    int32_t range = (int32_t)motor->param.ecd_range + 1;
+    uint32_t dt   = timestamp - treated->rx_timestamp;
+
+    if (treated->rx_timestamp != 0U && dt > 0U && dt < MOTOR_SPEED_DT_MAX_US)
+    {
+        int32_t delta = MotorEcdWrap(ecd - treated->ecd, range);
+        treated->angle_speed  = (int16_t)((int64_t)delta * 60000000 / ((int64_t)range * dt));
+        treated->sample_dt_us = dt;
+    }
+    else
+        dt = 0;
+
+    treated->ecd          = ecd;
+    treated->rx_timestamp = timestamp;
+    return dt;
+}
+
+/**
+ * @brief 用转速估计器更新 filter_speed_rpm
+ * @param motor 指向电机结构体的指针
+ * @param dt    与上一帧的有效间隔（微秒），0时估计器重新初始化
+ */
+static void MotorEstimateSpeed(Motor_t *motor, uint32_t dt)
+{
+    float rpm = SpeedFilter_Update(&motor->speedFilter, motor->treatedData.total_ecd, motor->rawData.speed_rpm, dt);
+
+    rpm = LIMIT(rpm, -32767.0f, 32767.0f);
+    motor->treatedData.filter_speed_rpm = (int16_t)(rpm >= 0.0f ? rpm + 0.5f : rpm - 0.5f);
+}
+
+/**
+ * @brief 发布一帧反馈解算后的快照
+ * @param motor     指向电机结构体的指针
+ * @param timestamp 反馈帧的帧起始时刻（微秒）
+ * @note  每个电机只由其所在CAN的任务写入。两份副本依次写入，每份写入前后 seq 都会变化，
+ *        正在读这一份的读者复核 seq 时发现变化并重读，见 MotorGetSnapshot()
+ */
+static void MotorPublish(Motor_t *motor, uint32_t timestamp)
+{
+    MotorFeedback_t *fb = &motor->feedback;
+    MotorSnapshot_t snap = {
+        .raw_ecd        = motor->rawData.raw_ecd,
+        .speed_rpm      = motor->rawData.speed_rpm,
+        .filter_speed_rpm = motor->treatedData.filter_speed_rpm,
+        .torque_current = motor->rawData.torque_current,
+        .temperature    = motor->rawData.temperature,
+        .angle          = motor->treatedData.angle,
+        .total_ecd      = motor->treatedData.total_ecd,
+        .total_angle    = motor->treatedData.total_angle,
+        .axis_total_angle = motor->treatedData.axis_total_angle,
+        .timestamp      = timestamp,
+    };
+
+    fb->seq++;          // 奇数：之后开始读的读者读 buf[1]，正在读 buf[0] 的读者将重读
+    __DMB();
+    fb->buf[0] = snap;
+    __DMB();
+    fb->seq++;          // 偶数：之后开始读的读者读 buf[0]，正在读 buf[1] 的读者将重读
+    __DMB();
+    fb->buf[1] = snap;
+}
+
+/**
+ * @brief 读取电机最近一帧反馈的快照，不加锁，可在任意任务中调用
+ * @param motor    指向电机结构体的指针
+ * @param snapshot 输出快照，尚未收到反馈时各字段为0
+ * @return 因读取期间有新反馈写入而重读的次数
+ */
+uint32_t MotorGetSnapshot(const Motor_t *motor, MotorSnapshot_t *snapshot)
+{
+    const MotorFeedback_t *fb = &motor->feedback;
+    uint32_t retry = 0;
+    uint32_t seq;
+
+    for (;;)
+    {
+        seq = fb->seq;
+        __DMB();
+        *snapshot = fb->buf[seq & 1U];
+        __DMB();
+        if (fb->seq == seq) return retry;
+        retry++;
+    }
+}
+
+/**
+ * @brief 内部函数：发布一个窗口的反馈统计并开始下一个窗口
+ * @param stats   电机的统计
+ * @param now     本帧时刻，即下一个窗口的起点
+ * @param elapsed 本窗口长度（微秒）
+ * @return        本窗口的每秒反馈帧数
+ * @note  每个窗口只发布一次，与 MotorPublish() 相同依次写两份副本，写者不等待，读者读取期间有发布时重读
+ */
+static uint16_t MotorStatsPublish(MotorStats_t *stats, uint32_t now, uint32_t elapsed)
+{
+    MotorStatsReport_t *win = &stats->win;
+
+    win->window_id          = stats->buf[0].window_id + 1U;
+    win->window_us          = elapsed;
+    win->fps                = (uint16_t)((uint64_t)win->frames * 1000000U / elapsed);
+    win->period_us          = (uint16_t)(stats->period_q4 >> 4);
+    win->cmd_latency_avg_us = stats->latency_cnt ? stats->latency_sum / stats->latency_cnt : 0U;
+
+    stats->seq++;
+    __DMB();
+    stats->buf[0] = *win;
+    __DMB();
+    stats->seq++;
+    __DMB();
+    stats->buf[1] = *win;
+
+    uint16_t fps = win->fps;
+    memset(win, 0, sizeof(*win));
+    stats->latency_sum = 0;
+    stats->latency_cnt = 0;
+    stats->win_start   = now;
+    return fps;
+}
+
+/**
+ * @brief 用反馈帧的时间戳更新帧率、间隔抖动和控制到反馈延迟的统计
+ * @param motor     指向电机结构体的指针，须在MotorSampleTiming()之前调用，rx_timestamp仍为上一帧
+ * @param timestamp 反馈帧的帧起始时刻（微秒）
+ * @note  每帧只有固定次数的加法和比较；间隔超过 MOTOR_SPEED_DT_MAX_US（掉线后）只计入最大间隔，不影响平均间隔和抖动。
+ *        完全没有反馈时窗口不会结束，是否掉线以离线检测为准
+ */
+static void MotorStatsUpdate(Motor_t *motor, uint32_t timestamp)
+{
+    static const uint16_t jitterEdge[MOTOR_JITTER_BIN_NUM - 1U] = {5, 10, 20, 50, 100, 200, 500};
+    MotorStats_t *stats = &motor->stats;
+    uint32_t last = motor->treatedData.rx_timestamp;
+
+    if (last == 0U)
+        stats->win_start = timestamp; // 首帧只作为窗口起点
+    else
     {
-        /* 处理编码器数据越界情况，确保数据在合理范围内 */
-        if ((&motor->param)->ecd_offset < ((&motor->param)->ecd_range / 2)) 
+        uint32_t gap = timestamp - last;
+
+        stats->win.frames++;
+        if (gap > stats->win.gap_max_us) stats->win.gap_max_us = gap;
+        if (gap < MOTOR_SPEED_DT_MAX_US)
         {
-            if ((motor->rawData.raw_ecd) > (&motor->param)->ecd_offset + (&motor->param)->ecd_range / 2)
-                motor->rawData.raw_ecd = (motor->rawData.raw_ecd) - (&motor->param)->ecd_range;
-        } 
-        else 
+            // 平均间隔取1/16的滑动平均，首个间隔直接作为初值
+            stats->period_q4 = stats->period_q4 ? stats->period_q4 - (stats->period_q4 >> 4) + gap : gap << 4;
+
+            uint32_t period = stats->period_q4 >> 4;
+            uint32_t jitter = gap > period ? gap - period : period - gap;
+            uint8_t bin = 0;
+            while (bin < MOTOR_JITTER_BIN_NUM - 1U && jitter >= jitterEdge[bin]) bin++;
+            stats->win.jitter_hist[bin]++;
+        }
+    }
+
+    // 所在控制帧有新的发送时，本帧计入一次控制到反馈延迟；反馈早于发送（处理前已在总线上）时留给下一帧
+    if (motor->txGroup != NULL)
+    {
+        uint32_t sent    = motor->txGroup->sent_ts;
+        int32_t  latency = (int32_t)(timestamp - sent);
+
+        if (sent != 0U && sent != stats->cmd_seen && latency >= 0)
         {
-            if ((motor->rawData.raw_ecd) < (&motor->param)->ecd_offset - (&motor->param)->ecd_range / 2)
-                motor->rawData.raw_ecd = (motor->rawData.raw_ecd) + (&motor->param)->ecd_range;
+            stats->cmd_seen = sent;
+            if ((uint32_t)latency < MOTOR_SPEED_DT_MAX_US)
+            {
+                stats->latency_sum += (uint32_t)latency;
+                stats->latency_cnt++;
+                if ((uint32_t)latency > stats->win.cmd_latency_max_us) stats->win.cmd_latency_max_us = (uint32_t)latency;
+            }
         }
-        /*将编码器数据特定的零点位置转换为+-180°的角度*/
-        (&motor->treatedData)->angle = K_ECD_TO_ANGLE * ((motor->rawData.raw_ecd) - (&motor->param)->ecd_offset);
     }
+
+    uint32_t elapsed = timestamp - stats->win_start;
+    if (elapsed >= MOTOR_STATS_WINDOW_US)
+        motor->treatedData.fps = MotorStatsPublish(stats, timestamp, elapsed);
 }
 
 /**
- * @brief 电机数据更新回调函数
- * @param raw 指向原始数据结构体的指针
- * @param treated 指向处理后数据结构体的指针
- * @param data 接收到的CAN数据字节数组
- * @return 总是返回0（保留用于未来扩展）
- * @note 解析从CAN总线接收到的电机反馈数据包
+ * @brief 读取电机上一个完整窗口的反馈统计，不加锁，可在任意任务（如遥测任务）中调用
+ * @param motor  指向电机结构体的指针
+ * @param report 输出统计，尚未完成第一个窗口时各字段为0
+ * @return 因读取期间有新统计发布而重读的次数
+ * @note  window_id 变化时表示有新的窗口，遥测按窗口周期读取即可
  */
-static uint8_t CAN_update_data(RawData_t *raw, TreatedData_t *treated, uint8_t *data)
+uint32_t MotorGetStats(const Motor_t *motor, MotorStatsReport_t *report)
 {
-    if(xSemaphoreTake(treated->dataMutex, portMAX_DELAY) == pdTRUE)
+    const MotorStats_t *stats = &motor->stats;
+    uint32_t retry = 0;
+    uint32_t seq;
+
+    for (;;)
     {
-        treated->last_ecd    =  raw->raw_ecd;
-        raw->raw_ecd         = (int16_t)(data[0] << 8 | data[1]);
-        raw->speed_rpm       = (int16_t)(data[2] << 8 | data[3]);
-        raw->torque_current  = (int16_t)(data[4] << 8 | data[5]);
-        raw->temperature     = data[6];
-        treated->fps++;
-        xSemaphoreGive(treated->dataMutex);
+        seq = stats->seq;
+        __DMB();
+        *report = stats->buf[seq & 1U];
+        __DMB();
+        if (stats->seq == seq) return retry;
+        retry++;
     }
-    return 0;
 }
 
 /**
@@ -137,136 +628,243 @@ static uint8_t CAN_update_data(RawData_t *raw, TreatedData_t *treated, uint8_t *
  *
  * @param motor         所要初始化的电机结构体指针
  * @param ecdOffset     编码器零位偏移量
- * @param type          电机类型枚举值
- * @param gearRatio     减速比
+ * @param type          电机类型枚举值，决定协议操作表
+ * @param gearRatio     减速比（整数），非整数减速比在初始化后调用MotorSetGearRatio()
  * @param canx          使用的是CAN1还是CAN2
- * @param id            CAN_ID（必须在0x200-0x20B范围内才能建立快速映射）
+ * @param id            电机反馈报文的CAN_ID，初始化时注册到CAN接收分发表，并由操作表换算出控制帧ID和槽位
+ * @return              0表示成功；1表示类型未知、该反馈ID在这路CAN上已有电机、ID无法换算出控制帧、
+ *                      独占控制帧已满、该路CAN参与控制周期同步的电机已满或监测表已满，此时已完成的订阅和控制帧分配都被撤销，电机不收不发
+ * @note  反馈按ID直接查CAN接收分发表（O(1)，覆盖全部标准ID），与电机数量和类型无关
  */
-void MotorInit(Motor_t *motor, uint16_t ecdOffset, motor_type type, uint16_t gearRatio, CanNumber canx, uint16_t id)
+uint8_t MotorInit(Motor_t *motor, uint16_t ecdOffset, motor_type type, uint16_t gearRatio, CanNumber canx, uint16_t id)
 {
     // 初始化电机参数
     motor->param.ecd_offset      = ecdOffset;
     motor->param.motor_type      = type;
     motor->param.can_id          = id;
-    motor->param.reduction_ratio = gearRatio;
+    motor->param.reduction_ratio = gearRatio ? gearRatio : 1;
+    motor->param.ratio_den       = 1;
     motor->param.can_number      = canx;
-    motor->MotorUpdate           = CAN_update_data;
+    motor->txGroup               = NULL;
+    motor->tx_slot               = 0;
+    motor->cycle_bit             = 0;
+    motor->tx_hi                 = &txDiscard.buffer.data[0];
+    motor->tx_lo                 = &txDiscard.buffer.data[1];
+    motor->tx_dirty              = &txDiscard.dirty;
+    memset(&motor->stats, 0, sizeof(motor->stats));
+
+    // 按类型选定协议操作表，之后收发不再按类型判断；未知类型不注册，电机不收不发
+    motor->ops = ((uint32_t)type < MOTOR_TYPE_NUM && motorOps[type] != NULL) ? motorOps[type] : &motorOpsNone;
+    motor->param.ecd_range       = motor->ops->ecd_range;
+    motor->tx_bias               = motor->ops->out_bias;
+    MotorSetOutputLimit(motor, motor->ops->output_limit);
+    if (motor->ops == &motorOpsNone) return 1;
 
-    if (id >= 0x200 && id <= 0x20B) 
+    // 登记电机所在的控制帧，MotorFlush() 只发送有电机注册的帧；
+    // 控制量高低字节的位置和 dirty 标志在此一次确定，MotorFillData() 不再查找，独占帧的其余字节在此写好
+    const MotorOps_t *ops = motor->ops;
+    CAN_Instance_t *can   = CAN_GetInstance(canx);
+    MotorTxGroup_t *group;
+    uint16_t txId;
+    uint8_t slot;
+    if (ops->map(id, &txId, &slot)) return 1;
+    group = MotorTxGroupAcquire((canx == CAN2) ? 1 : 0, ops->tx_mode, txId);
+    if (group == NULL) return 1;
+
+    // 同一反馈ID只能注册一次，如电压模式和电流模式的GM6020不能共用一个ID；
+    // 监测表满时节点不会被检查，其状态一直为零（在线），离线时输出不会置零，因此也按失败处理
+    if (CAN_Subscribe(can, id, MotorProcess, motor))
     {
-        uint8_t can_idx = (canx == CAN2) ? 1 : 0;
-        uint8_t id_idx  = id - 0x200;
-        Motor_QuickMap[can_idx][id_idx] = motor;
+        MotorTxGroupRelease(group);
+        return 1;
     }
-
-    switch (type) 
+    // 任意类型的电机都参与控制周期同步，位按登记顺序分配
+    uint32_t bit = MotorCycle_Expect(canx);
+    if (bit == 0U || Monitor_Register(&motor->monitor, ops->name, MOTOR_DEGRADED_MS, MOTOR_OFFLINE_MS))
     {
-        case Motor3508: 
-            motor->param.current_limit = CURRENT_LIMIT_FOR_3508;
-            motor->param.ecd_range     = ECD_RANGE_FOR_3508;
-            break;
-        case Motor6020: 
-            motor->param.current_limit = VOLTAGE_LIMIT_FOR_6020;
-            motor->param.ecd_range     = ECD_RANGE_FOR_6020;
-            break;
-        case Motor2006: 
-            motor->param.current_limit = CURRENT_LIMIT_FOR_2006;
-            motor->param.ecd_range     = ECD_RANGE_FOR_2006;
-            break;
-        default: break;
+        if (bit != 0U) MotorCycle_Release(canx, bit);
+        CAN_Unsubscribe(can, id);
+        MotorTxGroupRelease(group);
+        return 1;
     }
+    motor->cycle_bit = bit;
+
+    uint8_t *field = &group->buffer.data[slot * MOTOR_TX_SLOT_BYTES + ops->out_offset];
+    if (ops->tx_template != NULL) memcpy(group->buffer.data, ops->tx_template, 8);
+    motor->txGroup  = group;
+    motor->tx_slot  = slot;
+    motor->tx_hi    = ops->out_le ? &field[1] : &field[0];
+    motor->tx_lo    = ops->out_le ? &field[0] : &field[1];
+    motor->tx_dirty = &group->dirty;
+    group->motor_mask |= (uint8_t)(1U << slot);
+    return 0;
+}
+
+/**
+ * @brief 发送电机的使能命令，达妙电机上电后须使能才响应控制帧，瓴控电机在停止后须重新运行
+ * @param motor 指向电机结构体的指针
+ * @return      CAN_Send()的返回值（1表示已入队），电机不需要使能时返回1，未注册控制帧时返回0
+ * @note  在CAN_Open()之后调用，可在电机离线后重新上线时再次调用
+ */
+uint8_t MotorEnable(Motor_t *motor)
+{
+    CAN_TxBuffer_t buffer;
+
+    if (motor->txGroup == NULL) return 0;
+    if (motor->ops->enable_frame == NULL) return 1;
+
+    MotorTxHeaderInit(&buffer, (uint16_t)motor->txGroup->buffer.txHeader.Identifier);
+    memcpy(buffer.data, motor->ops->enable_frame, 8);
+    return CAN_Send(CAN_GetInstance((CanNumber)motor->param.can_number), &buffer);
+}
+
+/**
+ * @brief 设置分数形式的减速比，转子转 num 圈输出轴转 den 圈
+ * @param motor 指向电机结构体的指针
+ * @param num   减速比分子，如M3508标准减速箱为 M3508_RATIO_NUM
+ * @param den   减速比分母
+ * @note  只改变输出轴角度的换算，累计刻度不受影响，可在运行中调用；参数为0时不做修改
+ */
+void MotorSetGearRatio(Motor_t *motor, uint16_t num, uint16_t den)
+{
+    if (num == 0U || den == 0U) return;
+    motor->param.reduction_ratio = num;
+    motor->param.ratio_den       = den;
+}
+
+/**
+ * @brief 设置控制量限幅，例如按温度或功率降额
+ * @param motor 指向电机结构体的指针
+ * @param limit 限幅的绝对值，负数按0处理，超过电机类型本身的范围时取该范围
+ * @note  可在运行中调用；上下限分两次写入，与MotorFillData()并发时至多一个周期用到新旧混合的限幅，均不超过类型范围
+ */
+void MotorSetOutputLimit(Motor_t *motor, int16_t limit)
+{
+    if (limit < 0) limit = 0;
+    if (limit > motor->ops->output_limit) limit = motor->ops->output_limit;
+    motor->param.current_limit = limit;
+    motor->out_max             = limit;
+    motor->out_min             = (int16_t)-limit;
 }
 
 /**
  * @brief 电机CAN接收回调函数
- * @param canObject CAN实例对象指针，包含接收到的CAN数据
- * @param bufferRx  接收缓冲区指针
- * @note 该函数用于处理电机相关的CAN接收数据，解析电机反馈信息并更新电机状态
+ * @param canObject CAN实例对象指针
+ * @param frame     从接收环形缓冲区取出的报文
+ * @param ctx       订阅时传入的电机结构体指针
+ * @note 由CAN_Dispatch()按反馈ID查表调用，经协议操作表解析反馈后更新电机状态，与电机类型无关
  */
-void MotorProcess(CAN_Instance_t *canObject, CAN_RxBuffer_t *bufferRx)
+void MotorProcess(CAN_Instance_t *canObject, const CAN_RxFrame_t *frame, void *ctx)
 {
-    uint32_t id = bufferRx->rxHeader.Identifier;
-    
-    // 1. 安全检查：ID是否在支持范围内
-    if (id < 0x200 || id > 0x20B) return;
+    Motor_t *motor = ctx;
+    (void)canObject;
 
-    // 2. 计算索引
-    uint8_t can_idx = (canObject->canHandler == &hfdcan2) ? 1 : 0;
-    uint8_t id_idx  = id - 0x200;
+    int16_t last_ecd = motor->rawData.raw_ecd;
+    if (motor->ops->decode(&motor->rawData, frame->data, frame->len)) return; // 不是反馈帧（如命令应答）
 
-    // 3. 直接获取对象
-    Motor_t *motor = Motor_QuickMap[can_idx][id_idx];
+    Monitor_Beat(&motor->monitor);
+    motor->treatedData.last_ecd = last_ecd;
+    MotorStatsUpdate(motor, frame->timestamp);
+    uint32_t dt = MotorSampleTiming(motor, frame->timestamp);
+    MotorEcdtoAngle(motor);// 将编码器值转换为角度值
+    MotorEstimateSpeed(motor, dt);
+    MotorPublish(motor, frame->timestamp);
 
-    // 4. 处理数据
-    if (motor != NULL) 
-    {
-        motor->online_cnt = 0; 
-        motor->MotorUpdate(&motor->rawData, &motor->treatedData, bufferRx->data);
-        MotorEcdtoAngle(motor);// 将编码器值转换为角度值
-    }
+    motor->treatedData.rx_latency_us = Timebase_Us() - frame->timestamp;
+    if (motor->treatedData.rx_latency_us > motor->treatedData.rx_latency_max)
+        motor->treatedData.rx_latency_max = motor->treatedData.rx_latency_us;
+
+    // 数据更新完成后再登记到达，最后一个电机到达时唤醒控制任务
+    MotorCycle_Arrive(motor->cycle_bit, frame->timestamp);
 }
 
 
 /**
- * @brief 将treatedData.motor_output限幅后填入发送缓存区等待发送
+ * @brief 将控制量限幅后填入发送缓存区等待发送
  * @param motor  指向电机结构体的指针
  * @param output 待发送的控制输出值（通常是电流或电压）
- * @note 该函数不会立即发送数据，只是填充发送缓冲区，需要配合MotorCanOutput使用
+ * @note 该函数不会立即发送数据，只是填充发送缓冲区，需要配合MotorFlush使用。
+ *       写入位置、dirty 标志和限幅都在MotorInit()中确定，这里只有离线判断、一次限幅和写入，不按ID或类型判断；
+ *       电机须先经过MotorInit()，初始化失败的电机写入从不发送的丢弃帧
  */
 void MotorFillData(Motor_t *motor, int32_t output)
 {
-    // 1. 设置并限幅
-    motor->treatedData.motor_output = output;
-    (&motor->treatedData)->motor_output = LIMIT((&motor->treatedData)->motor_output, -motor->param.current_limit, motor->param.current_limit);
+    // 离线电机输出置零，重新上线时不会突加积累的控制量
+    int32_t out = Monitor_IsOffline(&motor->monitor) ? 0 : output;
+    out = LIMIT(out, motor->out_min, motor->out_max);
+    motor->treatedData.motor_output = out;
 
-    // 2. 准备参数
-    uint8_t can_idx = (motor->param.can_number == CAN2) ? 1 : 0;
-    uint16_t id     = motor->param.can_id;
-    int16_t val     = (int16_t)motor->treatedData.motor_output;
-    
-    int buf_idx = -1; //  缓冲区索引: 0=0x1FF, 1=0x200, 2=0x2FF
-    int offset  = 0;  //  在缓冲区中的字节偏移
+    // 先写数据后置标志
+    uint16_t field = (uint16_t)(out + motor->tx_bias);
+    *motor->tx_hi    = (uint8_t)(field >> 8);
+    *motor->tx_lo    = (uint8_t)field;
+    *motor->tx_dirty = 1;
+}
 
-    // 3. 计算缓冲区索引和字节偏移
-    if (id >= 0x201 && id <= 0x204) {
-        buf_idx = 1; // ID: 0x200
-        offset  = (id - 0x201) * 2;
-    } 
-    else if (id >= 0x205 && id <= 0x208) {
-        buf_idx = 0; // ID: 0x1FF
-        offset  = (id - 0x205) * 2;
-    } 
-    else if (id >= 0x209 && id <= 0x20B) {
-        buf_idx = 2; // ID: 0x2FF
-        offset  = (id - 0x209) * 2;
-    }
+/**
+ * @brief 将特定ID的CAN_TxBuffer_t发送出去
+ * @param can             CAN实例指针（发送队列在实例中，须传指针）
+ * @param IDforTxBuffer   要发送的控制帧ID（0x1FF/0x200/0x2FF/0x1FE/0x2FE或独占控制帧的ID）
+ * @return                CAN_Send()的返回值（1表示已入队），ID无效时返回1
+ * @note 需要先调用MotorFillData填充数据后再调用此函数发送；不检查是否有新数据，控制周期中应使用MotorFlush
+ */
+uint16_t MotorCanOutput(CAN_Instance_t *can, int16_t IDforTxBuffer)
+{
+    uint8_t can_idx = (can == &can2) ? 1 : 0;// 获取CAN总线索引
+    MotorTxGroup_t *group = MotorTxGroupFind(can_idx, (uint16_t)IDforTxBuffer);
 
-    // 4. 填充数据
-    if (buf_idx >= 0) {
-        txBuffer[can_idx][buf_idx].data[offset]     = (val >> 8) & 0xFF;
-        txBuffer[can_idx][buf_idx].data[offset + 1] = val & 0xFF;
-    }
+    if (group == NULL) return 1; // 错误 ID
+
+    group->dirty = 0;
+    if (CAN_Send(can, &group->buffer)) { group->sent_cnt++; group->sent_ts = Timebase_Us(); return 1; }
+    group->fail_cnt++;
+    return 0;
 }
 
 /**
- * @brief 将特定ID的CAN_TxBuffer_t发送出去
- * @param can             CAN实例对象
- * @param IDforTxBuffer   要发送的控制帧ID（0x1FF/0x200/0x2FF之一）
- * @return                0表示成功，1表示ID无效
- * @note 需要先调用MotorFillData填充数据后再调用此函数发送
- */
-uint16_t MotorCanOutput(CAN_Instance_t can, int16_t IDforTxBuffer)
-{
-    uint8_t can_idx = (can.canHandler == &hfdcan2) ? 1 : 0;// 获取CAN总线索引
-    int buf_idx = -1;
-
-    // 匹配 Tx Buffer 索引 (与 MotorFillData 中的逻辑对应)
-    switch (IDforTxBuffer) {
-        case 0x1FF: buf_idx = 0; break;
-        case 0x200: buf_idx = 1; break;
-        case 0x2FF: buf_idx = 2; break;
-        default: return 1; // 错误 ID
+ * @brief 发送某路CAN上有电机注册且有新数据的控制帧
+ * @param can CAN实例指针
+ * @return    入队发送的帧数
+ * @note 在控制周期末尾调用一次。没有电机注册的帧从不发送，注册了但本周期没有调用MotorFillData的帧跳过，
+ *       不再用旧指令占用总线；待发的帧在一个临界区内连续压入发送FIFO，不会被其他任务的报文隔开。
+ *       先清 dirty 再拷贝数据，拷贝前被其他任务写入的新数据会在下一周期再发一次，不会丢失
+ */
+uint8_t MotorFlush(CAN_Instance_t *can)
+{
+    uint8_t can_idx = (can == &can2) ? 1 : 0;
+    CAN_TxBuffer_t *pending[MOTOR_TX_GROUP_NUM];
+    MotorTxGroup_t *pendingGroup[MOTOR_TX_GROUP_NUM];
+    uint8_t num = 0, sent = 0;
+
+    for (uint8_t i = 0; i < MOTOR_TX_GROUP_NUM; i++)
+    {
+        MotorTxGroup_t *group = &txGroup[can_idx][i];
+
+        if (group->motor_mask == 0U) continue;
+        if (!group->dirty) { group->skip_cnt++; continue; }
+        group->dirty          = 0;
+        pendingGroup[num]     = group;
+        pending[num++]        = &group->buffer;
     }
+    if (num == 0U) return 0;
 
-    return CAN_Send(&can, &txBuffer[can_idx][buf_idx]);
+    uint32_t ok  = CAN_SendBatch(can, pending, num, xTaskGetTickCount() + CAN_TX_DEADLINE_DEFAULT);
+    uint32_t now = Timebase_Us();
+    for (uint8_t i = 0; i < num; i++)
+    {
+        if (ok & (1UL << i)) { pendingGroup[i]->sent_cnt++; pendingGroup[i]->sent_ts = now; sent++; }
+        else                 { pendingGroup[i]->fail_cnt++; pendingGroup[i]->dirty = 1; }
+    }
+    return sent;
+}
+
+/**
+ * @brief 读取某一控制帧的发送缓冲区和统计
+ * @param canx          CAN设备号
+ * @param IDforTxBuffer 控制帧ID（0x1FF/0x200/0x2FF/0x1FE/0x2FE或独占控制帧的ID）
+ * @return              控制帧指针，ID无效时返回NULL
+ */
+const MotorTxGroup_t *MotorTxGroupGet(CanNumber canx, uint16_t IDforTxBuffer)
+{
+    return MotorTxGroupFind((canx == CAN2) ? 1 : 0, IDforTxBuffer);
 }
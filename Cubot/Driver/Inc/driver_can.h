@@ -4,7 +4,61 @@
 #include "stm32h7xx_hal.h"
 #include "fdcan.h"
 #include "freertos.h"
-#include "queue.h"
+#include "task.h"
+#include "driver_timebase.h"
+
+#define CAN_RX_RING_SIZE   32U    // 每路CAN接收环形缓冲区深度，必须为2的幂
+#define CAN_STD_ID_NUM     0x800U // 11位标准ID总数
+#define CAN_SUBSCRIBER_MAX 32U    // 每路CAN可注册的接收订阅者上限（不超过255）
+#define CAN_FRAME_DATA_MAX 64U    // CAN FD单帧最大数据字节数
+
+#define CAN_FRAME_FLAG_FD  0x01U  // CAN FD帧
+#define CAN_FRAME_FLAG_BRS 0x02U  // 数据段切换到数据波特率
+
+#define CAN_TX_QUEUE_SIZE       16U  // 每路CAN软件发送队列深度（不超过32）
+#define CAN_TX_INFLIGHT_MAX     3U   // 同时压入硬件发送FIFO的帧数上限，其余留在软件队列中，可被同ID的新指令覆盖
+#define CAN_TX_DEADLINE_DEFAULT 1U   // CAN_Send() 默认的发送截止时间，单位为系统节拍
+
+#define CAN_HEALTH_POLL_MS         10U       // CAN任务无报文时调用 CAN_HealthPoll() 的最长间隔
+#define CAN_HEALTH_WINDOW_US       500000U   // 帧率与总线负载的统计窗口
+#define CAN_BUSOFF_BACKOFF_MS      10U       // 总线关闭后首次尝试恢复前的等待时间
+#define CAN_BUSOFF_BACKOFF_MAX_MS  1000U     // 连续总线关闭时等待时间逐次加倍的上限
+#define CAN_BUSOFF_STABLE_MS       1000U     // 恢复后稳定运行超过该时间，等待时间回到初值
+
+/**
+ * @brief	Message RAM 规划：两路FDCAN共享10KB（2560字）Message RAM，按下列需求依次划分，
+ *          CAN1 从0开始，CAN2 紧随其后。元素大小取 FDCAN_DATA_BYTES_x，其数值即每个元素占用的字数。
+ *          FIFO0只接收8字节的经典电机反馈；FIFO1与发送FIFO按64字节元素规划，用于板间CAN FD通信。
+ *          超出元素大小的FD帧会被硬件截断，FD报文的过滤器须指向FIFO1
+ *          需求不可行（超出单项上限或总量超出Message RAM）时在编译期报错，见 driver_can.c
+ */
+#define CAN_MSG_RAM_WORDS        2560U
+
+#define CAN1_STD_FILTER_NUM      4U                  // 标准ID过滤器数量，须不小于过滤器表长度
+#define CAN1_EXT_FILTER_NUM      0U                  // 扩展ID过滤器数量
+#define CAN1_RX_FIFO0_NUM        16U                 // FIFO0深度，容纳一次电机反馈突发
+#define CAN1_RX_FIFO0_ELMT_SIZE  FDCAN_DATA_BYTES_8
+#define CAN1_RX_FIFO1_NUM        8U                  // FIFO1深度，低频报文
+#define CAN1_RX_FIFO1_ELMT_SIZE  FDCAN_DATA_BYTES_64
+#define CAN1_TX_FIFO_NUM         16U                 // 发送FIFO深度
+#define CAN1_TX_ELMT_SIZE        FDCAN_DATA_BYTES_64
+
+#define CAN2_STD_FILTER_NUM      4U
+#define CAN2_EXT_FILTER_NUM      0U
+#define CAN2_RX_FIFO0_NUM        16U
+#define CAN2_RX_FIFO0_ELMT_SIZE  FDCAN_DATA_BYTES_8
+#define CAN2_RX_FIFO1_NUM        8U
+#define CAN2_RX_FIFO1_ELMT_SIZE  FDCAN_DATA_BYTES_64
+#define CAN2_TX_FIFO_NUM         16U
+#define CAN2_TX_ELMT_SIZE        FDCAN_DATA_BYTES_64
+
+/* 每路CAN占用的Message RAM字数，与 HAL 中 FDCAN_CalcultateRamBlockAddresses() 的划分一致 */
+#define CAN_RAM_WORDS(CANX)  ((CANX##_STD_FILTER_NUM) + 2U * (CANX##_EXT_FILTER_NUM)          \
+                              + (CANX##_RX_FIFO0_NUM) * (CANX##_RX_FIFO0_ELMT_SIZE)           \
+                              + (CANX##_RX_FIFO1_NUM) * (CANX##_RX_FIFO1_ELMT_SIZE)           \
+                              + (CANX##_TX_FIFO_NUM) * (CANX##_TX_ELMT_SIZE))
+#define CAN1_RAM_OFFSET      0U
+#define CAN2_RAM_OFFSET      (CAN1_RAM_OFFSET + CAN_RAM_WORDS(CAN1))
 
 /**
  * @brief	CAN设备号枚举
@@ -15,33 +69,151 @@ typedef enum {
 } CanNumber;
 
 /**
- * @brief	CAN接收缓冲区
+ * @brief	CAN标准ID硬件过滤器配置项，CAN_Open()按表顺序写入过滤器元素
+ */
+typedef struct
+{
+    uint32_t type; // FDCAN_FILTER_RANGE：id1~id2；FDCAN_FILTER_DUAL：id1或id2；FDCAN_FILTER_MASK：id1为ID，id2为掩码
+    uint16_t id1;  // 第一个ID
+    uint16_t id2;  // 第二个ID/范围上限/掩码
+    uint32_t fifo; // FDCAN_FILTER_TO_RXFIFO0 或 FDCAN_FILTER_TO_RXFIFO1
+} CAN_FilterConfig_t;
+
+/**
+ * @brief	CAN紧凑接收帧，中断中只保留上层解算需要的字段
+ */
+typedef struct
+{
+    uint32_t id;                       // 报文ID
+    uint32_t timestamp;                // 帧起始时刻（微秒，Timebase_Us() 时基），由FDCAN硬件时间戳换算
+    uint8_t len;                       // 数据字节数（0~64），由DLC解码
+    uint8_t fifo;                      // 来源FIFO（0或1）
+    uint8_t flags;                     // CAN_FRAME_FLAG_FD / CAN_FRAME_FLAG_BRS
+    uint8_t data[CAN_FRAME_DATA_MAX];  // 数据段
+} CAN_RxFrame_t;
+
+/**
+ * @brief	CAN接收环形缓冲区，中断单生产者/CAN任务单消费者，无需加锁
+ * @note    head、tail为自由增长的计数，取下标时与 CAN_RX_RING_SIZE-1 相与。
+ *          每个FIFO各用一个环形缓冲区：FIFO0与FIFO1在不同优先级的中断线上搬运，
+ *          共用一个缓冲区时高优先级中断会打断低优先级中断的写入
  */
 typedef struct
 {
-    FDCAN_RxHeaderTypeDef rxHeader;
-    uint8_t data[8];
-} CAN_RxBuffer_t;
+    volatile uint32_t head;                  // 写指针，仅由接收中断修改
+    volatile uint32_t tail;                  // 读指针，仅由CAN任务修改
+    volatile uint32_t frame_cnt;             // 累计接收帧数
+    volatile uint32_t drop_cnt;              // 环形缓冲区满导致的丢帧数
+    volatile uint16_t burst_max;             // 单次中断搬运的最大帧数
+    volatile uint32_t bit_cnt;               // 接收帧在总线上占用的估算位数累计
+    CAN_RxFrame_t frame[CAN_RX_RING_SIZE];  // 帧存储区
+} CAN_RxRing_t;
 
 /**
  * @brief	CAN发送缓冲区
+ * @note    txHeader.DataLength 取 FDCAN_DLC_BYTES_x（可由 CAN_LenToDlc() 得到），
+ *          txHeader.FDFormat/BitRateSwitch 按ID选择经典帧或FD+BRS帧，经典帧不超过8字节
  */
 typedef struct
 {
     FDCAN_TxHeaderTypeDef txHeader;
-    uint8_t data[8];
+    uint8_t data[CAN_FRAME_DATA_MAX];
 } CAN_TxBuffer_t;
 
+/**
+ * @brief	CAN软件发送队列中的一帧
+ */
+typedef struct
+{
+    uint32_t id;                       // 报文ID
+    uint32_t idType;                   // FDCAN_STANDARD_ID 或 FDCAN_EXTENDED_ID
+    TickType_t deadline;               // 发送截止时间（系统节拍）
+    uint32_t order;                    // 入队序号，截止时间和ID都相同的帧按入队先后发出
+    uint8_t len;                       // 数据字节数
+    uint8_t flags;                     // CAN_FRAME_FLAG_FD / CAN_FRAME_FLAG_BRS
+    uint8_t data[CAN_FRAME_DATA_MAX];  // 数据段
+} CAN_TxSlot_t;
+
+/**
+ * @brief	CAN软件发送队列，按截止时间先后压入硬件发送FIFO，截止时间相同时ID小者优先
+ * @note    入队与出队均在临界区内进行，统计量可直接读取
+ */
+typedef struct
+{
+    CAN_TxSlot_t slot[CAN_TX_QUEUE_SIZE];  // 帧存储区
+    uint32_t used;                         // 占用位图，第i位对应slot[i]
+    volatile uint8_t depth;                // 当前排队帧数
+    volatile uint8_t depth_max;            // 排队帧数峰值
+    uint32_t order;                        // 下一帧的入队序号
+    volatile uint32_t sent_cnt;            // 压入硬件FIFO的帧数
+    volatile uint32_t late_cnt;            // 超过截止时间才压入硬件FIFO的帧数
+    volatile uint32_t replace_cnt;         // 被同ID新指令覆盖的帧数
+    volatile uint32_t overflow_cnt;        // 队列满时被挤出或拒绝的帧数
+    volatile uint32_t bit_cnt;             // 已发帧在总线上占用的估算位数累计
+} CAN_TxQueue_t;
+
+/**
+ * @brief	CAN总线错误状态
+ */
+typedef enum {
+    CAN_BUS_ACTIVE  = 0x00U, // 主动错误
+    CAN_BUS_WARNING = 0x01U, // 错误计数超过96
+    CAN_BUS_PASSIVE = 0x02U, // 被动错误
+    CAN_BUS_OFF     = 0x03U  // 总线关闭，等待自动恢复
+} CanBusState;
+
+/**
+ * @brief	CAN总线健康统计
+ * @note    每个字段只有一个写者（中断线1或 CAN_HealthPoll()），遥测任务可直接读取，无需加锁；
+ *          总线关闭由中断累加 busoff_cnt 通知，CAN_HealthPoll() 用自己的 busoff_ack 记录已处理到第几次
+ */
+typedef struct
+{
+    /* 中断线1中累加 */
+    volatile uint32_t rx_lost_cnt[2];       // 硬件接收FIFO满导致的报文丢失次数，下标为FIFO
+    volatile uint32_t lec_cnt[8];           // 仲裁段协议错误次数，下标为LEC（1填充 2格式 3应答 4隐性位 5显性位 6CRC）
+    volatile uint32_t dlec_cnt[8];          // 数据段协议错误次数，下标为DLEC
+    volatile uint32_t error_warning_cnt;    // 进入错误警告的次数
+    volatile uint32_t error_passive_cnt;    // 进入被动错误的次数
+    volatile uint32_t busoff_cnt;           // 总线关闭次数，与 busoff_ack 不等时表示有未处理的总线关闭
+    volatile uint32_t busoff_at;            // 最近一次总线关闭的时刻（微秒），先于 busoff_cnt 写入
+
+    /* CAN_HealthPoll() 中更新 */
+    volatile uint16_t rx_fps;               // 接收帧率
+    volatile uint16_t tx_fps;               // 发送帧率
+    volatile uint16_t bus_load;             // 估算的总线负载，千分比
+    volatile uint8_t tec;                   // 发送错误计数
+    volatile uint8_t rec;                   // 接收错误计数
+    volatile uint8_t state;                 // CanBusState
+    volatile uint32_t busoff_recover_cnt;   // 自动恢复次数
+    uint32_t busoff_ack;                    // 已处理（已决定等待时间）的总线关闭次数
+    uint32_t busoff_wait_at;                // 正在等待恢复的总线关闭时刻（微秒）
+    uint8_t busoff_wait;                    // 1：总线关闭，等待 backoff_us 后恢复
+    uint32_t backoff_base_us;               // 恢复等待时间初值
+    uint32_t backoff_max_us;                // 恢复等待时间上限
+    uint32_t backoff_us;                    // 本次恢复的等待时间，在 CAN_HealthPoll() 发现总线关闭时决定
+    uint32_t recover_at;                    // 最近一次恢复的时刻（微秒）
+    uint32_t win_start;                     // 统计窗口起点（微秒）
+    uint32_t win_rx_frames;                 // 窗口起点时的累计收帧数
+    uint32_t win_tx_frames;                 // 窗口起点时的累计发帧数
+    uint32_t win_bits;                      // 窗口起点时的累计位数
+} CAN_Health_t;
+
 /**
  * @brief	CAN设备实例结构体
  */
 typedef struct _CAN_Instance_t {
     FDCAN_HandleTypeDef *canHandler;                    // CAN句柄
-    CAN_RxBuffer_t rxBuffer;                         // 接收缓存区结构体
-    CAN_TxBuffer_t txBuffer;                            // 发送缓存区结构体
-    uint8_t (*RxCallBackCAN)(struct _CAN_Instance_t *); // 接收回调函数
-    QueueHandle_t xQueueCan;                            // CAN接收队列
-    uint16_t tx_congest_cnt;                            // 发送拥塞计数 
+    CAN_RxRing_t rxRing[2];                             // 接收环形缓冲区，下标为来源FIFO
+    CAN_TxBuffer_t txBuffer;                            // 发送消息头模板
+    CAN_TxQueue_t txQueue;                              // 软件发送队列
+    CAN_Health_t health;                                // 总线健康统计
+    uint8_t (*RxCallBackCAN)(struct _CAN_Instance_t *); // 接收回调函数，每批报文搬运完成后调用一次
+    TaskHandle_t rxTask;                                // 负责消费接收环形缓冲区的任务
+    volatile uint8_t tx_wake;                           // 置1后，下一次发送完成中断通知 rxTask（分段传输等待发送队列）
+    uint32_t ts_tick_ns;                                // FDCAN时间戳计数器每计一次对应的纳秒数（一个标称位时间）
+    uint32_t data_bit_ns;                               // 数据段位时间（纳秒），用于估算BRS帧的总线占用
+    uint32_t rx_unhandled_cnt;                          // 无订阅者的报文数
 } CAN_Instance_t;
 
 /**
@@ -49,6 +221,14 @@ typedef struct _CAN_Instance_t {
  */
 typedef uint8_t (*CAN_RxCpltCallback)(CAN_Instance_t *);
 
+/**
+ * @brief   按ID订阅的接收处理函数，在CAN任务上下文中调用
+ * @param   can   报文来源的CAN设备
+ * @param   frame 接收到的报文
+ * @param   ctx   订阅时传入的用户上下文
+ */
+typedef void (*CAN_RxHandler)(CAN_Instance_t *can, const CAN_RxFrame_t *frame, void *ctx);
+
 /**
  * @brief  CAN初始化，将句柄和接收回调拷贝至CAN结构体
  * @param[in]  h_can		CAN句柄
@@ -56,22 +236,146 @@ typedef uint8_t (*CAN_RxCpltCallback)(CAN_Instance_t *);
 void CANx_Init(FDCAN_HandleTypeDef *h_can, CAN_RxCpltCallback rxCallback);
 
 /**
- * @brief 打开CAN设备，配置过滤器为空，使能fifo0接收到新信息中断，注册用户回调
- * @param[in]	can	CAN设备
+ * @brief 将 Message RAM 规划写入句柄的初始化参数，须在 HAL_FDCAN_Init() 读取参数前调用（见 fdcan.c 的 MspInit）
+ * @param[in] h_can CAN句柄
+ */
+void CAN_ApplyRamLayout(FDCAN_HandleTypeDef *h_can);
+
+/**
+ * @brief 打开CAN设备，按过滤器表配置硬件过滤器，未命中的报文由全局过滤器拒收，
+ *        只使能过滤器表中用到的FIFO的新消息中断
+ * @param[in]	can	      CAN设备
+ * @param[in]	filter    过滤器配置表
+ * @param[in]	filterNum 过滤器配置表长度
+ * @retval 0 成功，1 过滤器表为空、超出规划的过滤器数量、指向未分配的FIFO或配置失败
+ */
+uint8_t CAN_Open(CAN_Instance_t *can, const CAN_FilterConfig_t *filter, uint8_t filterNum);
+
+/**
+ * @brief 查询某ID的帧是否仍在软件发送队列中，用于同一ID需要保序连续发送的场景（如分段传输）
+ * @param[in] can CAN设备
+ * @param[in] id  报文ID
+ * @retval 1 仍在排队，0 已压入硬件FIFO或不存在
+ */
+uint8_t CAN_TxIdPending(CAN_Instance_t *can, uint32_t id);
+
+/**
+ * @brief 数据长度码转换为数据字节数
+ * @param[in] dlc FDCAN_DLC_BYTES_x
+ */
+uint8_t CAN_DlcToLen(uint32_t dlc);
+
+/**
+ * @brief 数据字节数转换为数据长度码，不是合法FD长度时向上取整（发送时多出的字节补零）
+ * @param[in] len 数据字节数，不超过64
  */
-uint8_t CAN_Open(CAN_Instance_t *can);
+uint32_t CAN_LenToDlc(uint8_t len);
 
 /**
- * @brief 通过CAN设备发送数据
+ * @brief 通过CAN设备发送数据，截止时间为当前节拍加 CAN_TX_DEADLINE_DEFAULT，仅在任务中调用
  * @param[in] txBuffer CAN的发送缓冲区
- *
+ * @retval 1 已入队，0 队列已满且队内帧都更紧急，或帧格式与控制器配置不符
  */
 uint8_t CAN_Send(CAN_Instance_t *can, CAN_TxBuffer_t *txBuffer);
 
 /**
- * @brief 通过CAN设备发送数据
- *	@param[in] txBuffer CAN的发送缓冲区
- *
+ * @brief 按指定截止时间发送数据，同ID的帧尚在队列中时直接覆盖其数据和截止时间，仅在任务中调用
+ * @param[in] txBuffer CAN的发送缓冲区
+ * @param[in] deadline 发送截止时间（系统节拍），越早越优先
+ * @retval 1 已入队，0 队列已满且队内帧都更紧急，或帧格式与控制器配置不符
+ */
+uint8_t CAN_SendDeadline(CAN_Instance_t *can, CAN_TxBuffer_t *txBuffer, TickType_t deadline);
+
+/**
+ * @brief 按指定截止时间发送数据，同ID的帧尚在队列中时另占一个槽位而不覆盖，按入队先后发出，仅在任务中调用
+ * @param[in] txBuffer CAN的发送缓冲区
+ * @param[in] deadline 发送截止时间（系统节拍）
+ * @retval 1 已入队，0 队列已满且队内帧都更紧急，或帧格式与控制器配置不符
+ */
+uint8_t CAN_SendAppend(CAN_Instance_t *can, CAN_TxBuffer_t *txBuffer, TickType_t deadline);
+
+/**
+ * @brief 一次发送多帧，在同一个临界区内全部入队后连续压入硬件FIFO，仅在任务中调用
+ * @param[in] bufferTx 发送缓冲区指针数组
+ * @param[in] num      帧数，不超过 CAN_TX_QUEUE_SIZE
+ * @param[in] deadline 发送截止时间（系统节拍）
+ * @retval 入队帧的位图，第i位对应 bufferTx[i]
+ */
+uint32_t CAN_SendBatch(CAN_Instance_t *can, CAN_TxBuffer_t *const *bufferTx, uint8_t num, TickType_t deadline);
+
+/**
+ * @brief 根据CAN设备号获取CAN设备
+ * @param[in] canx CAN设备号
+ */
+CAN_Instance_t *CAN_GetInstance(CanNumber canx);
+
+/**
+ * @brief 为某一标准ID注册接收处理函数，每个ID只允许一个订阅者
+ * @param[in] can     CAN设备
+ * @param[in] id      11位标准ID
+ * @param[in] handler 接收处理函数
+ * @param[in] ctx     传给处理函数的用户上下文
+ * @retval 0 成功，1 ID越界、已被占用或订阅者已满
+ */
+uint8_t CAN_Subscribe(CAN_Instance_t *can, uint16_t id, CAN_RxHandler handler, void *ctx);
+
+/**
+ * @brief 取消某一标准ID的订阅，设备初始化中途失败时用于撤销已完成的订阅
+ * @param[in] can CAN设备
+ * @param[in] id  11位标准ID
+ * @retval 0 成功，1 ID越界或没有订阅者
+ */
+uint8_t CAN_Unsubscribe(CAN_Instance_t *can, uint16_t id);
+
+/**
+ * @brief 按ID查表把报文分发给订阅者，耗时与订阅者数量无关
+ * @param[in] can   CAN设备
+ * @param[in] frame 接收到的报文
+ */
+void CAN_Dispatch(CAN_Instance_t *can, const CAN_RxFrame_t *frame);
+
+/**
+ * @brief 取出接收环形缓冲区中最早的一帧（不拷贝），FIFO0的帧优先取出，缓冲区均为空时返回NULL
+ * @param[in] can CAN设备
+ */
+const CAN_RxFrame_t *CAN_RxPeek(CAN_Instance_t *can);
+
+/**
+ * @brief 释放 CAN_RxPeek() 取得的帧，使其槽位可被中断重新写入
+ * @param[in] can   CAN设备
+ * @param[in] frame CAN_RxPeek() 返回的帧
+ */
+void CAN_RxRelease(CAN_Instance_t *can, const CAN_RxFrame_t *frame);
+
+/**
+ * @brief FDCAN中断线0服务函数，只处理FIFO0新消息（高频电机反馈），在 FDCANx_IT0_IRQHandler 中调用
+ * @param[in] can CAN设备
+ */
+void CAN_IT0_IRQHandler(CAN_Instance_t *can);
+
+/**
+ * @brief FDCAN中断线1服务函数，处理FIFO1新消息及其余分配到中断线1的事件，在 FDCANx_IT1_IRQHandler 中调用
+ * @param[in] can CAN设备
+ */
+void CAN_IT1_IRQHandler(CAN_Instance_t *can);
+
+/**
+ * @brief 更新帧率、总线负载和错误计数，并在等待时间到达后让关闭的总线自动恢复，由CAN任务周期调用
+ * @param[in] can CAN设备
+ */
+void CAN_HealthPoll(CAN_Instance_t *can);
+
+/**
+ * @brief 设置总线关闭后的恢复等待时间，连续关闭时从 baseMs 逐次加倍至 maxMs
+ * @param[in] can    CAN设备
+ * @param[in] baseMs 首次等待时间（毫秒）
+ * @param[in] maxMs  等待时间上限（毫秒）
+ */
+void CAN_SetBusOffBackoff(CAN_Instance_t *can, uint32_t baseMs, uint32_t maxMs);
+
+/**
+ * @brief CAN接收中断回调，每批报文搬运完成后以任务通知唤醒 rxTask
+ * @param[in] canObject CAN设备
  */
 uint8_t CAN1_rxCallBack(CAN_Instance_t *canObject);
 uint8_t CAN2_rxCallBack(CAN_Instance_t *canObject);
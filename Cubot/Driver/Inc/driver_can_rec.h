@@ -0,0 +1,127 @@
+#ifndef _DRIVER_CAN_REC_H_
+#define _DRIVER_CAN_REC_H_
+
+#include "stm32h7xx_hal.h"
+
+#ifndef CAN_REC_ENABLE
+#define CAN_REC_ENABLE 0          // 默认不编译记录器，driver_can.c 中的记录调用一并去掉；固件以 -DCAN_REC=ON 配置时为1
+#endif
+
+#define CAN_REC_ENTRY_NUM     8192U       // 记录条目数，必须为2的幂，8192条占160KB
+#define CAN_REC_POST_DEFAULT  2048U       // 总线关闭自动触发后继续记录的条目数
+#define CAN_REC_MAGIC         0x43455243U // 导出数据的文件头标识 "CREC"（小端）
+#define CAN_REC_VERSION       1U
+
+/* 记录缓冲区放在未使用的 RAM_D2（0x30000000），不占用DTCM；链接脚本中为 NOLOAD 段，上电内容不确定 */
+#ifndef CAN_REC_SECTION
+#define CAN_REC_SECTION __attribute__((section(".ram_d2")))
+#endif
+
+#define CAN_REC_FLAG_FD    0x01U  // CAN FD帧，与 CAN_FRAME_FLAG_FD 相同
+#define CAN_REC_FLAG_BRS   0x02U  // 数据段切换到数据波特率，与 CAN_FRAME_FLAG_BRS 相同
+#define CAN_REC_FLAG_EXT   0x04U  // 29位扩展ID
+#define CAN_REC_FLAG_TX    0x08U  // 本机发出的帧（压入硬件发送FIFO的时刻），否则为接收帧（帧起始时刻）
+#define CAN_REC_FLAG_CAN2  0x10U  // 来自CAN2，否则为CAN1
+#define CAN_REC_FLAG_DROP  0x20U  // 接收环形缓冲区满被丢弃的帧（硬件收到了，上层没有处理）
+
+/**
+ * @brief	记录条目，超过8字节的FD帧按8字节分段占用多个连续条目，seg 依次为 0,1,2...
+ * @note    导出格式即条目的原始字节（小端），前面加一个 CAN_RecHeader_t
+ */
+typedef struct
+{
+    uint32_t timestamp; // 微秒，Timebase_Us() 时基
+    uint32_t id;        // 报文ID
+    uint8_t len;        // 整帧数据字节数（0~64）
+    uint8_t flags;      // CAN_REC_FLAG_x
+    uint8_t seg;        // 本条目是整帧的第几段
+    uint8_t fifo;       // 接收帧的来源FIFO
+    uint8_t data[8];    // 本段数据
+} CAN_RecEntry_t;
+
+/**
+ * @brief	导出数据的文件头
+ */
+typedef struct
+{
+    uint32_t magic;      // CAN_REC_MAGIC
+    uint16_t version;    // CAN_REC_VERSION
+    uint16_t entry_size; // sizeof(CAN_RecEntry_t)
+    uint32_t entry_num;  // 随后的条目数
+    uint32_t reserved;
+} CAN_RecHeader_t;
+
+/**
+ * @brief	记录器状态
+ */
+typedef enum {
+    CAN_REC_OFF  = 0x00U, // 未记录
+    CAN_REC_RUN  = 0x01U, // 循环记录，满后覆盖最早的条目
+    CAN_REC_POST = 0x02U, // 已触发，再记录 post 条后冻结
+    CAN_REC_HOLD = 0x03U  // 已冻结，等待导出
+} CanRecState;
+
+/**
+ * @brief	读取位置，每个读者一个，记录器不知道读者的存在，读者被覆盖时自行跳过
+ */
+typedef struct
+{
+    uint32_t pos;  // 下一条要读的条目序号
+    uint32_t lost; // 未读就被覆盖的条目数
+} CAN_RecReader_t;
+
+/**
+ * @brief 初始化记录器并打开 RAM_D2 时钟，须在 CAN_Open() 之前调用
+ */
+void CAN_RecInit(void);
+
+/**
+ * @brief 开始循环记录，已冻结的内容被丢弃
+ */
+void CAN_RecStart(void);
+
+/**
+ * @brief 停止记录，已记录的内容保留
+ */
+void CAN_RecStop(void);
+
+/**
+ * @brief 触发冻结：再记录 post 条后停止，保留事件前后的报文，可在任务和中断中调用
+ * @param[in] post 触发后继续记录的条目数，0表示立即冻结
+ */
+void CAN_RecTrigger(uint32_t post);
+
+/**
+ * @brief 读取记录器状态 CanRecState
+ */
+uint8_t CAN_RecGetState(void);
+
+/**
+ * @brief 记录一帧，由 driver_can.c 在接收中断和压入发送FIFO时调用，可在任意优先级不高于
+ *        configMAX_SYSCALL_INTERRUPT_PRIORITY 的中断和临界区中调用
+ * @param[in] flags     CAN_REC_FLAG_x
+ * @param[in] id        报文ID
+ * @param[in] fifo      接收FIFO
+ * @param[in] timestamp 微秒时间戳
+ * @param[in] data      数据
+ * @param[in] len       数据字节数
+ */
+void CAN_RecFrame(uint8_t flags, uint32_t id, uint8_t fifo, uint32_t timestamp, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief 把读者定位到当前最早的一条记录
+ * @param[out] rd 读者
+ * @retval 当前可读的条目数
+ */
+uint32_t CAN_RecReaderInit(CAN_RecReader_t *rd);
+
+/**
+ * @brief 按顺序拷贝出最多 max 条记录，读者落后超过缓冲区长度时跳过被覆盖的部分并计入 rd->lost
+ * @param[in,out] rd  读者
+ * @param[out]    out 输出缓冲区
+ * @param[in]     max 输出缓冲区条目数
+ * @retval 拷贝出的条目数，0表示已读到最新
+ */
+uint32_t CAN_RecRead(CAN_RecReader_t *rd, CAN_RecEntry_t *out, uint32_t max);
+
+#endif
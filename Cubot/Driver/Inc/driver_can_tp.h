@@ -0,0 +1,129 @@
+#ifndef _DRIVER_CAN_TP_H_
+#define _DRIVER_CAN_TP_H_
+
+#include "driver_can.h"
+
+#define CANTP_LINK_MAX    8U     // 每路CAN可注册的分段传输链路上限
+#define CANTP_MSG_MAX     4095U  // 单条消息最大字节数（首帧长度字段为12位）
+#define CANTP_TIMEOUT_MS  1000U  // 等待流控帧/连续帧的超时时间
+#define CANTP_WFT_MAX     10U    // 等待流控帧期间允许连续收到的WAIT流控帧数（N_WFTmax），超过即超时
+#define CANTP_BLOCK_SIZE  8U     // 接收方流控帧中的块大小，0表示不分块
+#define CANTP_STMIN       0U     // 接收方流控帧中的连续帧最小间隔（ISO-TP STmin编码）
+#define CANTP_PAD_BYTE    0xCCU  // 帧内未用字节的填充值
+
+/**
+ * @brief	分段传输会话状态
+ */
+typedef enum {
+    CANTP_IDLE        = 0x00U, // 空闲
+    CANTP_TX_WAIT_FC  = 0x01U, // 已发首帧或一块连续帧，等待流控帧
+    CANTP_TX_SEND_CF  = 0x02U, // 正在发送连续帧
+    CANTP_RX_RECV     = 0x03U  // 正在接收连续帧
+} CanTpState;
+
+/**
+ * @brief	分段传输结果
+ */
+typedef enum {
+    CANTP_OK        = 0x00U, // 完成
+    CANTP_TIMEOUT   = 0x01U, // 等待流控帧或连续帧超时，或对端连续WAIT超过 CANTP_WFT_MAX 次
+    CANTP_SEQ_ERROR = 0x02U, // 连续帧序号错误
+    CANTP_OVERFLOW  = 0x03U  // 接收缓冲区不足（本端或对端）
+} CanTpResult;
+
+struct _CANTP_Link_t;
+
+/**
+ * @brief   整条消息接收完成回调，在CAN任务上下文中调用
+ * @param   link 链路
+ * @param   data 接收缓冲区（即 CANTP_Open() 传入的缓冲区），回调返回后可能被下一条消息覆盖
+ * @param   len  消息长度
+ */
+typedef void (*CANTP_RxCallback)(struct _CANTP_Link_t *link, uint8_t *data, uint16_t len);
+
+/**
+ * @brief   发送结束回调，在CAN任务或调用 CANTP_Send() 的任务上下文中调用
+ * @param   link   链路
+ * @param   result CanTpResult
+ */
+typedef void (*CANTP_TxCallback)(struct _CANTP_Link_t *link, uint8_t result);
+
+/**
+ * @brief	分段传输链路，一对收发ID对应一条链路，收发会话各自维护状态，可同时进行
+ * @note    接收会话的流控帧与发送会话的首帧、连续帧都用 txId 发出，均以 CAN_SendAppend() 入队，互不覆盖；
+ *          接收直接拼装进调用者提供的缓冲区；发送期间 txData 指向的数据须保持有效
+ */
+typedef struct _CANTP_Link_t {
+    CAN_Instance_t *can;            // 所在CAN设备
+    uint16_t txId;                  // 本端发送ID
+    uint16_t rxId;                  // 对端发送ID（本端接收）
+    uint8_t fd;                     // 1：使用CAN FD + BRS帧，单帧最多64字节；0：经典帧
+    uint8_t blockSize;              // 本端接收时通告的块大小
+    uint8_t stmin;                  // 本端接收时通告的STmin
+    CANTP_RxCallback rxCallback;    // 消息接收完成回调
+    CANTP_TxCallback txCallback;    // 发送结束回调，可为NULL
+    void *ctx;                      // 用户上下文
+
+    /* 发送会话 */
+    volatile uint8_t txState;       // CanTpState
+    const uint8_t *txData;          // 待发送数据
+    uint16_t txLen;                 // 消息长度
+    uint16_t txPos;                 // 已发送字节数
+    uint8_t txSn;                   // 下一个连续帧序号
+    uint8_t txBsLeft;               // 本块剩余连续帧数，0表示不限
+    uint32_t txStminUs;             // 对端要求的连续帧最小间隔（微秒）
+    uint32_t txLastUs;              // 上一连续帧的发送时刻
+    uint32_t txTimer;               // 开始等待流控帧的时刻
+    uint8_t txWaitCnt;              // 本次等待中已收到的WAIT流控帧数
+
+    /* 接收会话 */
+    uint8_t rxState;                // CanTpState
+    uint8_t *rxBuf;                 // 调用者提供的接收缓冲区
+    uint16_t rxBufSize;             // 接收缓冲区大小
+    uint16_t rxLen;                 // 正在接收的消息长度
+    uint16_t rxPos;                 // 已接收字节数
+    uint8_t rxSn;                   // 期望的连续帧序号
+    uint8_t rxDl;                   // 对端帧长（字节），由首帧确定
+    uint8_t rxBsLeft;               // 本块剩余连续帧数
+    uint32_t rxTimer;               // 上一帧的接收时刻
+
+    /* 统计 */
+    uint32_t tx_msg_cnt;            // 发送完成的消息数
+    uint32_t rx_msg_cnt;            // 接收完成的消息数
+    uint32_t seq_err_cnt;           // 连续帧序号错误次数
+    uint32_t timeout_cnt;           // 超时次数
+    uint32_t overflow_cnt;          // 缓冲区不足次数
+} CANTP_Link_t;
+
+/**
+ * @brief 打开一条分段传输链路，并订阅其接收ID
+ * @param[in] link       链路
+ * @param[in] can        CAN设备
+ * @param[in] txId       本端发送ID
+ * @param[in] rxId       对端发送ID
+ * @param[in] fd         1：CAN FD + BRS；0：经典帧
+ * @param[in] rxBuf      接收缓冲区，消息直接拼装于此
+ * @param[in] rxBufSize  接收缓冲区大小
+ * @param[in] rxCallback 消息接收完成回调
+ * @retval 0 成功，1 参数无效、链路已满或接收ID已被订阅
+ */
+uint8_t CANTP_Open(CANTP_Link_t *link, CAN_Instance_t *can, uint16_t txId, uint16_t rxId, uint8_t fd,
+                   uint8_t *rxBuf, uint16_t rxBufSize, CANTP_RxCallback rxCallback);
+
+/**
+ * @brief 发送一条消息，单帧装得下时直接发出，否则发送首帧后由CAN任务按流控发送连续帧
+ * @param[in] link 链路
+ * @param[in] data 数据，发送结束前须保持有效
+ * @param[in] len  长度，不超过 CANTP_MSG_MAX
+ * @retval 0 已开始发送，1 上一条消息尚未发完、长度无效或发送队列拒绝
+ * @note   每条链路同一时刻只允许一个任务调用
+ */
+uint8_t CANTP_Send(CANTP_Link_t *link, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief 推进该CAN设备上所有链路的连续帧发送并检查超时，由CAN任务在每次唤醒时调用
+ * @param[in] can CAN设备
+ */
+void CANTP_Poll(CAN_Instance_t *can);
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef _DRIVER_MONITOR_H_
+#define _DRIVER_MONITOR_H_
+
+#include "stm32h7xx_hal.h"
+#include "freertos.h"
+#include "timers.h"
+#include "driver_timebase.h"
+
+#define MONITOR_NODE_MAX   32U  // 可注册的节点上限（离线位图为32位）
+#define MONITOR_PERIOD_MS  5U   // 检查周期，状态切换最多滞后一个周期
+
+/**
+ * @brief	节点状态
+ */
+typedef enum {
+    MONITOR_ONLINE   = 0x00U, // 心跳正常
+    MONITOR_DEGRADED = 0x01U, // 超过 degraded_us 没有心跳，数据可能过时
+    MONITOR_OFFLINE  = 0x02U  // 超过 offline_us 没有心跳，或注册后从未收到心跳
+} MonitorState;
+
+struct _Monitor_Node_t;
+
+/**
+ * @brief   状态切换回调，在定时器服务任务中调用，不能阻塞
+ * @param   node     节点
+ * @param   oldState 切换前的状态，新状态为 node->state
+ * @param   ctx      注册时传入的用户上下文
+ */
+typedef void (*Monitor_StateCallback)(struct _Monitor_Node_t *node, uint8_t oldState, void *ctx);
+
+/**
+ * @brief	被监测的节点，嵌入到电机、裁判系统等设备结构体中
+ * @note    Monitor_Beat() 只写 last_beat 和 beat_cnt，其余字段只由定时器回调修改
+ */
+typedef struct _Monitor_Node_t {
+    const char *name;                // 名称，便于调试
+    uint32_t degraded_us;            // 心跳超时进入 MONITOR_DEGRADED 的时间
+    uint32_t offline_us;             // 心跳超时进入 MONITOR_OFFLINE 的时间
+    volatile uint32_t last_beat;     // 最近一次心跳的时刻（微秒）
+    volatile uint32_t beat_cnt;      // 累计心跳次数
+    uint32_t seen_cnt;               // 定时器上次检查时的心跳次数
+    volatile uint8_t state;          // MonitorState
+    uint8_t index;                   // 在离线位图中的位置
+    uint32_t offline_cnt;            // 从在线掉线的次数
+    Monitor_StateCallback callback;  // 状态切换回调，可为NULL
+    void *ctx;                       // 回调的用户上下文
+} Monitor_Node_t;
+
+/**
+ * @brief 创建并启动检查定时器，节点可在此前或此后注册
+ * @retval 0 成功，1 定时器创建或启动失败
+ */
+uint8_t Monitor_Init(void);
+
+/**
+ * @brief 注册节点，初始状态为 MONITOR_OFFLINE，收到第一次心跳后变为在线
+ * @param[in] node       节点
+ * @param[in] name       名称
+ * @param[in] degradedMs 心跳超时进入 MONITOR_DEGRADED 的时间（毫秒）
+ * @param[in] offlineMs  心跳超时进入 MONITOR_OFFLINE 的时间（毫秒），不小于 degradedMs
+ * @retval 0 成功，1 节点已满或参数无效
+ */
+uint8_t Monitor_Register(Monitor_Node_t *node, const char *name, uint32_t degradedMs, uint32_t offlineMs);
+
+/**
+ * @brief 设置状态切换回调
+ * @param[in] node     节点
+ * @param[in] callback 回调，NULL表示取消
+ * @param[in] ctx      用户上下文
+ */
+void Monitor_SetCallback(Monitor_Node_t *node, Monitor_StateCallback callback, void *ctx);
+
+/**
+ * @brief  心跳，收到节点的有效数据时调用，可在任务和中断中调用
+ * @param[in] node 节点
+ */
+static inline void Monitor_Beat(Monitor_Node_t *node)
+{
+    node->last_beat = Timebase_Us();
+    node->beat_cnt++;
+}
+
+/**
+ * @brief  节点是否离线，O(1)，用于在输出前把离线设备的控制量置零
+ * @param[in] node 节点
+ */
+static inline uint8_t Monitor_IsOffline(const Monitor_Node_t *node)
+{
+    return node->state == MONITOR_OFFLINE;
+}
+
+/**
+ * @brief  离线节点位图，第i位对应 index 为i的节点，用于遥测一次读取所有节点状态
+ */
+uint32_t Monitor_OfflineMask(void);
+
+/**
+ * @brief  按 index 取得节点，index 无效时返回NULL
+ */
+Monitor_Node_t *Monitor_GetNode(uint8_t index);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef _DRIVER_TIMEBASE_H_
+#define _DRIVER_TIMEBASE_H_
+
+#include "stm32h7xx_hal.h"
+
+#define TIMEBASE_TIM TIM2 // 32位定时器，1MHz计数，约71分钟回绕一次
+
+/**
+ * @brief 初始化微秒时基，启动 TIMEBASE_TIM 以1MHz自由计数
+ */
+void Timebase_Init(void);
+
+/**
+ * @brief  读取当前微秒时间，单次寄存器读取，可在任务和任意优先级中断中调用
+ * @note   回绕后差值 (b - a) 仍然正确，比较先后时须用无符号差值
+ */
+static inline uint32_t Timebase_Us(void)
+{
+    return TIMEBASE_TIM->CNT;
+}
+
+/**
+ * @brief  读取内核时钟周期计数（DWT->CYCCNT），用于测量短代码段的耗时
+ * @note   480MHz下约9秒回绕，只用无符号差值；Timebase_Init()中启动计数
+ */
+static inline uint32_t Timebase_Cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif
@@ -29,11 +29,21 @@
 
     2. 调用 CANx_Init() 将 句柄 和 用户定义的接收回调函数 拷贝至CAN结构体（回调函数中对接收到的数据进行ID识别和合并解算）
 
-    3. 调用 CAN_Open() 传入实例化的结构体，开启can设备
+    3. 编写 CAN_FilterConfig_t 过滤器表（ID范围/ID对/掩码 + 目标FIFO），调用 CAN_Open() 传入实例化的结构体和过滤器表，开启can设备
 
-    4. 应用层编写 CAN_TxBuffer_t （发送缓存区结构体），填入待发送的字节数据和目标ID
+    4. 在 stm32h7xx_it.c 的 FDCANx_IT0/IT1_IRQHandler 中调用 CAN_IT0_IRQHandler()/CAN_IT1_IRQHandler()，
+       FIFO0 走高优先级的中断线0，FIFO1 及其余事件走中断线1
 
-    5. 调用 CAN_Send() 传入 can设备结构体 和 TxBuffer结构体，将数据发送出去
+    5. 接收任务将自身句柄写入 rxTask，被任务通知唤醒后循环调用 CAN_RxPeek()/CAN_RxRelease() 取完整批报文
+
+    6. 各设备调用 CAN_Subscribe() 为自己的反馈ID注册处理函数（初始化中途失败时用 CAN_Unsubscribe() 撤销），
+       接收任务调用 CAN_Dispatch() 查表分发
+
+    7. 应用层编写 CAN_TxBuffer_t （发送缓存区结构体），填入待发送的字节数据和目标ID
+
+    8. 调用 CAN_Send()/CAN_SendDeadline() 传入 can设备结构体 和 TxBuffer结构体，报文进入软件发送队列，
+       按截止时间压入硬件发送FIFO，发送完成中断中继续补充。同ID的帧尚在队列中时新帧覆盖旧帧，
+       每帧都必须发出的报文（如分段传输）改用 CAN_SendAppend()
 
  **********************************************************************************
  * @attention
@@ -70,46 +80,91 @@
  **********************************************************************************
  */
 #include "driver_can.h"
+#include "driver_can_rec.h"
 #include "freertos.h"
-#include "queue.h"
+#include "task.h"
+#include <string.h>
 /**
  * @brief CAN设备实例化结构体
  * 
- * 定义了CAN1的发送缓冲区配置和设备相关信息
- * - txBuffer.txHeader: 发送消息头配置，设置为标准ID、数据帧、8字节数据长度等
+ * 实例较大（收发缓冲区），不带初始值以放在 .bss 中，发送消息头模板在 CANx_Init() 中设置
  */
-CAN_Instance_t can1 = {
-    .txBuffer.txHeader =
-        {
-            .IdType              = FDCAN_STANDARD_ID,        /**< 使用标准ID格式 */
-            .TxFrameType         = FDCAN_DATA_FRAME,         /**< 发送数据帧 */
-            .DataLength          = FDCAN_DLC_BYTES_8,        /**< 数据长度为8字节 */
-            .ErrorStateIndicator = FDCAN_ESI_ACTIVE,         /**< 错误状态指示为主动模式 */
-            .BitRateSwitch       = FDCAN_BRS_OFF,            /**< 不使用可变速率切换 */
-            .FDFormat            = FDCAN_CLASSIC_CAN,        /**< 使用经典CAN格式 */
-            .TxEventFifoControl  = FDCAN_NO_TX_EVENTS,       /**< 不记录发送事件 */
-            .MessageMarker       = 0x00,                     /**< 消息标记为0 */
-        }
-};
+CAN_Instance_t can1;
+CAN_Instance_t can2;
+
+/* 总线健康相关的中断，均分配到中断线1 */
+#define CAN_IT_HEALTH_LIST (FDCAN_IT_ARB_PROTOCOL_ERROR | FDCAN_IT_DATA_PROTOCOL_ERROR | FDCAN_IT_ERROR_WARNING \
+                            | FDCAN_IT_ERROR_PASSIVE | FDCAN_IT_BUS_OFF)
+
+/* 分配到中断线1的中断，其余（FIFO0新消息）保持默认的中断线0 */
+#define CAN_IT_LINE1_LIST  (FDCAN_IT_RX_FIFO1_NEW_MESSAGE | FDCAN_IT_TX_COMPLETE | FDCAN_IT_RX_FIFO0_MESSAGE_LOST \
+                            | FDCAN_IT_RX_FIFO1_MESSAGE_LOST | CAN_IT_HEALTH_LIST)
+
 /**
- * @brief CAN设备实例化结构体
- * 
- * 定义了CAN2的发送缓冲区配置和设备相关信息
- * 结构与can1相同，用于区分两个不同的CAN控制器
+ * @brief CAN接收订阅表
+ *
+ * idMap 以11位标准ID为下标，存放 subscriber 数组下标加一（0表示无人订阅），
+ * 分发时一次查表即可定位处理函数，与订阅者数量和ID分布无关。
+ * 放在 .bss 中，避免随CAN实例的初始值占用Flash。
  */
-CAN_Instance_t can2 = {
-    .txBuffer.txHeader =
-        {
-            .IdType              = FDCAN_STANDARD_ID,        /**< 使用标准ID格式 */
-            .TxFrameType         = FDCAN_DATA_FRAME,         /**< 发送数据帧 */
-            .DataLength          = FDCAN_DLC_BYTES_8,        /**< 数据长度为8字节 */
-            .ErrorStateIndicator = FDCAN_ESI_ACTIVE,         /**< 错误状态指示为主动模式 */
-            .BitRateSwitch       = FDCAN_BRS_OFF,            /**< 不使用可变速率切换 */
-            .FDFormat            = FDCAN_CLASSIC_CAN,        /**< 使用经典CAN格式 */
-            .TxEventFifoControl  = FDCAN_NO_TX_EVENTS,       /**< 不记录发送事件 */
-            .MessageMarker       = 0x00,                     /**< 消息标记为0 */
-        }
-};
+typedef struct
+{
+    uint8_t idMap[CAN_STD_ID_NUM];
+    struct
+    {
+        CAN_RxHandler handler;
+        void *ctx;
+    } subscriber[CAN_SUBSCRIBER_MAX];
+    uint8_t subscriber_cnt;
+} CAN_RouteTable_t;
+
+static CAN_RouteTable_t canRoute[2];
+
+/* Message RAM 规划的编译期检查 */
+#define CAN_RAM_ASSERT(CANX)                                                                              \
+    _Static_assert((CANX##_STD_FILTER_NUM) <= 128U, #CANX ": too many standard filters");               \
+    _Static_assert((CANX##_EXT_FILTER_NUM) <= 64U, #CANX ": too many extended filters");                \
+    _Static_assert((CANX##_RX_FIFO0_NUM) <= 64U, #CANX ": RX FIFO0 deeper than 64 elements");           \
+    _Static_assert((CANX##_RX_FIFO1_NUM) <= 64U, #CANX ": RX FIFO1 deeper than 64 elements");           \
+    _Static_assert((CANX##_TX_FIFO_NUM) >= 1U && (CANX##_TX_FIFO_NUM) <= 32U, #CANX ": TX FIFO must hold 1-32 elements"); \
+    _Static_assert(IS_FDCAN_DATA_SIZE(CANX##_RX_FIFO0_ELMT_SIZE), #CANX ": invalid RX FIFO0 element size"); \
+    _Static_assert(IS_FDCAN_DATA_SIZE(CANX##_RX_FIFO1_ELMT_SIZE), #CANX ": invalid RX FIFO1 element size"); \
+    _Static_assert(IS_FDCAN_DATA_SIZE(CANX##_TX_ELMT_SIZE), #CANX ": invalid TX element size")
+
+CAN_RAM_ASSERT(CAN1);
+CAN_RAM_ASSERT(CAN2);
+_Static_assert(CAN2_RAM_OFFSET + CAN_RAM_WORDS(CAN2) <= CAN_MSG_RAM_WORDS, "FDCAN Message RAM layout exceeds 10KB");
+_Static_assert(CAN_TX_QUEUE_SIZE <= 32U, "CAN TX queue bitmap holds at most 32 slots");
+
+/**
+ * @brief Message RAM 规划结果
+ */
+typedef struct
+{
+    uint32_t ramOffset;
+    uint32_t stdFiltersNbr;
+    uint32_t extFiltersNbr;
+    uint32_t rxFifo0ElmtsNbr;
+    uint32_t rxFifo0ElmtSize;
+    uint32_t rxFifo1ElmtsNbr;
+    uint32_t rxFifo1ElmtSize;
+    uint32_t txFifoElmtsNbr;
+    uint32_t txElmtSize;
+} CAN_RamLayout_t;
+
+#define CAN_RAM_LAYOUT(CANX)                                                           \
+    {                                                                                  \
+        CANX##_RAM_OFFSET, CANX##_STD_FILTER_NUM, CANX##_EXT_FILTER_NUM,               \
+        CANX##_RX_FIFO0_NUM, CANX##_RX_FIFO0_ELMT_SIZE,                                \
+        CANX##_RX_FIFO1_NUM, CANX##_RX_FIFO1_ELMT_SIZE,                                \
+        CANX##_TX_FIFO_NUM, CANX##_TX_ELMT_SIZE                                        \
+    }
+
+static const CAN_RamLayout_t canRamLayout[2] = {CAN_RAM_LAYOUT(CAN1), CAN_RAM_LAYOUT(CAN2)};
+
+/* 数据长度码对应的字节数 */
+static const uint8_t canDlcToLen[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
 /**
  * @brief 初始化CAN控制器
  * @param h_can CAN控制器句柄指针
@@ -118,7 +173,7 @@ CAN_Instance_t can2 = {
  * 
  * 该函数根据传入的CAN控制器句柄，初始化对应的CAN控制器结构体，
  * 并设置接收完成回调函数。支持FDCAN1和FDCAN2两个控制器的初始化。
- * 同时创建FreeRTOS消息队列用于异步处理接收到的CAN数据。
+ * 接收环形缓冲区为静态存储，无需从堆中分配。
  */
 void CANx_Init(FDCAN_HandleTypeDef *h_can, CAN_RxCpltCallback rxCallback)
 {
@@ -128,141 +183,863 @@ void CANx_Init(FDCAN_HandleTypeDef *h_can, CAN_RxCpltCallback rxCallback)
     else if (h_can->Instance == FDCAN2) pCan = &can2;
 
     if (pCan != NULL) {
-        pCan->canHandler     = h_can;
-        pCan->RxCallBackCAN  = rxCallback;
-        pCan->xQueueCan      = xQueueCreate(32, sizeof(CAN_RxBuffer_t));
-        pCan->tx_congest_cnt = 0;
+        pCan->canHandler       = h_can;
+        pCan->RxCallBackCAN    = rxCallback;
+        pCan->rxTask           = NULL;
+        pCan->tx_wake          = 0;
+        pCan->ts_tick_ns       = 0;
+        pCan->data_bit_ns      = 0;
+        pCan->rx_unhandled_cnt = 0;
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            pCan->rxRing[i].head      = 0;
+            pCan->rxRing[i].tail      = 0;
+            pCan->rxRing[i].frame_cnt = 0;
+            pCan->rxRing[i].drop_cnt  = 0;
+            pCan->rxRing[i].burst_max = 0;
+            pCan->rxRing[i].bit_cnt   = 0;
+        }
+
+        /* 发送消息头模板：标准ID数据帧、主动错误、不记录发送事件，ID、长度和帧格式由每帧覆盖 */
+        pCan->txBuffer.txHeader.IdType              = FDCAN_STANDARD_ID;
+        pCan->txBuffer.txHeader.TxFrameType         = FDCAN_DATA_FRAME;
+        pCan->txBuffer.txHeader.DataLength          = FDCAN_DLC_BYTES_8;
+        pCan->txBuffer.txHeader.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
+        pCan->txBuffer.txHeader.BitRateSwitch       = FDCAN_BRS_OFF;
+        pCan->txBuffer.txHeader.FDFormat            = FDCAN_CLASSIC_CAN;
+        pCan->txBuffer.txHeader.TxEventFifoControl  = FDCAN_NO_TX_EVENTS;
+        pCan->txBuffer.txHeader.MessageMarker       = 0x00;
+        memset(&pCan->txQueue, 0, sizeof(pCan->txQueue));
+        memset(&pCan->health, 0, sizeof(pCan->health));
+        CAN_SetBusOffBackoff(pCan, CAN_BUSOFF_BACKOFF_MS, CAN_BUSOFF_BACKOFF_MAX_MS);
     }
 }
 
 
+/**
+ * @brief 将 Message RAM 规划写入句柄的初始化参数
+ * @param h_can CAN控制器句柄指针
+ *
+ * HAL_FDCAN_Init() 先调用 HAL_FDCAN_MspInit()，之后才读取 Init 中的元素数量和大小并划分Message RAM，
+ * 因此在 MspInit 中调用本函数即可覆盖 CubeMX 生成的参数，重新生成代码也不会丢失。
+ */
+void CAN_ApplyRamLayout(FDCAN_HandleTypeDef *h_can)
+{
+    const CAN_RamLayout_t *layout;
+
+    if (h_can->Instance == FDCAN1) layout = &canRamLayout[0];
+    else if (h_can->Instance == FDCAN2) layout = &canRamLayout[1];
+    else return;
+
+    h_can->Init.MessageRAMOffset    = layout->ramOffset;
+    h_can->Init.StdFiltersNbr       = layout->stdFiltersNbr;
+    h_can->Init.ExtFiltersNbr       = layout->extFiltersNbr;
+    h_can->Init.RxFifo0ElmtsNbr     = layout->rxFifo0ElmtsNbr;
+    h_can->Init.RxFifo0ElmtSize     = layout->rxFifo0ElmtSize;
+    h_can->Init.RxFifo1ElmtsNbr     = layout->rxFifo1ElmtsNbr;
+    h_can->Init.RxFifo1ElmtSize     = layout->rxFifo1ElmtSize;
+    h_can->Init.RxBuffersNbr        = 0;
+    h_can->Init.TxEventsNbr         = 0;
+    h_can->Init.TxBuffersNbr        = 0;
+    h_can->Init.TxFifoQueueElmtsNbr = layout->txFifoElmtsNbr;
+    h_can->Init.TxFifoQueueMode     = FDCAN_TX_FIFO_OPERATION;
+    h_can->Init.TxElmtSize          = layout->txElmtSize;
+}
+
 /**
  * @brief 初始化并启动CAN通信接口
  * 
- * 该函数用于配置CAN控制器的接收过滤器、全局过滤策略、启动CAN模块，
- * 并使能接收FIFO中新消息的中断通知。
+ * 该函数按过滤器表逐项写入标准ID过滤器元素，未命中任何过滤器的报文由全局过滤器拒收，
+ * 不会产生中断。过滤器元素数量由 Message RAM 规划（CANx_STD_FILTER_NUM）在编译期确定，
+ * 多余的元素在初始化时被清零即为禁用。过滤器表超出规划数量或指向未分配的FIFO时返回失败。
+ * 启动CAN模块后只使能过滤器表中用到的接收FIFO的新消息中断，FIFO0分配到中断线0，FIFO1分配到中断线1。
+ * 发送完成中断（中断线1）覆盖全部发送FIFO元素，平时关闭，仅在软件发送队列非空时打开。
+ * 时间戳计数器按标称位时间计数，接收中断据此把硬件时间戳换算到 Timebase_Us() 时基。
+ * FIFO报文丢失、协议错误、错误状态变化和总线关闭中断（中断线1）用于总线健康统计。
  * 
  * @param can 指向CAN实例结构体的指针，包含CAN句柄等信息
+ * @param filter 过滤器配置表
+ * @param filterNum 过滤器配置表长度
  * @return uint8_t 返回操作结果：0表示成功，1表示失败
  */
-uint8_t CAN_Open(CAN_Instance_t *can)
+uint8_t CAN_Open(CAN_Instance_t *can, const CAN_FilterConfig_t *filter, uint8_t filterNum)
 {
-    FDCAN_FilterTypeDef filter; 
+    FDCAN_FilterTypeDef filterDef;
+    uint8_t useFifo0 = 0;
+    uint8_t useFifo1 = 0;
 
-    /* 配置接收所有标准帧到 FIFO0 */
-    filter.IdType       = FDCAN_STANDARD_ID;
-    filter.FilterIndex  = 0;
-    filter.FilterType   = FDCAN_FILTER_MASK;
-    filter.FilterConfig = FDCAN_FILTER_TO_RXFIFO0;
-    filter.FilterID1    = 0x000;
-    filter.FilterID2    = 0x000;
-    if (HAL_FDCAN_ConfigFilter(can->canHandler, &filter) != HAL_OK) return 1;
+    if (filter == NULL || filterNum == 0 || filterNum > can->canHandler->Init.StdFiltersNbr) return 1;
 
-    /* 配置接收所有标准帧到 FIFO1 (冗余或作为备用) */
-    filter.FilterIndex  = 1;
-    filter.FilterConfig = FDCAN_FILTER_TO_RXFIFO1;
-    if (HAL_FDCAN_ConfigFilter(can->canHandler, &filter) != HAL_OK) return 1;
+    filterDef.IdType = FDCAN_STANDARD_ID;
+    for (uint8_t i = 0; i < filterNum; i++)
+    {
+        if (filter[i].fifo == FDCAN_FILTER_TO_RXFIFO0 && can->canHandler->Init.RxFifo0ElmtsNbr > 0U)      useFifo0 = 1;
+        else if (filter[i].fifo == FDCAN_FILTER_TO_RXFIFO1 && can->canHandler->Init.RxFifo1ElmtsNbr > 0U) useFifo1 = 1;
+        else return 1;
+
+        filterDef.FilterIndex  = i;
+        filterDef.FilterType   = filter[i].type;
+        filterDef.FilterConfig = filter[i].fifo;
+        filterDef.FilterID1    = filter[i].id1;
+        filterDef.FilterID2    = filter[i].id2;
+        if (HAL_FDCAN_ConfigFilter(can->canHandler, &filterDef) != HAL_OK) return 1;
+    }
 
+    /* 未命中过滤器的标准帧、扩展帧及远程帧全部拒收 */
     HAL_FDCAN_ConfigGlobalFilter(can->canHandler, FDCAN_REJECT, FDCAN_REJECT, FDCAN_REJECT_REMOTE, FDCAN_REJECT_REMOTE);
-    HAL_FDCAN_Start(can->canHandler);
+    HAL_FDCAN_ConfigInterruptLines(can->canHandler, CAN_IT_LINE1_LIST, FDCAN_INTERRUPT_LINE1);
+
+    /* 时间戳计数器每个标称位时间加一，16位计数，1Mbps下约65ms回绕，远大于报文在FIFO中的停留时间 */
+    FDCAN_InitTypeDef *init = &can->canHandler->Init;
+    can->ts_tick_ns = (uint32_t)((uint64_t)1000000000U * init->NominalPrescaler
+                                 * (1U + init->NominalTimeSeg1 + init->NominalTimeSeg2)
+                                 / HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_FDCAN));
+    can->data_bit_ns = (uint32_t)((uint64_t)1000000000U * init->DataPrescaler
+                                  * (1U + init->DataTimeSeg1 + init->DataTimeSeg2)
+                                  / HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_FDCAN));
+    HAL_FDCAN_ConfigTimestampCounter(can->canHandler, FDCAN_TIMESTAMP_PRESC_1);
+    HAL_FDCAN_EnableTimestampCounter(can->canHandler, FDCAN_TIMESTAMP_INTERNAL);
+
+    /* 数据段高波特率下收发器环路延迟超过一个位时间，需开启发送延迟补偿，补偿点取数据段采样点，
+       即同步段（1个时间份额）加相位段1之后，单位为mtq */
+    if (init->FrameFormat == FDCAN_FRAME_FD_BRS)
+    {
+        HAL_FDCAN_ConfigTxDelayCompensation(can->canHandler, init->DataPrescaler * (1U + init->DataTimeSeg1), 0);
+        HAL_FDCAN_EnableTxDelayCompensation(can->canHandler);
+    }
 
-    /* 使能两个FIFO的新消息中断 */
-    HAL_FDCAN_ActivateNotification(can->canHandler, FDCAN_IT_RX_FIFO0_NEW_MESSAGE, 0);
-    HAL_FDCAN_ActivateNotification(can->canHandler, FDCAN_IT_RX_FIFO1_NEW_MESSAGE, 0);
+    if (HAL_FDCAN_Start(can->canHandler) != HAL_OK) return 1;
+
+    /* 只使能有过滤器指向的FIFO的新消息中断 */
+    if (useFifo0) HAL_FDCAN_ActivateNotification(can->canHandler, FDCAN_IT_RX_FIFO0_NEW_MESSAGE | FDCAN_IT_RX_FIFO0_MESSAGE_LOST, 0);
+    if (useFifo1) HAL_FDCAN_ActivateNotification(can->canHandler, FDCAN_IT_RX_FIFO1_NEW_MESSAGE | FDCAN_IT_RX_FIFO1_MESSAGE_LOST, 0);
+    HAL_FDCAN_ActivateNotification(can->canHandler, CAN_IT_HEALTH_LIST, 0);
+
+    HAL_FDCAN_ActivateNotification(can->canHandler, FDCAN_IT_TX_COMPLETE,
+                                   0xFFFFFFFFU >> (32U - can->canHandler->Init.TxFifoQueueElmtsNbr));
+    __HAL_FDCAN_DISABLE_IT(can->canHandler, FDCAN_IT_TX_COMPLETE);
 
     return 0;
 }
 
 /**
- * @brief 通过CAN接口发送数据
- * @param can: CAN实例指针，包含CAN控制器句柄和发送缓冲区信息
- * @param bufferTx: 发送数据缓冲区指针，包含要发送的CAN消息头和数据
- * @retval uint8_t: 发送结果，1表示发送成功，0表示发送失败
- * 
- * 该函数首先检查发送FIFO是否有空闲位置，如果有则尝试发送数据。
- * 如果发送FIFO长时间满载，则会采取措施清除发送请求以避免死锁。
+ * @brief 数据长度码转换为数据字节数
+ * @param dlc: FDCAN_DLC_BYTES_x
+ * @retval 数据字节数
  */
-uint8_t CAN_Send(CAN_Instance_t *can, CAN_TxBuffer_t *bufferTx)
+uint8_t CAN_DlcToLen(uint32_t dlc)
+{
+    return canDlcToLen[dlc & 0x0FU];
+}
+
+/**
+ * @brief 数据字节数转换为数据长度码
+ * @param len: 数据字节数
+ * @retval 能容纳 len 字节的最小数据长度码，超过64字节时返回 FDCAN_DLC_BYTES_64
+ */
+uint32_t CAN_LenToDlc(uint8_t len)
+{
+    if (len <= 8U) return len;
+
+    uint32_t dlc = 9U;
+    while (dlc < 15U && canDlcToLen[dlc] < len) dlc++;
+    return dlc;
+}
+
+/**
+ * @brief 内部函数：估算一帧在总线上占用的标称位时间数，用于总线负载统计
+ * @param can: CAN实例指针
+ * @param idType: FDCAN_STANDARD_ID 或 FDCAN_EXTENDED_ID
+ * @param flags: CAN_FRAME_FLAG_FD / CAN_FRAME_FLAG_BRS
+ * @param len: 数据段字节数
+ * @retval 估算位数，含帧间隔和平均约五分之一的填充位；BRS帧的数据段按位时间之比折算为标称位
+ */
+static uint32_t CAN_FrameBits(const CAN_Instance_t *can, uint32_t idType, uint8_t flags, uint32_t len)
+{
+    uint32_t arb, data;
+
+    if ((flags & CAN_FRAME_FLAG_FD) == 0U)
+    {
+        arb = ((idType == FDCAN_EXTENDED_ID) ? 64U : 44U) + 8U * len;
+        return arb + arb / 5U + 3U;
+    }
+
+    /* FD帧：仲裁段（至BRS位）与应答、帧尾按标称速率，ESI至CRC界定符按数据速率 */
+    arb  = ((idType == FDCAN_EXTENDED_ID) ? 35U : 16U) + 12U;
+    data = 5U + 8U * len + 4U + ((len > 16U) ? 21U : 17U) + 1U;
+    arb  += arb / 5U;
+    data += data / 5U;
+
+    if ((flags & CAN_FRAME_FLAG_BRS) != 0U && can->ts_tick_ns != 0U)
+        data = data * can->data_bit_ns / can->ts_tick_ns;
+
+    return arb + data + 3U;
+}
+
+/**
+ * @brief 内部函数：从软件发送队列中选出最紧急的一帧
+ * @param q: 发送队列，调用者保证非空
+ * @retval 帧所在槽位下标
+ */
+static uint8_t CAN_TxPickUrgent(const CAN_TxQueue_t *q)
 {
-    /* 复制发送消息头信息到CAN实例的发送缓冲区 */
-    can->txBuffer.txHeader.Identifier = bufferTx->txHeader.Identifier;
-    can->txBuffer.txHeader.IdType     = bufferTx->txHeader.IdType;
-    can->txBuffer.txHeader.DataLength = bufferTx->txHeader.DataLength;
+    uint8_t best = CAN_TX_QUEUE_SIZE;
 
-    // 检查 FIFO 是否有空位
-    if (HAL_FDCAN_GetTxFifoFreeLevel(can->canHandler) > 0)
+    for (uint8_t i = 0; i < CAN_TX_QUEUE_SIZE; i++)
     {
-        can->tx_congest_cnt = 0; 
-        if (HAL_FDCAN_AddMessageToTxFifoQ(can->canHandler, &can->txBuffer.txHeader, bufferTx->data) == HAL_OK)
+        if ((q->used & (1UL << i)) == 0U) continue;
+        if (best == CAN_TX_QUEUE_SIZE) { best = i; continue; }
+
+        int32_t diff = (int32_t)(q->slot[i].deadline - q->slot[best].deadline);
+        if (diff < 0 || (diff == 0 && q->slot[i].id < q->slot[best].id)
+            || (diff == 0 && q->slot[i].id == q->slot[best].id && (int32_t)(q->slot[i].order - q->slot[best].order) < 0))
+            best = i;
+    }
+    return best;
+}
+
+#if CAN_REC_ENABLE
+/**
+ * @brief 内部函数：补全ID类型和来源CAN后交给记录器
+ */
+static void CAN_Record(const CAN_Instance_t *can, uint8_t flags, uint32_t idType, uint32_t id, uint8_t fifo,
+                       uint32_t timestamp, const uint8_t *data, uint8_t len)
+{
+    if (idType == FDCAN_EXTENDED_ID) flags |= CAN_REC_FLAG_EXT;
+    if (can == &can2)                flags |= CAN_REC_FLAG_CAN2;
+    CAN_RecFrame(flags, id, fifo, timestamp, data, len);
+}
+#endif
+
+/**
+ * @brief 内部函数：把软件发送队列中的帧按紧急程度压入硬件发送FIFO
+ * @param can: CAN实例指针
+ * @param now: 当前系统节拍，用于统计超时帧
+ * @note  须在临界区内调用。硬件FIFO中最多保留 CAN_TX_INFLIGHT_MAX 帧，
+ *        其余帧留在软件队列中，仍可被同ID的新指令覆盖；队列非空时打开发送完成中断继续补充。
+ */
+static void CAN_TxPump(CAN_Instance_t *can, TickType_t now)
+{
+    CAN_TxQueue_t *q = &can->txQueue;
+    FDCAN_TxHeaderTypeDef *header = &can->txBuffer.txHeader;
+    uint32_t fifoNum = can->canHandler->Init.TxFifoQueueElmtsNbr;
+
+    while (q->used != 0U)
+    {
+        uint32_t freeLevel = HAL_FDCAN_GetTxFifoFreeLevel(can->canHandler);
+        if (freeLevel == 0U || fifoNum - freeLevel >= CAN_TX_INFLIGHT_MAX) break;
+
+        uint8_t idx = CAN_TxPickUrgent(q);
+        CAN_TxSlot_t *slot = &q->slot[idx];
+
+        header->Identifier    = slot->id;
+        header->IdType        = slot->idType;
+        header->DataLength    = CAN_LenToDlc(slot->len);
+        header->FDFormat      = (slot->flags & CAN_FRAME_FLAG_FD) ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
+        header->BitRateSwitch = (slot->flags & CAN_FRAME_FLAG_BRS) ? FDCAN_BRS_ON : FDCAN_BRS_OFF;
+        if (HAL_FDCAN_AddMessageToTxFifoQ(can->canHandler, header, slot->data) != HAL_OK) break;
+#if CAN_REC_ENABLE
+        CAN_Record(can, CAN_REC_FLAG_TX | slot->flags, slot->idType, slot->id, 0, Timebase_Us(), slot->data, slot->len);
+#endif
+
+        if ((int32_t)(now - slot->deadline) > 0) q->late_cnt++;
+        q->bit_cnt += CAN_FrameBits(can, slot->idType, slot->flags, canDlcToLen[header->DataLength]);
+        q->used &= ~(1UL << idx);
+        q->depth--;
+        q->sent_cnt++;
+    }
+
+    if (q->used != 0U) __HAL_FDCAN_ENABLE_IT(can->canHandler, FDCAN_IT_TX_COMPLETE);
+    else               __HAL_FDCAN_DISABLE_IT(can->canHandler, FDCAN_IT_TX_COMPLETE);
+}
+
+/**
+ * @brief 内部函数：检查发送缓冲区的帧格式与控制器配置是否相符
+ * @param can: CAN实例指针
+ * @param bufferTx: 发送数据缓冲区指针
+ * @param len: 输出数据字节数
+ * @param flags: 输出 CAN_FRAME_FLAG_x
+ * @retval uint8_t: 1表示可以发送，0表示控制器未开启FD/BRS、经典帧超过8字节或超出发送元素大小
+ */
+static uint8_t CAN_TxCheck(const CAN_Instance_t *can, const CAN_TxBuffer_t *bufferTx, uint8_t *len, uint8_t *flags)
+{
+    uint32_t frameFormat = can->canHandler->Init.FrameFormat;
+
+    *len   = CAN_DlcToLen(bufferTx->txHeader.DataLength);
+    *flags = 0;
+    if (bufferTx->txHeader.FDFormat == FDCAN_FD_CAN)
+    {
+        *flags |= CAN_FRAME_FLAG_FD;
+        if (bufferTx->txHeader.BitRateSwitch == FDCAN_BRS_ON) *flags |= CAN_FRAME_FLAG_BRS;
+    }
+    if ((*flags & CAN_FRAME_FLAG_FD) == 0U && *len > 8U) return 0;
+    if ((*flags & CAN_FRAME_FLAG_FD) != 0U && (frameFormat & FDCAN_CCCR_FDOE) == 0U) return 0;
+    if ((*flags & CAN_FRAME_FLAG_BRS) != 0U && (frameFormat & FDCAN_CCCR_BRSE) == 0U) return 0;
+    /* FDCAN_DATA_BYTES_x 为每个元素的字数，减去两个字的帧头即为数据区字数 */
+    if (*len > (can->canHandler->Init.TxElmtSize - 2U) * 4U) return 0;
+    return 1;
+}
+
+/**
+ * @brief 内部函数：把一帧放入软件发送队列
+ * @param can: CAN实例指针
+ * @param bufferTx: 发送数据缓冲区指针
+ * @param len: 数据字节数
+ * @param flags: CAN_FRAME_FLAG_x
+ * @param deadline: 发送截止时间（系统节拍）
+ * @param replace: 1表示覆盖队内同ID的帧，0表示另占一个槽位
+ * @retval uint8_t: 1表示已入队，0表示队列已满且队内帧都更紧急
+ * @note  须在临界区内调用
+ */
+static uint8_t CAN_TxEnqueue(CAN_Instance_t *can, const CAN_TxBuffer_t *bufferTx, uint8_t len, uint8_t flags,
+                             TickType_t deadline, uint8_t replace)
+{
+    CAN_TxQueue_t *q = &can->txQueue;
+    uint8_t idx = CAN_TX_QUEUE_SIZE;
+    uint8_t ret = 1;
+
+    for (uint8_t i = 0; i < CAN_TX_QUEUE_SIZE && replace; i++)
+    {
+        if ((q->used & (1UL << i)) != 0U && q->slot[i].id == bufferTx->txHeader.Identifier
+            && q->slot[i].idType == bufferTx->txHeader.IdType)
         {
-            return 1; // 发送成功
+            idx = i;
+            q->replace_cnt++;
+            break;
+        }
+    }
+
+    if (idx == CAN_TX_QUEUE_SIZE)
+    {
+        for (uint8_t i = 0; i < CAN_TX_QUEUE_SIZE; i++)
+        {
+            if ((q->used & (1UL << i)) == 0U) { idx = i; break; }
+        }
+
+        if (idx < CAN_TX_QUEUE_SIZE)
+        {
+            q->depth++;
+            if (q->depth > q->depth_max) q->depth_max = q->depth;
         }
         else
         {
-            return 0; // 发送失败
+            /* 队列已满，挤出截止时间最晚的一帧 */
+            uint8_t latest = 0;
+            for (uint8_t i = 1; i < CAN_TX_QUEUE_SIZE; i++)
+            {
+                if ((int32_t)(q->slot[i].deadline - q->slot[latest].deadline) > 0) latest = i;
+            }
+            if ((int32_t)(deadline - q->slot[latest].deadline) < 0) idx = latest;
+            else ret = 0;
+            q->overflow_cnt++;
         }
     }
-    else
+
+    if (idx < CAN_TX_QUEUE_SIZE)
     {
-        // 发送FIFO满，增加拥塞计数器
-        can->tx_congest_cnt++;
-        if (can->tx_congest_cnt >= 10)
-        {
-            HAL_FDCAN_AbortTxRequest(can->canHandler, FDCAN_TX_BUFFER0 | FDCAN_TX_BUFFER1 | FDCAN_TX_BUFFER2);
-            can->tx_congest_cnt = 0;
-        }
-        return 0; 
+        CAN_TxSlot_t *slot = &q->slot[idx];
+        slot->id         = bufferTx->txHeader.Identifier;
+        slot->idType     = bufferTx->txHeader.IdType;
+        slot->deadline   = deadline;
+        slot->order      = q->order++;
+        slot->len        = len;
+        slot->flags      = flags;
+        memcpy(slot->data, bufferTx->data, len);
+        q->used |= (1UL << idx);
+    }
+    return ret;
+}
+
+/**
+ * @brief 按截止时间通过CAN接口发送数据
+ * @param can: CAN实例指针，包含CAN控制器句柄和发送队列
+ * @param bufferTx: 发送数据缓冲区指针，包含要发送的CAN消息头和数据
+ * @param deadline: 发送截止时间（系统节拍）
+ * @retval uint8_t: 1表示已入队，0表示队列已满且队内帧都更紧急
+ * 
+ * 同ID的帧尚未压入硬件FIFO时直接覆盖为新数据，旧指令不会再被发出。队列满时挤出截止时间最晚的一帧，
+ * 若新帧本身最不紧急则拒绝。入队后立即尝试压入硬件FIFO，硬件FIFO不会因拥塞被整体清空。
+ * 帧格式由 txHeader.FDFormat/BitRateSwitch 逐帧决定，同一控制器上电机经典帧与板间FD+BRS帧可以混发；
+ * 控制器未开启FD/BRS、经典帧超过8字节或超出发送元素大小时拒绝。
+ */
+uint8_t CAN_SendDeadline(CAN_Instance_t *can, CAN_TxBuffer_t *bufferTx, TickType_t deadline)
+{
+    uint8_t len, flags, ret;
+
+    if (!CAN_TxCheck(can, bufferTx, &len, &flags)) return 0;
+
+    taskENTER_CRITICAL();
+    ret = CAN_TxEnqueue(can, bufferTx, len, flags, deadline, 1);
+    CAN_TxPump(can, xTaskGetTickCount());
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+/**
+ * @brief 按截止时间发送数据，不覆盖队内同ID的帧
+ * @param can: CAN实例指针
+ * @param bufferTx: 发送数据缓冲区指针
+ * @param deadline: 发送截止时间（系统节拍）
+ * @retval uint8_t: 1表示已入队，0表示队列已满且队内帧都更紧急
+ *
+ * 用于同一ID上承载不同内容、每帧都必须发出的场景（如分段传输的流控帧与连续帧共用本端发送ID）。
+ * 截止时间和ID都相同的帧按入队先后压入硬件FIFO，截止时间不早于前一帧时即可保序。
+ */
+uint8_t CAN_SendAppend(CAN_Instance_t *can, CAN_TxBuffer_t *bufferTx, TickType_t deadline)
+{
+    uint8_t len, flags, ret;
+
+    if (!CAN_TxCheck(can, bufferTx, &len, &flags)) return 0;
+
+    taskENTER_CRITICAL();
+    ret = CAN_TxEnqueue(can, bufferTx, len, flags, deadline, 0);
+    CAN_TxPump(can, xTaskGetTickCount());
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+/**
+ * @brief 一次发送多帧
+ * @param can: CAN实例指针
+ * @param bufferTx: 发送数据缓冲区指针数组
+ * @param num: 帧数
+ * @param deadline: 发送截止时间（系统节拍）
+ * @retval uint32_t: 入队帧的位图，第i位对应 bufferTx[i]
+ *
+ * 所有帧在同一个临界区内入队后只压一次硬件FIFO，截止时间相同，按ID从小到大连续压入，
+ * 不会在两帧之间被其他任务插入；帧数不超过 CAN_TX_INFLIGHT_MAX 时一次全部压入硬件FIFO。
+ */
+uint32_t CAN_SendBatch(CAN_Instance_t *can, CAN_TxBuffer_t *const *bufferTx, uint8_t num, TickType_t deadline)
+{
+    uint8_t len[CAN_TX_QUEUE_SIZE], flags[CAN_TX_QUEUE_SIZE];
+    uint32_t valid = 0;
+    uint32_t sent  = 0;
+
+    if (num > CAN_TX_QUEUE_SIZE) num = CAN_TX_QUEUE_SIZE;
+    for (uint8_t i = 0; i < num; i++)
+    {
+        if (CAN_TxCheck(can, bufferTx[i], &len[i], &flags[i])) valid |= (1UL << i);
     }
+    if (valid == 0U) return 0;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < num; i++)
+    {
+        if ((valid & (1UL << i)) && CAN_TxEnqueue(can, bufferTx[i], len[i], flags[i], deadline, 1)) sent |= (1UL << i);
+    }
+    CAN_TxPump(can, xTaskGetTickCount());
+    taskEXIT_CRITICAL();
+
+    return sent;
 }
+
 /**
- * @brief 内部函数：通用 RX 处理逻辑，合并 FIFO0 和 FIFO1
- * @param h_can: CAN控制器句柄
+ * @brief 查询某ID的帧是否仍在软件发送队列中
+ * @param can: CAN实例指针
+ * @param id: 报文ID
+ * @retval uint8_t: 1表示仍在排队，0表示不在队列中
+ */
+uint8_t CAN_TxIdPending(CAN_Instance_t *can, uint32_t id)
+{
+    CAN_TxQueue_t *q = &can->txQueue;
+    uint8_t pending = 0;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < CAN_TX_QUEUE_SIZE; i++)
+    {
+        if ((q->used & (1UL << i)) != 0U && q->slot[i].id == id) { pending = 1; break; }
+    }
+    taskEXIT_CRITICAL();
+
+    return pending;
+}
+
+/**
+ * @brief 通过CAN接口发送数据，截止时间为当前节拍加 CAN_TX_DEADLINE_DEFAULT
+ * @param can: CAN实例指针
+ * @param bufferTx: 发送数据缓冲区指针
+ * @retval uint8_t: 1表示已入队，0表示队列已满且队内帧都更紧急
+ */
+uint8_t CAN_Send(CAN_Instance_t *can, CAN_TxBuffer_t *bufferTx)
+{
+    return CAN_SendDeadline(can, bufferTx, xTaskGetTickCount() + CAN_TX_DEADLINE_DEFAULT);
+}
+
+/**
+ * @brief 根据CAN设备号获取CAN设备
+ * @param canx: CAN设备号
+ * @retval CAN实例指针，设备号无效时返回NULL
+ */
+CAN_Instance_t *CAN_GetInstance(CanNumber canx)
+{
+    if (canx == CAN1) return &can1;
+    if (canx == CAN2) return &can2;
+    return NULL;
+}
+
+/**
+ * @brief 为某一标准ID注册接收处理函数
+ * @param can: CAN实例指针
+ * @param id: 11位标准ID
+ * @param handler: 接收处理函数
+ * @param ctx: 传给处理函数的用户上下文
+ * @retval uint8_t: 0表示成功，1表示参数无效、ID已被占用或订阅者已满
+ *
+ * 处理函数先写入订阅者数组，再写ID映射表，CAN任务不会看到写了一半的订阅。
+ */
+uint8_t CAN_Subscribe(CAN_Instance_t *can, uint16_t id, CAN_RxHandler handler, void *ctx)
+{
+    CAN_RouteTable_t *route;
+
+    if (can == NULL || handler == NULL || id >= CAN_STD_ID_NUM) return 1;
+
+    route = &canRoute[(can == &can2) ? 1 : 0];
+    if (route->idMap[id] != 0U || route->subscriber_cnt >= CAN_SUBSCRIBER_MAX) return 1;
+
+    route->subscriber[route->subscriber_cnt].handler = handler;
+    route->subscriber[route->subscriber_cnt].ctx     = ctx;
+    route->subscriber_cnt++;
+    route->idMap[id] = route->subscriber_cnt;
+
+    return 0;
+}
+
+/**
+ * @brief 取消某一标准ID的订阅，用于设备初始化中途失败时撤销已完成的订阅
+ * @param can: CAN实例指针
+ * @param id: 11位标准ID
+ * @retval uint8_t: 0表示成功，1表示参数无效或该ID没有订阅者
+ *
+ * 先清ID映射表，CAN任务之后不再分发到该订阅者；撤销的是最近一次订阅时回收其在订阅者数组中的位置，
+ * 否则该位置保留不用（订阅者数组不搬移，已登记的映射保持有效）。
+ */
+uint8_t CAN_Unsubscribe(CAN_Instance_t *can, uint16_t id)
+{
+    CAN_RouteTable_t *route;
+    uint8_t slot;
+
+    if (can == NULL || id >= CAN_STD_ID_NUM) return 1;
+
+    route = &canRoute[(can == &can2) ? 1 : 0];
+    slot  = route->idMap[id];
+    if (slot == 0U) return 1;
+
+    route->idMap[id] = 0;
+    if (slot == route->subscriber_cnt) route->subscriber_cnt--;
+
+    return 0;
+}
+
+/**
+ * @brief 按ID查表把报文分发给订阅者
+ * @param can: CAN实例指针
+ * @param frame: 接收到的报文
+ *
+ * 无订阅者或ID超出标准ID范围的报文计入 rx_unhandled_cnt。
+ */
+void CAN_Dispatch(CAN_Instance_t *can, const CAN_RxFrame_t *frame)
+{
+    const CAN_RouteTable_t *route = &canRoute[(can == &can2) ? 1 : 0];
+    uint8_t slot = (frame->id < CAN_STD_ID_NUM) ? route->idMap[frame->id] : 0U;
+
+    if (slot == 0U)
+    {
+        can->rx_unhandled_cnt++;
+        return;
+    }
+
+    route->subscriber[slot - 1U].handler(can, frame, route->subscriber[slot - 1U].ctx);
+}
+
+/**
+ * @brief 内部函数：帧取出后立即读取时间戳计数器和微秒时基，用两者之差把帧起始时刻换算到微秒时基上
+ */
+static uint32_t CAN_RxTimestamp(const CAN_Instance_t *pCan, const FDCAN_RxHeaderTypeDef *rxHeader)
+{
+    uint16_t age = (uint16_t)(HAL_FDCAN_GetTimestampCounter(pCan->canHandler) - rxHeader->RxTimestamp);
+    return Timebase_Us() - (uint32_t)age * pCan->ts_tick_ns / 1000U;
+}
+
+/**
+ * @brief 内部函数：由接收消息头得到 CAN_FRAME_FLAG_x
+ */
+static uint8_t CAN_RxFlags(const FDCAN_RxHeaderTypeDef *rxHeader)
+{
+    return ((rxHeader->FDFormat == FDCAN_FD_CAN) ? CAN_FRAME_FLAG_FD : 0U)
+         | ((rxHeader->BitRateSwitch == FDCAN_BRS_ON) ? CAN_FRAME_FLAG_BRS : 0U);
+}
+
+/**
+ * @brief 内部函数：通用 RX 处理逻辑，FIFO0 和 FIFO1 共用
+ * @param pCan: CAN实例指针
  * @param rxFifo: 接收FIFO编号（FDCAN_RX_FIFO0 或 FDCAN_RX_FIFO1）
  * 
- * 此函数统一处理来自两个接收FIFO的中断，从中读取数据并通过回调函数传递给上层应用
+ * 一次中断内把FIFO中所有待处理报文搬运进该FIFO对应的接收环形缓冲区，整批搬完后只调用一次回调，
+ * 避免每帧一次队列拷贝和任务切换。环形缓冲区满时报文仍需从FIFO中取出（否则中断持续挂起），
+ * 此时丢弃该帧并计入 drop_cnt。记录器打开时，被丢弃的帧也带 CAN_REC_FLAG_DROP 记录下来。
  */
-static void CAN_CommonRxHandler(FDCAN_HandleTypeDef *h_can, uint32_t rxFifo)
+static void CAN_CommonRxHandler(CAN_Instance_t *pCan, uint32_t rxFifo)
 {
-    CAN_Instance_t *pCan = NULL;
+    FDCAN_HandleTypeDef *h_can = pCan->canHandler;
+    uint8_t fifo = (rxFifo == FDCAN_RX_FIFO0) ? 0U : 1U;
+    CAN_RxRing_t *ring = &pCan->rxRing[fifo];
+    FDCAN_RxHeaderTypeDef rxHeader;
+    uint8_t discard[CAN_FRAME_DATA_MAX];
+    uint16_t burst = 0;
 
-    if (h_can->Instance == FDCAN1) pCan = &can1;
-    else if (h_can->Instance == FDCAN2) pCan = &can2;
+    while (HAL_FDCAN_GetRxFifoFillLevel(h_can, rxFifo) > 0U)
+    {
+        uint32_t head = ring->head;
+
+        /* 环形缓冲区已满，取出并丢弃 */
+        if ((head - ring->tail) >= CAN_RX_RING_SIZE)
+        {
+            if (HAL_FDCAN_GetRxMessage(h_can, rxFifo, &rxHeader, discard) != HAL_OK) break;
+            ring->drop_cnt++;
+#if CAN_REC_ENABLE
+            CAN_Record(pCan, CAN_REC_FLAG_DROP | CAN_RxFlags(&rxHeader), rxHeader.IdType, rxHeader.Identifier, fifo,
+                       CAN_RxTimestamp(pCan, &rxHeader), discard, CAN_DlcToLen(rxHeader.DataLength));
+#endif
+            continue;
+        }
+
+        CAN_RxFrame_t *frame = &ring->frame[head & (CAN_RX_RING_SIZE - 1U)];
+        if (HAL_FDCAN_GetRxMessage(h_can, rxFifo, &rxHeader, frame->data) != HAL_OK) break;
+
+        frame->timestamp = CAN_RxTimestamp(pCan, &rxHeader);
+        frame->id        = rxHeader.Identifier;
+        frame->len       = CAN_DlcToLen(rxHeader.DataLength);
+        frame->fifo      = fifo;
+        frame->flags     = CAN_RxFlags(&rxHeader);
+        ring->bit_cnt   += CAN_FrameBits(pCan, rxHeader.IdType, frame->flags, frame->len);
+#if CAN_REC_ENABLE
+        CAN_Record(pCan, frame->flags, rxHeader.IdType, frame->id, fifo, frame->timestamp, frame->data, frame->len);
+#endif
+
+        /* 帧内容写完后再发布写指针，保证消费者看到的是完整帧 */
+        __DMB();
+        ring->head = head + 1U;
+        burst++;
+    }
 
-    if (pCan == NULL) return;
+    if (burst == 0U) return;
 
-    if (HAL_FDCAN_GetRxMessage(h_can, rxFifo, &pCan->rxBuffer.rxHeader, pCan->rxBuffer.data) == HAL_OK)
+    ring->frame_cnt += burst;
+    if (burst > ring->burst_max) ring->burst_max = burst;
+
+    if (pCan->RxCallBackCAN != NULL)
     {
-        if (pCan->RxCallBackCAN != NULL)
+        pCan->RxCallBackCAN(pCan);
+    }
+}
+
+/**
+ * @brief FDCAN中断线0服务函数
+ * @param can: CAN实例指针
+ *
+ * 直接读取IR寄存器，只取使能且分配到中断线0的标志，不经过 HAL_FDCAN_IRQHandler() 逐项轮询全部中断源。
+ * 先写1清除标志再搬运FIFO，搬运期间到达的新报文会重新置位标志，不会丢失中断。
+ */
+void CAN_IT0_IRQHandler(CAN_Instance_t *can)
+{
+    FDCAN_GlobalTypeDef *fdcan = can->canHandler->Instance;
+    uint32_t ir = fdcan->IR & fdcan->IE & ~fdcan->ILS;
+
+    fdcan->IR = ir;
+
+    if (ir & FDCAN_IT_RX_FIFO0_NEW_MESSAGE) CAN_CommonRxHandler(can, FDCAN_RX_FIFO0);
+}
+
+/**
+ * @brief FDCAN中断线1服务函数
+ * @param can: CAN实例指针
+ *
+ * 处理分配到中断线1（CAN_IT_LINE1_LIST）的事件：FIFO1新消息、发送完成和总线健康事件，
+ * 优先级低于中断线0，可被FIFO0的搬运打断。PSR中的LEC/DLEC读后清零，每次中断只读一次。
+ * 总线关闭时控制器自动进入初始化模式，这里只记录时刻，由 CAN_HealthPoll() 在等待时间到达后恢复。
+ */
+void CAN_IT1_IRQHandler(CAN_Instance_t *can)
+{
+    FDCAN_GlobalTypeDef *fdcan = can->canHandler->Instance;
+    uint32_t ir = fdcan->IR & fdcan->IE & fdcan->ILS;
+
+    fdcan->IR = ir;
+
+    if (ir & FDCAN_IT_RX_FIFO1_NEW_MESSAGE) CAN_CommonRxHandler(can, FDCAN_RX_FIFO1);
+
+    if (ir & FDCAN_IT_RX_FIFO0_MESSAGE_LOST) can->health.rx_lost_cnt[0]++;
+    if (ir & FDCAN_IT_RX_FIFO1_MESSAGE_LOST) can->health.rx_lost_cnt[1]++;
+
+    if (ir & CAN_IT_HEALTH_LIST)
+    {
+        uint32_t psr = fdcan->PSR;
+
+        if (ir & FDCAN_IT_ARB_PROTOCOL_ERROR)  can->health.lec_cnt[(psr & FDCAN_PSR_LEC) >> FDCAN_PSR_LEC_Pos]++;
+        if (ir & FDCAN_IT_DATA_PROTOCOL_ERROR) can->health.dlec_cnt[(psr & FDCAN_PSR_DLEC) >> FDCAN_PSR_DLEC_Pos]++;
+        if ((ir & FDCAN_IT_ERROR_WARNING) && (psr & FDCAN_PSR_EW)) can->health.error_warning_cnt++;
+        if ((ir & FDCAN_IT_ERROR_PASSIVE) && (psr & FDCAN_PSR_EP)) can->health.error_passive_cnt++;
+        if ((ir & FDCAN_IT_BUS_OFF) && (psr & FDCAN_PSR_BO))
+        {
+            can->health.busoff_at = Timebase_Us();
+            can->health.busoff_cnt++;
+#if CAN_REC_ENABLE
+            CAN_RecTrigger(CAN_REC_POST_DEFAULT);
+#endif
+        }
+    }
+
+    /* 硬件FIFO有帧发出，从软件发送队列补充 */
+    if (ir & FDCAN_IT_TX_COMPLETE)
+    {
+        UBaseType_t status = taskENTER_CRITICAL_FROM_ISR();
+        CAN_TxPump(can, xTaskGetTickCountFromISR());
+        taskEXIT_CRITICAL_FROM_ISR(status);
+
+        /* 有任务在等发送队列腾出空间，唤醒一次 */
+        if (can->tx_wake && can->rxTask != NULL)
         {
-            pCan->RxCallBackCAN(pCan);
+            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+            can->tx_wake = 0;
+            vTaskNotifyGiveFromISR(can->rxTask, &xHigherPriorityTaskWoken);
+            portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         }
     }
 }
 
-// 统一调用通用处理函数
-void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *h_can, uint32_t RxFifo0ITs)
+/**
+ * @brief 取出接收环形缓冲区中最早的一帧，FIFO0的缓冲区优先
+ * @param can: CAN实例指针
+ * @retval 指向环形缓冲区内帧的指针，缓冲区均为空时返回NULL
+ * @note   返回的指针在调用 CAN_RxRelease() 之前一直有效，仅供 rxTask 调用
+ */
+const CAN_RxFrame_t *CAN_RxPeek(CAN_Instance_t *can)
 {
-    (void)RxFifo0ITs;
-    CAN_CommonRxHandler(h_can, FDCAN_RX_FIFO0);
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        CAN_RxRing_t *ring = &can->rxRing[i];
+        uint32_t tail = ring->tail;
+
+        if (tail == ring->head) continue;
+
+        /* 先读到写指针再读帧内容 */
+        __DMB();
+        return &ring->frame[tail & (CAN_RX_RING_SIZE - 1U)];
+    }
+    return NULL;
+}
+
+/**
+ * @brief 释放 CAN_RxPeek() 取得的帧，归还槽位给接收中断
+ * @param can: CAN实例指针
+ * @param frame: CAN_RxPeek() 返回的帧
+ */
+void CAN_RxRelease(CAN_Instance_t *can, const CAN_RxFrame_t *frame)
+{
+    CAN_RxRing_t *ring = &can->rxRing[frame->fifo];
+
+    /* 帧内容使用完毕后再推进读指针 */
+    __DMB();
+    ring->tail = ring->tail + 1U;
+}
+
+/**
+ * @brief 设置总线关闭后的恢复等待时间
+ * @param can: CAN实例指针
+ * @param baseMs: 首次等待时间（毫秒）
+ * @param maxMs: 等待时间上限（毫秒）
+ */
+void CAN_SetBusOffBackoff(CAN_Instance_t *can, uint32_t baseMs, uint32_t maxMs)
+{
+    can->health.backoff_base_us = baseMs * 1000U;
+    can->health.backoff_max_us  = (maxMs < baseMs ? baseMs : maxMs) * 1000U;
+    can->health.backoff_us      = can->health.backoff_base_us;
 }
 
-void HAL_FDCAN_RxFifo1Callback(FDCAN_HandleTypeDef *h_can, uint32_t RxFifo1ITs)
+/**
+ * @brief 更新总线健康统计并处理总线关闭恢复
+ * @param can: CAN实例指针
+ *
+ * 每个统计窗口（CAN_HEALTH_WINDOW_US）结束时，由累计帧数和累计位数的差值计算帧率和总线负载。
+ * 发现新的总线关闭时先决定本次的等待时间：上次恢复后 CAN_BUSOFF_STABLE_MS 内再次关闭则加倍，否则回到初值；
+ * 等待 backoff_us 后清除INIT位，控制器检测到129次11个隐性位后重新入网。
+ */
+void CAN_HealthPoll(CAN_Instance_t *can)
 {
-    (void)RxFifo1ITs;
-    CAN_CommonRxHandler(h_can, FDCAN_RX_FIFO1);
+    CAN_Health_t *h = &can->health;
+    FDCAN_GlobalTypeDef *fdcan = can->canHandler->Instance;
+    uint32_t now = Timebase_Us();
+    uint32_t ecr = fdcan->ECR;
+
+    h->tec = (uint8_t)((ecr & FDCAN_ECR_TEC) >> FDCAN_ECR_TEC_Pos);
+    h->rec = (uint8_t)((ecr & FDCAN_ECR_REC) >> FDCAN_ECR_REC_Pos);
+
+    if (h->busoff_cnt != h->busoff_ack)
+    {
+        /* 次数与时刻在临界区内一起读取，中断不会在两次读取之间再记一次 */
+        taskENTER_CRITICAL();
+        h->busoff_ack     = h->busoff_cnt;
+        h->busoff_wait_at = h->busoff_at;
+        taskEXIT_CRITICAL();
+
+        /* 上次恢复后很快再次关闭，说明总线故障仍在，本次等待时间加倍 */
+        if (h->busoff_recover_cnt != 0U && h->busoff_wait_at - h->recover_at < CAN_BUSOFF_STABLE_MS * 1000U)
+            h->backoff_us = (h->backoff_us * 2U > h->backoff_max_us) ? h->backoff_max_us : h->backoff_us * 2U;
+        else
+            h->backoff_us = h->backoff_base_us;
+        h->busoff_wait = 1;
+    }
+
+    if (h->busoff_wait)
+    {
+        h->state = CAN_BUS_OFF;
+        if (now - h->busoff_wait_at >= h->backoff_us)
+        {
+            h->busoff_wait = 0;
+            h->recover_at  = now;
+            h->busoff_recover_cnt++;
+            CLEAR_BIT(fdcan->CCCR, FDCAN_CCCR_INIT);
+        }
+    }
+    else if ((ecr & FDCAN_ECR_RP) || h->tec >= 128U || h->rec >= 128U) h->state = CAN_BUS_PASSIVE;
+    else if (h->tec >= 96U || h->rec >= 96U)                            h->state = CAN_BUS_WARNING;
+    else                                                                h->state = CAN_BUS_ACTIVE;
+
+    uint32_t elapsed = now - h->win_start;
+    if (elapsed < CAN_HEALTH_WINDOW_US) return;
+
+    uint32_t rxFrames = can->rxRing[0].frame_cnt + can->rxRing[1].frame_cnt;
+    uint32_t txFrames = can->txQueue.sent_cnt;
+    uint32_t bits     = can->rxRing[0].bit_cnt + can->rxRing[1].bit_cnt + can->txQueue.bit_cnt;
+    uint32_t bitRate  = (can->ts_tick_ns != 0U) ? 1000000000U / can->ts_tick_ns : 0U;
+
+    h->rx_fps = (uint16_t)((uint64_t)(rxFrames - h->win_rx_frames) * 1000000U / elapsed);
+    h->tx_fps = (uint16_t)((uint64_t)(txFrames - h->win_tx_frames) * 1000000U / elapsed);
+    if (bitRate != 0U)
+    {
+        uint32_t load = (uint32_t)((uint64_t)(bits - h->win_bits) * 1000000000U / ((uint64_t)bitRate * elapsed));
+        h->bus_load = (uint16_t)(load > 1000U ? 1000U : load);
+    }
+
+    h->win_start     = now;
+    h->win_rx_frames = rxFrames;
+    h->win_tx_frames = txFrames;
+    h->win_bits      = bits;
 }
 
 /**
  * @brief  CAN接收中断回调 (通用)
- * @note   将整个 rxBuffer (含ID和数据) 发送至队列
+ * @note   每批报文只发送一次任务通知，由 rxTask 一次性取完环形缓冲区
  */
 static uint8_t CAN_General_RxCallback(CAN_Instance_t *canObject)
 {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    
-    // 在中断服务例程中向队列发送接收到的CAN数据
-    xQueueSendFromISR(canObject->xQueueCan, &canObject->rxBuffer, &xHigherPriorityTaskWoken);
-    
+
+    if (canObject->rxTask == NULL) return 1;
+
+    vTaskNotifyGiveFromISR(canObject->rxTask, &xHigherPriorityTaskWoken);
+
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     return 0;
 }
@@ -0,0 +1,196 @@
+/**
+ **********************************************************************************
+ * @file        driver_can_rec.c
+ * @brief       驱动层，CAN收发记录器
+ * @details     在接收中断和发送路径上把每一帧连同微秒时间戳写入 RAM_D2 中的环形缓冲区，
+ *              满后覆盖最早的条目。出现异常时触发冻结，保留事件前后的报文，由后台任务导出，
+ *              再用主机端 Cubot/Sim 中的 cubot_replay 回放。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * 硬件平台: STM32H750VBT \n
+ * SDK版本：-++++
+ **********************************************************************************
+ ==============================================================================
+                            How to use this driver
+ ==============================================================================
+
+    添加driver_can_rec.h
+
+    1. 记录器默认不编译（CAN_REC_ENABLE 为0），收发中断不增加任何开销；需要记录时以 cmake -DCAN_REC=ON 配置固件，
+       Init_Task 在 CAN_Open() 之前调用 CAN_RecInit() 和 CAN_RecStart() 开始循环记录，收发记录由 driver_can.c 自动完成
+
+    2. 发现异常时调用 CAN_RecTrigger() 冻结记录（总线关闭时自动触发），
+       状态变为 CAN_REC_HOLD 后由后台任务用 CAN_RecReaderInit()/CAN_RecRead() 取出导出，
+       导出格式为 CAN_RecHeader_t 加若干 CAN_RecEntry_t，见 can_task.c 中的 CanRecTask_Process()
+
+    3. 导出完成后调用 CAN_RecStart() 重新开始记录
+
+    满载的1Mbps总线每秒约8000帧，8192条约记录1秒；串口带宽远低于总线带宽，不适合边记边导出
+
+ **********************************************************************************
+ */
+#include "driver_can_rec.h"
+#include "freertos.h"
+#include "task.h"
+#include <string.h>
+
+#if CAN_REC_ENABLE
+
+_Static_assert((CAN_REC_ENTRY_NUM & (CAN_REC_ENTRY_NUM - 1U)) == 0U, "CAN_REC_ENTRY_NUM must be a power of 2");
+_Static_assert(sizeof(CAN_RecEntry_t) == 20U, "CAN_RecEntry_t layout is part of the dump format");
+_Static_assert(sizeof(CAN_RecHeader_t) == 16U, "CAN_RecHeader_t layout is part of the dump format");
+
+static CAN_RecEntry_t canRecBuf[CAN_REC_ENTRY_NUM] CAN_REC_SECTION;
+static volatile uint32_t canRecHead;  // 累计写入的条目数，自由增长
+static volatile uint32_t canRecBase;  // 本轮记录起点，之前的条目不再可读
+static volatile uint32_t canRecPost;  // 触发后剩余的条目数
+static volatile uint8_t canRecState = CAN_REC_OFF;
+
+/**
+ * @brief 内部函数：当前最早的可读条目序号
+ */
+static uint32_t CAN_RecOldest(uint32_t head)
+{
+    return (head - canRecBase > CAN_REC_ENTRY_NUM) ? head - CAN_REC_ENTRY_NUM : canRecBase;
+}
+
+void CAN_RecInit(void)
+{
+    /* 复位后 D2 域的 SRAM1/SRAM2 时钟关闭，160KB 的缓冲区跨越这两块 */
+    __HAL_RCC_D2SRAM1_CLK_ENABLE();
+    __HAL_RCC_D2SRAM2_CLK_ENABLE();
+
+    canRecState = CAN_REC_OFF;
+    canRecHead  = 0;
+    canRecBase  = 0;
+    canRecPost  = 0;
+}
+
+void CAN_RecStart(void)
+{
+    UBaseType_t status = taskENTER_CRITICAL_FROM_ISR();
+    canRecBase  = canRecHead;
+    canRecState = CAN_REC_RUN;
+    taskEXIT_CRITICAL_FROM_ISR(status);
+}
+
+void CAN_RecStop(void)
+{
+    canRecState = CAN_REC_OFF;
+}
+
+void CAN_RecTrigger(uint32_t post)
+{
+    UBaseType_t status = taskENTER_CRITICAL_FROM_ISR();
+    if (canRecState == CAN_REC_RUN)
+    {
+        canRecPost  = post;
+        canRecState = (post == 0U) ? CAN_REC_HOLD : CAN_REC_POST;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(status);
+}
+
+uint8_t CAN_RecGetState(void)
+{
+    return canRecState;
+}
+
+/**
+ * @brief 记录一帧
+ * @note  多条中断线和任务都会写入，条目的分配和填写在同一个临界区内完成，
+ *        读者看到 canRecHead 前进时对应条目已经完整
+ */
+void CAN_RecFrame(uint8_t flags, uint32_t id, uint8_t fifo, uint32_t timestamp, const uint8_t *data, uint8_t len)
+{
+    uint8_t segNum = (len == 0U) ? 1U : (uint8_t)((len + 7U) / 8U);
+
+    if (canRecState != CAN_REC_RUN && canRecState != CAN_REC_POST) return;
+
+    UBaseType_t status = taskENTER_CRITICAL_FROM_ISR();
+    if (canRecState == CAN_REC_RUN || canRecState == CAN_REC_POST)
+    {
+        uint32_t head = canRecHead;
+
+        for (uint8_t seg = 0; seg < segNum; seg++)
+        {
+            CAN_RecEntry_t *e = &canRecBuf[(head + seg) & (CAN_REC_ENTRY_NUM - 1U)];
+            uint8_t n = (uint8_t)(len - seg * 8U);
+
+            if (n > 8U) n = 8U;
+            e->timestamp = timestamp;
+            e->id        = id;
+            e->len       = len;
+            e->flags     = flags;
+            e->seg       = seg;
+            e->fifo      = fifo;
+            memcpy(e->data, &data[seg * 8U], n);
+            memset(&e->data[n], 0, 8U - n);
+        }
+        __DMB();
+        canRecHead = head + segNum;
+
+        if (canRecState == CAN_REC_POST)
+        {
+            if (canRecPost <= segNum) canRecState = CAN_REC_HOLD;
+            else                      canRecPost -= segNum;
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(status);
+}
+
+uint32_t CAN_RecReaderInit(CAN_RecReader_t *rd)
+{
+    uint32_t head = canRecHead;
+
+    rd->pos  = CAN_RecOldest(head);
+    rd->lost = 0;
+    return head - rd->pos;
+}
+
+/**
+ * @brief 拷贝记录，不加锁：拷贝后重新检查写指针，拷贝期间被写者绕回覆盖的条目从结果开头剔除
+ */
+uint32_t CAN_RecRead(CAN_RecReader_t *rd, CAN_RecEntry_t *out, uint32_t max)
+{
+    for (;;)
+    {
+        uint32_t head   = canRecHead;
+        uint32_t oldest = CAN_RecOldest(head);
+
+        if ((int32_t)(rd->pos - oldest) < 0)
+        {
+            rd->lost += oldest - rd->pos;
+            rd->pos   = oldest;
+        }
+
+        uint32_t n = head - rd->pos;
+        if (n > max) n = max;
+        if (n == 0U) return 0;
+
+        __DMB();
+        for (uint32_t i = 0; i < n; i++)
+            out[i] = canRecBuf[(rd->pos + i) & (CAN_REC_ENTRY_NUM - 1U)];
+        __DMB();
+
+        uint32_t overwritten = 0;
+        head = canRecHead;
+        if (head - rd->pos > CAN_REC_ENTRY_NUM) overwritten = head - CAN_REC_ENTRY_NUM - rd->pos;
+
+        if (overwritten < n)
+        {
+            if (overwritten != 0U) memmove(out, &out[overwritten], (n - overwritten) * sizeof(CAN_RecEntry_t));
+            rd->lost += overwritten;
+            rd->pos  += n;
+            return n - overwritten;
+        }
+
+        /* 整批都被覆盖，从新的最早条目重读 */
+        rd->lost += overwritten;
+        rd->pos  += overwritten;
+    }
+}
+
+#endif
@@ -0,0 +1,408 @@
+/**
+ **********************************************************************************
+ * @file        driver_can_tp.c
+ * @brief       驱动层，CAN分段传输（参照ISO 15765-2）
+ * @details     在 CAN_Send() 与接收分发之上实现单帧/首帧/连续帧/流控帧，用于标定表、参数块、
+ *              视觉目标转发等超过一帧的数据。支持经典帧（单帧7字节）和CAN FD帧（单帧62字节）
+ * @date        2024-07-24
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * 硬件平台: STM32H750VBT \n
+ * SDK版本：-++++
+ **********************************************************************************
+ ==============================================================================
+                            How to use this driver
+ ==============================================================================
+
+    添加driver_can_tp.h
+
+    1. 为每对收发ID创建 CANTP_Link_t 和接收缓冲区，调用 CANTP_Open() 打开链路（同时订阅接收ID），
+       需要发送结束通知时填写 link->txCallback。接收ID须加入过滤器表，FD链路须指向FIFO1
+
+    2. CAN任务每次唤醒调用 CANTP_Poll()，推进连续帧发送和超时检测；
+       对端连续回复WAIT流控帧超过 CANTP_WFT_MAX 次时，发送以 CANTP_TIMEOUT 结束
+
+    3. 调用 CANTP_Send() 发送消息，消息完整接收后在CAN任务中调用 rxCallback
+
+ **********************************************************************************
+ */
+#include "driver_can_tp.h"
+#include <string.h>
+
+#define CANTP_PCI_SF 0x00U // 单帧
+#define CANTP_PCI_FF 0x10U // 首帧
+#define CANTP_PCI_CF 0x20U // 连续帧
+#define CANTP_PCI_FC 0x30U // 流控帧
+
+#define CANTP_FS_CTS  0x00U // 继续发送
+#define CANTP_FS_WAIT 0x01U // 等待
+#define CANTP_FS_OVFL 0x02U // 溢出
+
+/* 每路CAN上已打开的链路 */
+static CANTP_Link_t *cantpLinks[2][CANTP_LINK_MAX];
+static uint8_t cantpLinkCnt[2];
+
+static void CANTP_OnFrame(CAN_Instance_t *can, const CAN_RxFrame_t *frame, void *ctx);
+
+/**
+ * @brief 内部函数：链路单帧最大字节数
+ */
+static inline uint8_t CANTP_FrameMax(const CANTP_Link_t *link)
+{
+    return link->fd ? CAN_FRAME_DATA_MAX : 8U;
+}
+
+/**
+ * @brief 内部函数：STmin编码转换为微秒
+ * @param stmin: 0x00~0x7F 为毫秒，0xF1~0xF9 为100~900微秒，其余保留值按127毫秒处理
+ */
+static uint32_t CANTP_StminToUs(uint8_t stmin)
+{
+    if (stmin <= 0x7FU) return (uint32_t)stmin * 1000U;
+    if (stmin >= 0xF1U && stmin <= 0xF9U) return (uint32_t)(stmin - 0xF0U) * 100U;
+    return 127000U;
+}
+
+/**
+ * @brief 内部函数：填充并发送一帧
+ * @param link: 链路
+ * @param pdu: 协议数据（PCI + 数据）
+ * @param len: 协议数据长度
+ * @retval 1表示已入发送队列，0表示失败
+ *
+ * 经典帧固定补齐到8字节；FD帧不足8字节补齐到8字节，否则补齐到下一个合法FD长度。
+ * 接收会话的流控帧与发送会话的首帧、连续帧共用本端发送ID，因此用 CAN_SendAppend() 入队，
+ * 双向同时传输时流控帧不会被连续帧覆盖（反之亦然）。
+ */
+static uint8_t CANTP_SendFrame(CANTP_Link_t *link, const uint8_t *pdu, uint8_t len)
+{
+    CAN_TxBuffer_t tx;
+    uint8_t padLen = (len <= 8U) ? 8U : CAN_DlcToLen(CAN_LenToDlc(len));
+
+    tx.txHeader.Identifier    = link->txId;
+    tx.txHeader.IdType        = FDCAN_STANDARD_ID;
+    tx.txHeader.DataLength    = CAN_LenToDlc(padLen);
+    tx.txHeader.FDFormat      = link->fd ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
+    tx.txHeader.BitRateSwitch = link->fd ? FDCAN_BRS_ON : FDCAN_BRS_OFF;
+    memcpy(tx.data, pdu, len);
+    memset(&tx.data[len], CANTP_PAD_BYTE, padLen - len);
+
+    return CAN_SendAppend(link->can, &tx, xTaskGetTickCount() + CAN_TX_DEADLINE_DEFAULT);
+}
+
+/**
+ * @brief 内部函数：发送流控帧
+ */
+static void CANTP_SendFlowControl(CANTP_Link_t *link, uint8_t fs)
+{
+    uint8_t pdu[3] = {CANTP_PCI_FC | fs, link->blockSize, link->stmin};
+    CANTP_SendFrame(link, pdu, sizeof(pdu));
+}
+
+/**
+ * @brief 内部函数：结束发送会话
+ */
+static void CANTP_TxFinish(CANTP_Link_t *link, uint8_t result)
+{
+    link->txState = CANTP_IDLE;
+    if (result == CANTP_OK) link->tx_msg_cnt++;
+    if (link->txCallback != NULL) link->txCallback(link, result);
+}
+
+/**
+ * @brief 内部函数：按流控参数发送连续帧
+ * @param link: 链路
+ * @param now: 当前微秒时刻
+ *
+ * 上一连续帧（或本端接收会话的流控帧）离开软件发送队列后才发下一帧，一条链路在队列中最多占一个槽位，
+ * 不会挤占电机控制帧的位置；各帧按入队先后发出，末个连续帧未发出时开始的下一条消息的首帧也排在其后。STmin为0时一次调用内连续发送，直到硬件FIFO在途帧达到上限。
+ */
+static void CANTP_PumpTx(CANTP_Link_t *link, uint32_t now)
+{
+    uint8_t pdu[CAN_FRAME_DATA_MAX];
+    uint8_t payload = CANTP_FrameMax(link) - 1U;
+
+    while (link->txState == CANTP_TX_SEND_CF && link->txPos < link->txLen)
+    {
+        if (link->txStminUs != 0U && now - link->txLastUs < link->txStminUs) return;
+        if (CAN_TxIdPending(link->can, link->txId))
+        {
+            /* 等该帧压入硬件FIFO后由发送完成中断唤醒CAN任务，不必等下一批接收报文 */
+            link->can->tx_wake = 1;
+            return;
+        }
+
+        uint16_t n = link->txLen - link->txPos;
+        if (n > payload) n = payload;
+
+        pdu[0] = CANTP_PCI_CF | (link->txSn & 0x0FU);
+        memcpy(&pdu[1], &link->txData[link->txPos], n);
+        if (CANTP_SendFrame(link, pdu, (uint8_t)(n + 1U)) == 0U) return;
+
+        link->txSn++;
+        link->txPos += n;
+        link->txLastUs = now;
+
+        if (link->txPos >= link->txLen) break;
+
+        /* 一块发完，等待下一个流控帧 */
+        if (link->txBsLeft != 0U && --link->txBsLeft == 0U)
+        {
+            link->txTimer   = now;
+            link->txWaitCnt = 0U;
+            link->txState   = CANTP_TX_WAIT_FC;
+            return;
+        }
+        if (link->txStminUs != 0U) return;
+    }
+
+    if (link->txState == CANTP_TX_SEND_CF && link->txPos >= link->txLen) CANTP_TxFinish(link, CANTP_OK);
+}
+
+/**
+ * @brief 打开一条分段传输链路
+ * @param link: 链路
+ * @param can: CAN设备
+ * @param txId: 本端发送ID
+ * @param rxId: 对端发送ID
+ * @param fd: 1表示使用CAN FD + BRS帧
+ * @param rxBuf: 接收缓冲区
+ * @param rxBufSize: 接收缓冲区大小
+ * @param rxCallback: 消息接收完成回调
+ * @retval uint8_t: 0表示成功，1表示失败
+ */
+uint8_t CANTP_Open(CANTP_Link_t *link, CAN_Instance_t *can, uint16_t txId, uint16_t rxId, uint8_t fd,
+                   uint8_t *rxBuf, uint16_t rxBufSize, CANTP_RxCallback rxCallback)
+{
+    uint8_t bus = (can == &can2) ? 1U : 0U;
+
+    if (link == NULL || can == NULL || rxBuf == NULL || rxBufSize == 0U) return 1;
+    if (cantpLinkCnt[bus] >= CANTP_LINK_MAX) return 1;
+
+    memset(link, 0, sizeof(*link));
+    link->can        = can;
+    link->txId       = txId;
+    link->rxId       = rxId;
+    link->fd         = fd ? 1U : 0U;
+    link->blockSize  = CANTP_BLOCK_SIZE;
+    link->stmin      = CANTP_STMIN;
+    link->rxBuf      = rxBuf;
+    link->rxBufSize  = rxBufSize;
+    link->rxCallback = rxCallback;
+
+    if (CAN_Subscribe(can, rxId, CANTP_OnFrame, link) != 0U) return 1;
+
+    cantpLinks[bus][cantpLinkCnt[bus]++] = link;
+    return 0;
+}
+
+/**
+ * @brief 发送一条消息
+ * @param link: 链路
+ * @param data: 数据，发送结束前须保持有效
+ * @param len: 长度
+ * @retval uint8_t: 0表示已开始发送，1表示失败
+ *
+ * 先把状态置为等待流控再发首帧，CAN任务收到流控帧时一定能看到完整的发送会话。
+ */
+uint8_t CANTP_Send(CANTP_Link_t *link, const uint8_t *data, uint16_t len)
+{
+    uint8_t pdu[CAN_FRAME_DATA_MAX];
+    uint8_t frameMax = CANTP_FrameMax(link);
+    /* 单帧PCI：经典帧1字节；FD帧超过7字节时用2字节转义格式 */
+    uint8_t sfMax = link->fd ? frameMax - 2U : 7U;
+
+    if (link->txState != CANTP_IDLE || data == NULL || len == 0U || len > CANTP_MSG_MAX) return 1;
+
+    if (len <= sfMax)
+    {
+        uint8_t hdr = 1U;
+        if (len <= 7U) pdu[0] = CANTP_PCI_SF | (uint8_t)len;
+        else { pdu[0] = CANTP_PCI_SF; pdu[1] = (uint8_t)len; hdr = 2U; }
+        memcpy(&pdu[hdr], data, len);
+        if (CANTP_SendFrame(link, pdu, (uint8_t)(hdr + len)) == 0U) return 1;
+        link->tx_msg_cnt++;
+        if (link->txCallback != NULL) link->txCallback(link, CANTP_OK);
+        return 0;
+    }
+
+    link->txData  = data;
+    link->txLen   = len;
+    link->txPos   = frameMax - 2U;
+    link->txSn    = 1U;
+    link->txTimer = Timebase_Us();
+    link->txWaitCnt = 0U;
+    __DMB();
+    link->txState = CANTP_TX_WAIT_FC;
+
+    pdu[0] = CANTP_PCI_FF | (uint8_t)(len >> 8);
+    pdu[1] = (uint8_t)len;
+    memcpy(&pdu[2], data, link->txPos);
+    if (CANTP_SendFrame(link, pdu, frameMax) == 0U)
+    {
+        link->txState = CANTP_IDLE;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 内部函数：接收分发入口，在CAN任务上下文中调用
+ * @param can: CAN设备
+ * @param frame: 接收到的帧
+ * @param ctx: 链路
+ *
+ * 新的单帧或首帧会中止正在进行的接收会话。数据直接从接收环形缓冲区拷入调用者的缓冲区，不经过中间缓存。
+ */
+static void CANTP_OnFrame(CAN_Instance_t *can, const CAN_RxFrame_t *frame, void *ctx)
+{
+    CANTP_Link_t *link = ctx;
+    const uint8_t *d = frame->data;
+    uint32_t now = Timebase_Us();
+    (void)can;
+
+    if (frame->len == 0U) return;
+
+    switch (d[0] & 0xF0U)
+    {
+        case CANTP_PCI_SF:
+        {
+            uint16_t len = d[0] & 0x0FU;
+            uint8_t hdr = 1U;
+            if (len == 0U && frame->len > 8U) { len = d[1]; hdr = 2U; }
+            if (len == 0U || len + hdr > frame->len) return;
+
+            link->rxState = CANTP_IDLE;
+            if (len > link->rxBufSize) { link->overflow_cnt++; return; }
+            memcpy(link->rxBuf, &d[hdr], len);
+            link->rx_msg_cnt++;
+            if (link->rxCallback != NULL) link->rxCallback(link, link->rxBuf, len);
+            break;
+        }
+
+        case CANTP_PCI_FF:
+        {
+            uint16_t len = (uint16_t)((d[0] & 0x0FU) << 8 | d[1]);
+            if (frame->len < 8U || len <= frame->len - 2U) return;
+
+            link->rxState = CANTP_IDLE;
+            if (len > link->rxBufSize)
+            {
+                link->overflow_cnt++;
+                CANTP_SendFlowControl(link, CANTP_FS_OVFL);
+                return;
+            }
+
+            link->rxLen    = len;
+            link->rxDl     = frame->len;
+            link->rxPos    = frame->len - 2U;
+            link->rxSn     = 1U;
+            link->rxBsLeft = link->blockSize;
+            link->rxTimer  = now;
+            memcpy(link->rxBuf, &d[2], link->rxPos);
+            link->rxState  = CANTP_RX_RECV;
+            CANTP_SendFlowControl(link, CANTP_FS_CTS);
+            break;
+        }
+
+        case CANTP_PCI_CF:
+        {
+            if (link->rxState != CANTP_RX_RECV) return;
+            if ((d[0] & 0x0FU) != (link->rxSn & 0x0FU))
+            {
+                link->seq_err_cnt++;
+                link->rxState = CANTP_IDLE;
+                return;
+            }
+
+            uint16_t n = link->rxLen - link->rxPos;
+            if (n > link->rxDl - 1U) n = link->rxDl - 1U;
+            if (n + 1U > frame->len) { link->rxState = CANTP_IDLE; return; }
+
+            memcpy(&link->rxBuf[link->rxPos], &d[1], n);
+            link->rxPos  += n;
+            link->rxSn++;
+            link->rxTimer = now;
+
+            if (link->rxPos >= link->rxLen)
+            {
+                link->rxState = CANTP_IDLE;
+                link->rx_msg_cnt++;
+                if (link->rxCallback != NULL) link->rxCallback(link, link->rxBuf, link->rxLen);
+            }
+            else if (link->rxBsLeft != 0U && --link->rxBsLeft == 0U)
+            {
+                link->rxBsLeft = link->blockSize;
+                CANTP_SendFlowControl(link, CANTP_FS_CTS);
+            }
+            break;
+        }
+
+        case CANTP_PCI_FC:
+        {
+            if (link->txState != CANTP_TX_WAIT_FC || frame->len < 3U) return;
+
+            uint8_t fs = d[0] & 0x0FU;
+            if (fs == CANTP_FS_CTS)
+            {
+                link->txBsLeft  = d[1];
+                link->txStminUs = CANTP_StminToUs(d[2]);
+                link->txLastUs  = now - link->txStminUs;
+                link->txState   = CANTP_TX_SEND_CF;
+                CANTP_PumpTx(link, now);
+            }
+            else if (fs == CANTP_FS_WAIT)
+            {
+                /* 每个WAIT重新计时，但连续次数受限，对端一直WAIT时不会无限占住发送会话 */
+                if (++link->txWaitCnt > CANTP_WFT_MAX)
+                {
+                    link->timeout_cnt++;
+                    CANTP_TxFinish(link, CANTP_TIMEOUT);
+                }
+                else
+                    link->txTimer = now;
+            }
+            else
+            {
+                link->overflow_cnt++;
+                CANTP_TxFinish(link, CANTP_OVERFLOW);
+            }
+            break;
+        }
+
+        default: break;
+    }
+}
+
+/**
+ * @brief 推进连续帧发送并检查超时
+ * @param can: CAN设备
+ */
+void CANTP_Poll(CAN_Instance_t *can)
+{
+    uint8_t bus = (can == &can2) ? 1U : 0U;
+    uint32_t now = Timebase_Us();
+
+    for (uint8_t i = 0; i < cantpLinkCnt[bus]; i++)
+    {
+        CANTP_Link_t *link = cantpLinks[bus][i];
+
+        if (link->txState == CANTP_TX_SEND_CF)
+        {
+            CANTP_PumpTx(link, now);
+        }
+        else if (link->txState == CANTP_TX_WAIT_FC && now - link->txTimer > CANTP_TIMEOUT_MS * 1000U)
+        {
+            link->timeout_cnt++;
+            CANTP_TxFinish(link, CANTP_TIMEOUT);
+        }
+
+        if (link->rxState == CANTP_RX_RECV && now - link->rxTimer > CANTP_TIMEOUT_MS * 1000U)
+        {
+            link->timeout_cnt++;
+            link->rxState = CANTP_IDLE;
+        }
+    }
+}
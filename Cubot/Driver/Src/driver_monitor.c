@@ -0,0 +1,170 @@
+/**
+ **********************************************************************************
+ * @file        driver_monitor.c
+ * @brief       驱动层，节点心跳与离线检测
+ * @details     电机、裁判系统等节点收到有效数据时调用 Monitor_Beat() 记录心跳，
+ *              一个软件定时器周期检查所有节点的心跳间隔，按 在线 → 降级 → 离线 切换状态并调用回调。
+ *              各任务不再各自维护离线计数，输出前用 Monitor_IsOffline() 判断即可。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * 硬件平台: STM32H750VBT \n
+ * SDK版本：-++++
+ **********************************************************************************
+ ==============================================================================
+                            How to use this driver
+ ==============================================================================
+
+    添加driver_monitor.h
+
+    1. 在设备结构体中嵌入 Monitor_Node_t，初始化时调用 Monitor_Register() 设置降级和离线超时，
+       需要在状态切换时处理（如报警、复位控制器积分）的调用 Monitor_SetCallback()
+
+    2. 收到设备的有效数据时调用 Monitor_Beat()
+
+    3. 初始化任务中调用 Monitor_Init() 启动检查定时器（需要 configUSE_TIMERS）
+
+    4. 控制层用 Monitor_IsOffline() 判断节点状态，rm_motor.c 中离线电机的输出已自动置零
+
+ **********************************************************************************
+ */
+#include "driver_monitor.h"
+
+static Monitor_Node_t *monitorNode[MONITOR_NODE_MAX];
+static uint8_t monitorNodeNum;
+static volatile uint32_t monitorOffline;  // 离线位图，只由定时器回调修改
+static TimerHandle_t monitorTimer;
+
+/**
+ * @brief 内部函数：由心跳间隔判断节点状态
+ * @param node: 节点
+ * @retval MonitorState
+ * @note  两次检查之间没有新的心跳且已离线时保持离线，避免微秒时基回绕后把长期离线的节点误判为在线。
+ *        定时器服务任务优先级低于CAN任务，检查过程中可能被抢占并写入新的心跳，
+ *        因此每个节点先读心跳时刻再读当前时刻，心跳间隔不会因心跳晚于当前时刻而回绕成极大值
+ */
+static uint8_t Monitor_Evaluate(Monitor_Node_t *node)
+{
+    uint32_t beats = node->beat_cnt;
+    uint32_t last  = node->last_beat;
+    uint32_t age   = Timebase_Us() - last;
+
+    if (beats == 0U) return MONITOR_OFFLINE;
+    if (beats == node->seen_cnt && node->state == MONITOR_OFFLINE) return MONITOR_OFFLINE;
+    node->seen_cnt = beats;
+
+    if (age >= node->offline_us)  return MONITOR_OFFLINE;
+    if (age >= node->degraded_us) return MONITOR_DEGRADED;
+    return MONITOR_ONLINE;
+}
+
+/**
+ * @brief 内部函数：检查定时器回调，在定时器服务任务中运行
+ */
+static void Monitor_TimerCallback(TimerHandle_t timer)
+{
+    (void)timer;
+
+    for (uint8_t i = 0; i < monitorNodeNum; i++)
+    {
+        Monitor_Node_t *node = monitorNode[i];
+        uint8_t oldState = node->state;
+        uint8_t newState = Monitor_Evaluate(node);
+
+        if (newState == oldState) continue;
+
+        node->state = newState;
+        if (newState == MONITOR_OFFLINE)
+        {
+            monitorOffline |= (1UL << i);
+            node->offline_cnt++;
+        }
+        else
+        {
+            monitorOffline &= ~(1UL << i);
+        }
+        if (node->callback != NULL) node->callback(node, oldState, node->ctx);
+    }
+}
+
+/**
+ * @brief 创建并启动检查定时器
+ * @retval uint8_t: 0表示成功，1表示定时器创建或启动失败
+ */
+uint8_t Monitor_Init(void)
+{
+    if (monitorTimer == NULL)
+        monitorTimer = xTimerCreate("Monitor", pdMS_TO_TICKS(MONITOR_PERIOD_MS), pdTRUE, NULL, Monitor_TimerCallback);
+    if (monitorTimer == NULL) return 1;
+    return (xTimerStart(monitorTimer, 0) == pdPASS) ? 0 : 1;
+}
+
+/**
+ * @brief 注册节点
+ * @param node: 节点
+ * @param name: 名称
+ * @param degradedMs: 进入降级状态的心跳超时（毫秒）
+ * @param offlineMs: 进入离线状态的心跳超时（毫秒）
+ * @retval uint8_t: 0表示成功，1表示节点已满或参数无效
+ *
+ * 节点先填写完整再加入表中，定时器回调不会看到未初始化的节点。
+ */
+uint8_t Monitor_Register(Monitor_Node_t *node, const char *name, uint32_t degradedMs, uint32_t offlineMs)
+{
+    uint8_t ret = 1;
+
+    if (node == NULL || degradedMs == 0U || offlineMs < degradedMs) return 1;
+
+    taskENTER_CRITICAL();
+    if (monitorNodeNum < MONITOR_NODE_MAX)
+    {
+        node->name        = name;
+        node->degraded_us = degradedMs * 1000U;
+        node->offline_us  = offlineMs * 1000U;
+        node->beat_cnt    = 0;
+        node->seen_cnt    = 0;
+        node->state       = MONITOR_OFFLINE;
+        node->index       = monitorNodeNum;
+        node->offline_cnt = 0;
+        monitorOffline   |= (1UL << monitorNodeNum);
+        monitorNode[monitorNodeNum++] = node;
+        ret = 0;
+    }
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+/**
+ * @brief 设置状态切换回调
+ * @param node: 节点
+ * @param callback: 回调，NULL表示取消
+ * @param ctx: 用户上下文
+ */
+void Monitor_SetCallback(Monitor_Node_t *node, Monitor_StateCallback callback, void *ctx)
+{
+    taskENTER_CRITICAL();
+    node->ctx      = ctx;
+    node->callback = callback;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief 读取离线位图
+ */
+uint32_t Monitor_OfflineMask(void)
+{
+    return monitorOffline;
+}
+
+/**
+ * @brief 按 index 取得节点
+ * @param index: 节点在离线位图中的位置
+ * @retval 节点指针，index 无效时返回NULL
+ */
+Monitor_Node_t *Monitor_GetNode(uint8_t index)
+{
+    return (index < monitorNodeNum) ? monitorNode[index] : NULL;
+}
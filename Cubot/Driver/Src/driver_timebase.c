@@ -0,0 +1,45 @@
+/**
+ **********************************************************************************
+ * @file        driver_timebase.c
+ * @brief       驱动层，系统共享的微秒时基
+ * @details     TIM2 以1MHz自由计数，为CAN报文时间戳、电机采样间隔等提供统一的时间基准；
+ *              同时启动DWT周期计数器，供代码段耗时测量
+ * @date        2024-07-24
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * 硬件平台: STM32H750VBT \n
+ * SDK版本：-++++
+ **********************************************************************************
+ */
+#include "driver_timebase.h"
+
+/**
+ * @brief 初始化微秒时基
+ *
+ * TIM2 挂在APB1上，APB1分频不为1时定时器时钟为PCLK1的2倍。
+ * 定时器只做自由计数，不开中断，因此不占用CubeMX配置，直接操作寄存器。
+ */
+void Timebase_Init(void)
+{
+    uint32_t timClk = HAL_RCC_GetPCLK1Freq();
+
+    if ((RCC->D2CFGR & RCC_D2CFGR_D2PPRE1) != RCC_D2CFGR_D2PPRE1_DIV1) timClk *= 2U;
+
+    __HAL_RCC_TIM2_CLK_ENABLE();
+
+    TIMEBASE_TIM->CR1 = 0;
+    TIMEBASE_TIM->PSC = timClk / 1000000U - 1U;
+    TIMEBASE_TIM->ARR = 0xFFFFFFFFU;
+    TIMEBASE_TIM->CNT = 0;
+    TIMEBASE_TIM->EGR = TIM_EGR_UG; // 立即装载预分频值
+    TIMEBASE_TIM->SR  = 0;
+    TIMEBASE_TIM->CR1 = TIM_CR1_CEN;
+
+    // DWT周期计数：先打开跟踪模块，Cortex-M7还须解锁DWT寄存器写入
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR    = 0xC5ACCE55U;
+    DWT->CYCCNT = 0;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+}
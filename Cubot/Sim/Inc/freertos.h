@@ -0,0 +1,2 @@
+/* 固件以 "freertos.h" 引用内核头文件，主机文件系统区分大小写，这里转到 FreeRTOS.h */
+#include "FreeRTOS.h"
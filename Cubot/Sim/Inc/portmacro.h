@@ -0,0 +1,60 @@
+/**
+ **********************************************************************************
+ * @file        portmacro.h
+ * @brief       仿真层，FreeRTOS 主机移植宏
+ * @details     主机仿真为单线程离散事件模型，中断由仿真总线在调用点同步触发，
+ *              因此临界区和开关中断均为空操作，只保留与 ARM_CM4F 移植一致的类型宽度。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ */
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#include <stdint.h>
+
+#define portCHAR       char
+#define portFLOAT      float
+#define portDOUBLE     double
+#define portLONG       long
+#define portSHORT      short
+#define portSTACK_TYPE uint32_t
+#define portBASE_TYPE  long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if (configUSE_16_BIT_TICKS == 1)
+typedef uint16_t TickType_t;
+#define portMAX_DELAY (TickType_t)0xffff
+#else
+typedef uint32_t TickType_t;
+#define portMAX_DELAY (TickType_t)0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+
+#define portSTACK_GROWTH   (-1)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portBYTE_ALIGNMENT 8
+
+/* 单线程仿真：没有抢占，也没有真正的中断嵌套 */
+#define portYIELD()
+#define portEND_SWITCHING_ISR(xSwitchRequired) (void)(xSwitchRequired)
+#define portYIELD_FROM_ISR(x)                  portEND_SWITCHING_ISR(x)
+
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+#define portENTER_CRITICAL()
+#define portEXIT_CRITICAL()
+#define portSET_INTERRUPT_MASK_FROM_ISR()    0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x) (void)(x)
+
+#define portTASK_FUNCTION_PROTO(vFunction, pvParameters) void vFunction(void *pvParameters)
+#define portTASK_FUNCTION(vFunction, pvParameters)       void vFunction(void *pvParameters)
+
+#define portNOP()
+#define portMEMORY_BARRIER() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,95 @@
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include <stdint.h>
+#include "freertos.h"
+#include "task.h"
+
+#define SIM_BUS_NUM       2U     //< 仿真总线数量，总线0接FDCAN1，总线1接FDCAN2
+#define SIM_FRAME_DATA_MAX 64U
+
+#define SIM_FRAME_FLAG_EXT 0x01U //< 29位扩展ID
+#define SIM_FRAME_FLAG_FD  0x02U //< CAN FD 帧
+#define SIM_FRAME_FLAG_BRS 0x04U //< 数据段切换到数据波特率
+
+/**
+ * @brief 总线上传输的一帧
+ */
+typedef struct
+{
+    uint32_t id;
+    uint8_t flags;
+    uint8_t len;
+    uint8_t data[SIM_FRAME_DATA_MAX];
+} Sim_Frame_t;
+
+typedef struct Sim_Node Sim_Node_t;
+
+/**
+ * @brief 总线节点，FDCAN控制器和仿真设备都以节点身份挂到总线上
+ */
+struct Sim_Node
+{
+    Sim_Node_t *next;
+    uint8_t bus;
+    uint8_t (*PeekTx)(Sim_Node_t *node, Sim_Frame_t *frame);     //< 取出下一帧待发送帧，无帧返回0
+    void (*TxDone)(Sim_Node_t *node, uint8_t won);                //< 仲裁结束，won为0表示仲裁失败
+    void (*Rx)(Sim_Node_t *node, const Sim_Frame_t *frame, uint64_t sofNs); //< 收到其他节点发出的帧
+    void *ctx;
+};
+
+/**
+ * @brief 周期定时器，在仿真时间上触发
+ */
+typedef struct Sim_Timer
+{
+    struct Sim_Timer *next;
+    uint64_t due_ns;
+    uint64_t period_ns;
+    void (*Callback)(void *ctx);
+    void *ctx;
+} Sim_Timer_t;
+
+/**
+ * @brief 总线统计
+ */
+typedef struct
+{
+    uint32_t frame_cnt;    //< 总线上完成传输的帧数
+    uint32_t arb_lost_cnt; //< 仲裁失败次数
+    uint64_t busy_ns;      //< 总线占用时间
+} Sim_BusStats_t;
+
+/* 仿真时钟和事件循环 */
+void Sim_Init(void);
+void Sim_SetRealtime(double scale);
+uint64_t Sim_NowNs(void);
+uint64_t Sim_CpuNs(void);
+void Sim_RunFor(uint64_t durationNs);
+void Sim_TimerStart(Sim_Timer_t *timer, uint64_t firstNs, uint64_t periodNs, void (*callback)(void *), void *ctx);
+void Sim_TimerStop(Sim_Timer_t *timer);
+
+/* 总线 */
+void SimBus_Attach(Sim_Node_t *node, uint8_t bus);
+void SimBus_SetBitTiming(uint8_t bus, uint32_t nominalBitNs, uint32_t dataBitNs);
+uint8_t SimBus_OpenSocketCan(uint8_t bus, const char *ifname);
+uint64_t SimBus_FrameNs(uint8_t bus, const Sim_Frame_t *frame);
+const Sim_BusStats_t *SimBus_GetStats(uint8_t bus);
+uint64_t SimBus_NextEventNs(void);
+uint8_t SimBus_Process(uint64_t nowNs);
+uint8_t SimBus_PollSockets(uint64_t timeoutNs);
+
+/* 任务：每次被通知或等待超时后执行一次 Step，相当于任务主循环的一轮 */
+TaskHandle_t SimTask_Create(void (*step)(void *), void *arg, uint32_t timeoutMs);
+uint64_t SimTask_NextWakeNs(void);
+uint8_t SimTask_RunReady(uint64_t nowNs);
+
+/* FDCAN 控制器仿真 */
+uint8_t SimFdcan_Service(void);
+void SimFdcan_InjectBusOff(uint8_t bus);
+void SimFdcan_SetErrorCounters(uint8_t bus, uint8_t tec, uint8_t rec);
+uint32_t SimFdcan_TxAbortCount(uint8_t bus);
+uint64_t SimFdcan_IsrNs(uint8_t bus);
+void SimFdcan_SetBus(uint8_t ctrl, uint8_t bus);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _SIM_MOTOR_H_
+#define _SIM_MOTOR_H_
+
+#include "sim.h"
+
+#define SIM_MOTOR_FEEDBACK_HZ 1000U //< 反馈帧频率，与大疆电调一致
+
+/**
+ * @brief 仿真大疆电机：接收0x200/0x1FF/0x2FF控制帧，以1kHz发送0x201-0x20B反馈帧
+ *
+ * 转速按一阶惯性响应控制电流，编码器按转速积分，温度随电流平方缓慢上升。
+ */
+typedef struct
+{
+    Sim_Node_t node;
+    Sim_Timer_t timer;
+    uint16_t feedback_id;  //< 反馈帧ID 0x201-0x20B
+    uint16_t command_id;   //< 控制帧ID 0x200/0x1FF/0x2FF
+    uint8_t slot;          //< 在控制帧中的位置（0-3）
+    int16_t command;       //< 最近一次收到的控制值
+    float speed_rpm;       //< 转子转速
+    float position;        //< 转子位置（编码器刻度，0-8192）
+    float temperature;     //< 温度（摄氏度）
+    float max_rpm;         //< 满量程控制值对应的稳态转速
+    float tau_s;           //< 转速响应时间常数（秒）
+    uint8_t pending;       //< 反馈帧等待仲裁
+    Sim_Frame_t feedback;
+    uint32_t command_cnt;  //< 收到的控制帧数
+    uint32_t feedback_cnt; //< 发出的反馈帧数
+    uint32_t overrun_cnt;  //< 上一帧反馈未发出即被新反馈覆盖的次数
+} Sim_Motor_t;
+
+uint8_t SimMotor_Init(Sim_Motor_t *motor, uint8_t bus, uint16_t feedbackId);
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ **********************************************************************************
+ * @file        stm32h7xx_hal_conf.h
+ * @brief       仿真层，HAL 配置头文件包装
+ * @details     先包含 Core/Inc 中的 HAL 配置（随之包含器件头文件），再把驱动直接访问的外设
+ *              重定向到主机内存中的寄存器镜像，固件源码无需任何修改即可在主机上编译运行。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ */
+#ifndef SIM_HAL_CONF_H
+#define SIM_HAL_CONF_H
+
+#include_next "stm32h7xx_hal_conf.h"
+
+/* 寄存器镜像，定义在 sim_fdcan.c 中 */
+extern FDCAN_GlobalTypeDef simFdcanReg[2];
+extern FDCAN_ClockCalibrationUnit_TypeDef simFdcanCcuReg;
+extern TIM_TypeDef simTim2Reg;
+extern RCC_TypeDef simRccReg;
+extern DWT_Type simDwtReg;
+extern CoreDebug_Type simCoreDebugReg;
+
+#undef FDCAN1
+#undef FDCAN2
+#undef FDCAN_CCU
+#undef TIM2
+#undef RCC
+#undef DWT
+#undef CoreDebug
+#define FDCAN1    (&simFdcanReg[0])
+#define FDCAN2    (&simFdcanReg[1])
+#define FDCAN_CCU (&simFdcanCcuReg)
+#define TIM2      (&simTim2Reg)
+#define RCC       (&simRccReg)
+#define DWT       (&simDwtReg)       //< 周期计数在仿真中不走，主机上的耗时用基准程序自己的时钟测量
+#define CoreDebug (&simCoreDebugReg)
+
+/* cmsis_gcc.h 中的内存屏障是 ARM 汇编，单线程仿真只需阻止编译器重排 */
+#define __DMB() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#define __DSB() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#define __ISB() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+#endif /* SIM_HAL_CONF_H */
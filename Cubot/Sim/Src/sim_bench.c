@@ -0,0 +1,280 @@
+/**
+ **********************************************************************************
+ * @file        sim_bench.c
+ * @brief       仿真层，CAN驱动与电机驱动的主机端基准程序
+ * @details     在Linux上运行固件中未修改的 driver_can.c、driver_can_tp.c、rm_motor.c 和 pid.c：
+ *              CAN1 上挂若干仿真大疆电机（0x201起），控制定时器以1kHz对每个电机做速度环并发出
+ *              0x200/0x1FF/0x2FF 控制帧，CAN任务按 can_task.c 的循环体消费接收环形缓冲区。
+ *              -s 时改由 motor_cycle.c 在反馈到齐后唤醒控制任务，与 Control_Task 一致。
+ *              运行结束后输出每帧接收/发送路径的CPU耗时、总线负载以及驱动的各项统计，
+ *              每个电机另输出最后一个统计窗口的帧率、最大间隔、控制到反馈延迟和抖动直方图（MotorGetStats()）。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * How to use：
+ * 1. cmake -S Cubot/Sim -B build-sim && cmake --build build-sim
+ * 2. ./build-sim/cubot_sim [-t 秒] [-n 电机数] [-s] [-d 反馈ID] [-i vcan0] [-w 记录文件]
+ *    -t 仿真时长（仿真时间），默认5秒
+ *    -n CAN1上的电机数（1-11），默认4。1Mbps下每毫秒约能传8帧经典帧，超过6个电机时总线过载
+ *    -s 控制周期由电机反馈触发（MotorCycle），否则按1kHz定时器运行，两者可对比反馈到发出控制帧的延迟
+ *    -d 该ID的电机只注册不仿真，模拟电机掉线
+ *    -i 把CAN1桥接到SocketCAN接口，此时仿真按墙上时间运行，可用 candump 观察或接入真实电调
+ *       （sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0）
+ *    -w 打开CAN记录器，结束时按 CanRecTask_Process() 的导出格式写入文件，可交给 cubot_replay 回放
+ * 3. 某个电机在仿真时长内没有收到任何反馈时返回非零值
+ **********************************************************************************
+ */
+#include "sim.h"
+#include "sim_motor.h"
+#include "driver_can.h"
+#include "driver_can_tp.h"
+#include "driver_can_rec.h"
+#include "driver_timebase.h"
+#include "driver_monitor.h"
+#include "rm_motor.h"
+#include "motor_cycle.h"
+#include "pid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BENCH_MOTOR_MAX   11U
+#define BENCH_CTRL_HZ     1000U
+
+static Sim_Motor_t simMotor[BENCH_MOTOR_MAX];
+static Motor_t motor[BENCH_MOTOR_MAX];
+static SinglePID_t speedPid[BENCH_MOTOR_MAX];
+static uint8_t motorNum = 4;
+
+static Sim_Timer_t ctrlTimer;
+static uint32_t ctrlCnt;
+static uint64_t taskNs;   //< CAN任务循环体累计耗时
+static uint64_t ctrlNs;   //< 速度环与填充发送缓冲区累计耗时
+static uint64_t outputNs; //< MotorFlush() 累计耗时
+static uint32_t outputCnt;
+static uint64_t actuateUsSum; //< 反馈到控制帧入队的延迟累计
+
+static const CAN_FilterConfig_t benchFilter[] = {
+    {FDCAN_FILTER_RANGE, 0x201, 0x20B, FDCAN_FILTER_TO_RXFIFO0},
+};
+
+/**
+ * @brief 冻结CAN记录器并按 CanRecTask_Process() 的格式导出到文件
+ * @retval 0表示成功
+ */
+static uint8_t Bench_DumpRecorder(const char *path)
+{
+    static CAN_RecEntry_t chunk[256];
+    CAN_RecReader_t reader;
+    CAN_RecHeader_t header = {
+        .magic      = CAN_REC_MAGIC,
+        .version    = CAN_REC_VERSION,
+        .entry_size = sizeof(CAN_RecEntry_t),
+    };
+    uint32_t n;
+    FILE *f = fopen(path, "wb");
+
+    if (f == NULL) return 1;
+    CAN_RecTrigger(0);
+    header.entry_num = CAN_RecReaderInit(&reader);
+    fwrite(&header, sizeof(header), 1, f);
+    while ((n = CAN_RecRead(&reader, chunk, 256)) > 0U)
+        fwrite(chunk, sizeof(CAN_RecEntry_t), n, f);
+    fclose(f);
+    printf("recorder: %u entries written to %s\n", header.entry_num, path);
+    return 0;
+}
+
+/**
+ * @brief CAN任务循环体，与 can_task.c 中 CanTask_Process() 的 while(1) 一致，
+ *        ulTaskNotifyTake() 的等待由 SimTask 的通知/超时调度代替
+ */
+static void Bench_CanTaskStep(void *arg)
+{
+    CAN_Instance_t *can = arg;
+    const CAN_RxFrame_t *frame;
+    uint64_t start = Sim_CpuNs();
+
+    while ((frame = CAN_RxPeek(can)) != NULL)
+    {
+        CAN_Dispatch(can, frame);
+        CAN_RxRelease(can, frame);
+    }
+    CANTP_Poll(can);
+    CAN_HealthPoll(can);
+
+    taskNs += Sim_CpuNs() - start;
+}
+
+/**
+ * @brief 1kHz控制周期：按方波切换的目标转速做速度环，填充并发出控制帧
+ */
+static void Bench_Control(void *ctx)
+{
+    (void)ctx;
+    uint64_t start = Sim_CpuNs();
+    float target = (ctrlCnt / 500U % 2U) ? 3000.0f : -1500.0f;
+
+    for (uint8_t i = 0; i < motorNum; i++)
+    {
+        float out = One_Pid_Ctrl(target * (1.0f + 0.1f * i), motor[i].rawData.speed_rpm, &speedPid[i]);
+        MotorFillData(&motor[i], (int32_t)out);
+    }
+    uint64_t mid = Sim_CpuNs();
+
+    outputCnt += MotorFlush(&can1);
+    MotorCycle_Actuated();
+    actuateUsSum += MotorCycle_Get()->actuate_latency_us;
+
+    uint64_t end = Sim_CpuNs();
+    ctrlNs   += mid - start;
+    outputNs += end - mid;
+    ctrlCnt++;
+}
+
+/**
+ * @brief 反馈触发的控制任务循环体，与 control_task.c 一致，MotorCycle_Wait() 的等待由 SimTask 代替
+ */
+static void Bench_ControlStep(void *arg)
+{
+    Bench_Control(arg);
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 5.0;
+    const char *ifname = NULL;
+    const char *recPath = NULL;
+    uint8_t syncCycle = 0;
+    uint16_t deadId = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:sd:i:w:")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': seconds = atof(optarg); break;
+            case 'n': motorNum = (uint8_t)atoi(optarg); break;
+            case 's': syncCycle = 1; break;
+            case 'd': deadId = (uint16_t)strtoul(optarg, NULL, 0); break;
+            case 'i': ifname = optarg; break;
+            case 'w': recPath = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-t seconds] [-n motors] [-s] [-d id] [-i ifname] [-w capture]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (motorNum < 1U || motorNum > BENCH_MOTOR_MAX || seconds <= 0.0)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    Sim_Init();
+    Timebase_Init();
+    Monitor_Init();
+    CAN_RecInit();
+    if (recPath != NULL) CAN_RecStart();
+    MX_FDCAN1_Init();
+    MX_FDCAN2_Init();
+    CANx_Init(&hfdcan1, CAN1_rxCallBack);
+    CANx_Init(&hfdcan2, CAN2_rxCallBack);
+    if (CAN_Open(&can1, benchFilter, 1) || CAN_Open(&can2, benchFilter, 1))
+    {
+        fprintf(stderr, "CAN_Open failed\n");
+        return 1;
+    }
+    can1.rxTask = SimTask_Create(Bench_CanTaskStep, &can1, CAN_HEALTH_POLL_MS);
+    can2.rxTask = SimTask_Create(Bench_CanTaskStep, &can2, CAN_HEALTH_POLL_MS);
+
+    if (ifname != NULL)
+    {
+        if (SimBus_OpenSocketCan(0, ifname))
+        {
+            fprintf(stderr, "cannot open SocketCAN interface %s\n", ifname);
+            return 1;
+        }
+        Sim_SetRealtime(1);
+    }
+
+    Motor_DriverInit();
+    for (uint8_t i = 0; i < motorNum; i++)
+    {
+        uint16_t id = (uint16_t)(0x201U + i);
+        MotorInit(&motor[i], 0, i < 4U ? Motor3508 : Motor6020, 19, CAN1, id);
+        BasePID_Init(&speedPid[i], 8.0f, 0.5f, 0.0f, 16000, 8000, 0, 0, 0, 16000);
+        if (ifname == NULL && id != deadId) SimMotor_Init(&simMotor[i], 0, id);
+    }
+
+    if (syncCycle) MotorCycle_Subscribe(SimTask_Create(Bench_ControlStep, NULL, MOTOR_CYCLE_TIMEOUT_MS));
+    else           Sim_TimerStart(&ctrlTimer, 500000ULL, 1000000000ULL / BENCH_CTRL_HZ, Bench_Control, NULL);
+
+    uint64_t wallStart = Sim_CpuNs();
+    Sim_RunFor((uint64_t)(seconds * 1e9));
+    uint64_t wallNs = Sim_CpuNs() - wallStart;
+
+    if (recPath != NULL && Bench_DumpRecorder(recPath))
+    {
+        fprintf(stderr, "cannot write %s\n", recPath);
+        return 1;
+    }
+
+    /* 统计 */
+    const Sim_BusStats_t *bus = SimBus_GetStats(0);
+    uint32_t rxFrames = can1.rxRing[0].frame_cnt + can1.rxRing[1].frame_cnt;
+    uint64_t isrNs    = SimFdcan_IsrNs(0);
+    int missing       = 0;
+
+    printf("sim %.3f s in %.3f s wall, %u control cycles\n", seconds, wallNs / 1e9, ctrlCnt);
+    printf("bus: %u frames, %u arbitration losses, load %.1f%%\n",
+           bus->frame_cnt, bus->arb_lost_cnt, bus->busy_ns * 100.0 / (seconds * 1e9));
+    printf("rx: %u frames, %.0f ns/frame (isr %.0f + task %.0f), ring drop %u/%u, fifo lost %u, unhandled %u\n",
+           rxFrames, rxFrames ? (double)(isrNs + taskNs) / rxFrames : 0.0,
+           rxFrames ? (double)isrNs / rxFrames : 0.0, rxFrames ? (double)taskNs / rxFrames : 0.0,
+           can1.rxRing[0].drop_cnt, can1.rxRing[1].drop_cnt, can1.health.rx_lost_cnt[0], can1.rx_unhandled_cnt);
+    printf("tx: %u frames, %.0f ns/frame enqueue, %.0f ns/cycle control, late %u, replaced %u, overflow %u, "
+           "aborted %u, queue peak %u\n",
+           can1.txQueue.sent_cnt, outputCnt ? (double)outputNs / outputCnt : 0.0,
+           ctrlCnt ? (double)ctrlNs / ctrlCnt : 0.0, can1.txQueue.late_cnt, can1.txQueue.replace_cnt,
+           can1.txQueue.overflow_cnt, SimFdcan_TxAbortCount(0), can1.txQueue.depth_max);
+    static const uint16_t groupId[] = {0x200, 0x1FF, 0x2FF};
+    for (uint8_t i = 0; i < sizeof(groupId) / sizeof(groupId[0]); i++)
+    {
+        const MotorTxGroup_t *group = MotorTxGroupGet(CAN1, groupId[i]);
+        if (group->motor_mask == 0U) continue;
+        printf("motor tx 0x%03X: sent %u, skipped %u, failed %u\n", groupId[i], group->sent_cnt, group->skip_cnt,
+               group->fail_cnt);
+    }
+    const MotorCycle_t *cycle = MotorCycle_Get();
+    printf("cycle: %s, %u complete, %u partial (missing 0x%X), feedback->tx latency avg %.0f us max %u us\n",
+           syncCycle ? "feedback-triggered" : "fixed 1 kHz", cycle->cycle_cnt - cycle->partial_cnt,
+           cycle->partial_cnt, cycle->missing, ctrlCnt ? (double)actuateUsSum / ctrlCnt : 0.0,
+           cycle->actuate_latency_max);
+    printf("health: state %u, tec %u, rec %u, busoff %u\n",
+           can1.health.state, can1.health.tec, can1.health.rec, can1.health.busoff_cnt);
+
+    for (uint8_t i = 0; i < motorNum; i++)
+    {
+        static const char *const stateName[] = {"online", "degraded", "offline"};
+        printf("motor 0x%03X: %s, speed %6d rpm, latency max %u us", motor[i].param.can_id,
+               stateName[motor[i].monitor.state], motor[i].rawData.speed_rpm, motor[i].treatedData.rx_latency_max);
+        if (ifname == NULL)
+            printf(", %6.0f fb/s, %u commands, %u overruns",
+                   simMotor[i].feedback_cnt / seconds, simMotor[i].command_cnt, simMotor[i].overrun_cnt);
+        printf("\n");
+
+        MotorStatsReport_t stats;
+        MotorGetStats(&motor[i], &stats);
+        printf("  stats: %u fps, period %u us, gap max %u us, cmd->fb avg %u us max %u us, jitter",
+               stats.fps, stats.period_us, stats.gap_max_us, stats.cmd_latency_avg_us, stats.cmd_latency_max_us);
+        for (uint8_t b = 0; b < MOTOR_JITTER_BIN_NUM; b++) printf(" %u", stats.jitter_hist[b]);
+        printf("\n");
+        if (motor[i].param.can_id != deadId && motor[i].treatedData.rx_timestamp == 0U
+            && motor[i].rawData.speed_rpm == 0)
+            missing = 1;
+    }
+
+    return missing;
+}
@@ -0,0 +1,415 @@
+/**
+ **********************************************************************************
+ * @file        sim_bus.c
+ * @brief       仿真层，虚拟CAN总线
+ * @details     总线空闲时在所有有待发帧的节点间按ID仲裁，胜出帧按位时间占用总线，
+ *              传输结束时发给其余节点并通知发送方。经典帧按实际数据计算填充位，FD帧按平均填充估算。
+ *              可选把总线桥接到 Linux SocketCAN 接口（如 vcan0），本地发出的帧写入套接字，
+ *              从套接字收到的帧立即投递给全部本地节点。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ */
+#define _GNU_SOURCE //< ppoll()
+#include "sim.h"
+#include <string.h>
+#include <time.h>
+
+#ifdef SIM_SOCKETCAN
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#define SIM_BUS_NODE_MAX 32U
+#define SIM_SOCK_RX_SIZE 64U //< 2的幂
+
+typedef struct
+{
+    Sim_Node_t *nodes;
+    uint32_t nominal_bit_ns;
+    uint32_t data_bit_ns;
+    uint8_t busy;
+    uint64_t sof_ns;
+    uint64_t eof_ns;
+    Sim_Node_t *winner;
+    Sim_Frame_t frame;
+    Sim_BusStats_t stats;
+    int sock;
+    uint32_t sock_head;
+    uint32_t sock_tail;
+    Sim_Frame_t sock_rx[SIM_SOCK_RX_SIZE];
+} Sim_Bus_t;
+
+static Sim_Bus_t simBus[SIM_BUS_NUM] = {
+    {.nominal_bit_ns = 1000, .data_bit_ns = 200, .sock = -1},
+    {.nominal_bit_ns = 1000, .data_bit_ns = 200, .sock = -1},
+};
+
+/**
+ * @brief 把节点挂到总线上
+ */
+void SimBus_Attach(Sim_Node_t *node, uint8_t bus)
+{
+    node->bus  = bus;
+    node->next = simBus[bus].nodes;
+    simBus[bus].nodes = node;
+}
+
+/**
+ * @brief 设置总线位时间，由FDCAN仿真在 HAL_FDCAN_Init() 中按控制器的位时序设置
+ */
+void SimBus_SetBitTiming(uint8_t bus, uint32_t nominalBitNs, uint32_t dataBitNs)
+{
+    simBus[bus].nominal_bit_ns = nominalBitNs;
+    simBus[bus].data_bit_ns    = dataBitNs;
+}
+
+const Sim_BusStats_t *SimBus_GetStats(uint8_t bus)
+{
+    return &simBus[bus].stats;
+}
+
+/**
+ * @brief 内部函数：位流写入器，按CAN规则统计填充位并计算CRC-15
+ */
+typedef struct
+{
+    uint32_t bits;
+    uint32_t stuff;
+    uint8_t last;
+    uint8_t run;
+    uint16_t crc;
+} Sim_BitWriter_t;
+
+static void SimBus_PutBits(Sim_BitWriter_t *w, uint32_t value, uint8_t n, uint8_t crc)
+{
+    while (n--)
+    {
+        uint8_t bit = (value >> n) & 1U;
+
+        if (crc)
+        {
+            uint8_t next = bit ^ ((w->crc >> 14) & 1U);
+            w->crc = (uint16_t)((w->crc << 1) & 0x7FFFU);
+            if (next) w->crc ^= 0x4599U;
+        }
+
+        w->bits++;
+        if (w->bits > 1U && bit == w->last) w->run++;
+        else                                 w->run = 1;
+        w->last = bit;
+
+        /* 连续5个相同位后插入一个相反的填充位，填充位参与后续计数 */
+        if (w->run == 5U)
+        {
+            w->stuff++;
+            w->last = !bit;
+            w->run  = 1;
+        }
+    }
+}
+
+/**
+ * @brief 计算一帧在总线上的传输时间（含3位帧间隔）
+ * @param bus: 总线编号
+ * @param frame: 帧
+ * @retval 纳秒
+ */
+uint64_t SimBus_FrameNs(uint8_t bus, const Sim_Frame_t *frame)
+{
+    const Sim_Bus_t *b = &simBus[bus];
+    uint8_t ext = (frame->flags & SIM_FRAME_FLAG_EXT) != 0U;
+
+    if ((frame->flags & SIM_FRAME_FLAG_FD) == 0U)
+    {
+        Sim_BitWriter_t w = {0};
+        uint8_t len = frame->len > 8U ? 8U : frame->len;
+
+        SimBus_PutBits(&w, 0, 1, 1); // SOF
+        if (ext)
+        {
+            SimBus_PutBits(&w, frame->id >> 18, 11, 1);
+            SimBus_PutBits(&w, 0x3U, 2, 1); // SRR, IDE
+            SimBus_PutBits(&w, frame->id & 0x3FFFFU, 18, 1);
+            SimBus_PutBits(&w, 0, 3, 1);    // RTR, r1, r0
+        }
+        else
+        {
+            SimBus_PutBits(&w, frame->id, 11, 1);
+            SimBus_PutBits(&w, 0, 3, 1);    // RTR, IDE, r0
+        }
+        SimBus_PutBits(&w, len, 4, 1);
+        for (uint8_t i = 0; i < len; i++) SimBus_PutBits(&w, frame->data[i], 8, 1);
+        SimBus_PutBits(&w, w.crc, 15, 0);
+
+        /* CRC界定符、应答、帧尾、帧间隔不填充 */
+        return (uint64_t)(w.bits + w.stuff + 1U + 2U + 7U + 3U) * b->nominal_bit_ns;
+    }
+
+    /* FD帧：仲裁段至BRS位与应答、帧尾按标称速率，ESI至CRC界定符在BRS时按数据速率 */
+    uint32_t arb  = ext ? 36U : 17U;
+    uint32_t crcLen = (frame->len > 16U) ? 21U : 17U;
+    uint32_t data = 1U + 4U + 8U * frame->len;
+    uint32_t bitNs = (frame->flags & SIM_FRAME_FLAG_BRS) ? b->data_bit_ns : b->nominal_bit_ns;
+
+    arb  += arb / 5U;
+    data += data / 5U + 4U + 1U + crcLen + (crcLen + 3U) / 4U + 1U; // 填充计数、奇偶、CRC及固定填充位、界定符
+    return (uint64_t)(arb + 2U + 7U + 3U) * b->nominal_bit_ns + (uint64_t)data * bitNs;
+}
+
+/**
+ * @brief 内部函数：仲裁优先级，数值越小越优先；同基本ID时标准帧优先于扩展帧
+ */
+static uint32_t SimBus_ArbKey(const Sim_Frame_t *frame)
+{
+    if (frame->flags & SIM_FRAME_FLAG_EXT)
+        return ((frame->id >> 18) << 19) | (1UL << 18) | (frame->id & 0x3FFFFU);
+    return (frame->id & 0x7FFU) << 19;
+}
+
+#ifdef SIM_SOCKETCAN
+static void SimBus_SocketWrite(Sim_Bus_t *b, const Sim_Frame_t *frame)
+{
+    if (frame->flags & SIM_FRAME_FLAG_FD)
+    {
+        struct canfd_frame fd = {0};
+        fd.can_id = frame->id | ((frame->flags & SIM_FRAME_FLAG_EXT) ? CAN_EFF_FLAG : 0U);
+        fd.len    = frame->len;
+        fd.flags  = (frame->flags & SIM_FRAME_FLAG_BRS) ? CANFD_BRS : 0U;
+        memcpy(fd.data, frame->data, frame->len);
+        (void)write(b->sock, &fd, CANFD_MTU);
+    }
+    else
+    {
+        struct can_frame cf = {0};
+        cf.can_id  = frame->id | ((frame->flags & SIM_FRAME_FLAG_EXT) ? CAN_EFF_FLAG : 0U);
+        cf.can_dlc = frame->len;
+        memcpy(cf.data, frame->data, frame->len);
+        (void)write(b->sock, &cf, CAN_MTU);
+    }
+}
+#endif
+
+/**
+ * @brief 内部函数：结束当前帧的传输，通知发送方并投递给其余节点
+ */
+static void SimBus_Complete(Sim_Bus_t *b)
+{
+    Sim_Node_t *winner = b->winner;
+
+    b->busy = 0;
+    b->winner = NULL;
+    b->stats.frame_cnt++;
+    b->stats.busy_ns += b->eof_ns - b->sof_ns;
+
+    winner->TxDone(winner, 1);
+    for (Sim_Node_t *node = b->nodes; node != NULL; node = node->next)
+    {
+        if (node != winner && node->Rx != NULL) node->Rx(node, &b->frame, b->sof_ns);
+    }
+
+#ifdef SIM_SOCKETCAN
+    if (b->sock >= 0) SimBus_SocketWrite(b, &b->frame);
+#endif
+}
+
+/**
+ * @brief 内部函数：总线空闲时在有待发帧的节点间仲裁
+ */
+static uint8_t SimBus_Arbitrate(Sim_Bus_t *b, uint8_t bus, uint64_t nowNs)
+{
+    Sim_Node_t *contender[SIM_BUS_NODE_MAX];
+    uint8_t num = 0;
+    Sim_Frame_t frame;
+    uint32_t bestKey = UINT32_MAX;
+
+    for (Sim_Node_t *node = b->nodes; node != NULL && num < SIM_BUS_NODE_MAX; node = node->next)
+    {
+        if (node->PeekTx == NULL || !node->PeekTx(node, &frame)) continue;
+
+        contender[num++] = node;
+        uint32_t key = SimBus_ArbKey(&frame);
+        if (key < bestKey)
+        {
+            bestKey   = key;
+            b->winner = node;
+            b->frame  = frame;
+        }
+    }
+    if (num == 0U) return 0;
+
+    b->busy   = 1;
+    b->sof_ns = nowNs;
+    b->eof_ns = nowNs + SimBus_FrameNs(bus, &b->frame);
+
+    for (uint8_t i = 0; i < num; i++)
+    {
+        if (contender[i] == b->winner) continue;
+        b->stats.arb_lost_cnt++;
+        contender[i]->TxDone(contender[i], 0);
+    }
+    return 1;
+}
+
+/**
+ * @brief 处理当前时刻的总线事件
+ * @retval 1表示有事件被处理
+ */
+uint8_t SimBus_Process(uint64_t nowNs)
+{
+    uint8_t progressed = 0;
+
+    for (uint8_t i = 0; i < SIM_BUS_NUM; i++)
+    {
+        Sim_Bus_t *b = &simBus[i];
+
+        /* 从 SocketCAN 收到的帧 */
+        while (b->sock_tail != b->sock_head)
+        {
+            const Sim_Frame_t *frame = &b->sock_rx[b->sock_tail & (SIM_SOCK_RX_SIZE - 1U)];
+            for (Sim_Node_t *node = b->nodes; node != NULL; node = node->next)
+            {
+                if (node->Rx != NULL) node->Rx(node, frame, nowNs);
+            }
+            b->sock_tail++;
+            progressed = 1;
+        }
+
+        if (b->busy && b->eof_ns <= nowNs)
+        {
+            SimBus_Complete(b);
+            progressed = 1;
+        }
+        if (!b->busy && SimBus_Arbitrate(b, i, nowNs)) progressed = 1;
+    }
+    return progressed;
+}
+
+/**
+ * @brief 下一个总线事件的时刻
+ */
+uint64_t SimBus_NextEventNs(void)
+{
+    uint64_t next = UINT64_MAX;
+
+    for (uint8_t i = 0; i < SIM_BUS_NUM; i++)
+    {
+        if (simBus[i].sock_tail != simBus[i].sock_head) return Sim_NowNs();
+        if (simBus[i].busy && simBus[i].eof_ns < next) next = simBus[i].eof_ns;
+    }
+    return next;
+}
+
+#ifdef SIM_SOCKETCAN
+/**
+ * @brief 把总线桥接到 SocketCAN 接口
+ * @param bus: 总线编号
+ * @param ifname: 接口名，如 "vcan0"
+ * @retval 0表示成功，1表示失败
+ */
+uint8_t SimBus_OpenSocketCan(uint8_t bus, const char *ifname)
+{
+    struct ifreq ifr;
+    struct sockaddr_can addr;
+    int enable = 1;
+    int s;
+
+    if (bus >= SIM_BUS_NUM) return 1;
+
+    s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (s < 0) return 1;
+
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+    if (ioctl(s, SIOCGIFINDEX, &ifr) < 0) { close(s); return 1; }
+
+    /* 接口MTU不支持FD时设置失败，仍可收发经典帧 */
+    (void)setsockopt(s, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family  = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) < 0) { close(s); return 1; }
+
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL) | O_NONBLOCK);
+    simBus[bus].sock = s;
+    return 0;
+}
+
+/**
+ * @brief 等待并读取 SocketCAN 接口上的帧，读到的帧在下一次 SimBus_Process() 中投递
+ * @param timeoutNs: 最长等待时间
+ * @retval 读到的帧数（超过255按255计）
+ */
+uint8_t SimBus_PollSockets(uint64_t timeoutNs)
+{
+    struct pollfd pfd[SIM_BUS_NUM];
+    uint8_t map[SIM_BUS_NUM];
+    nfds_t n = 0;
+    uint32_t got = 0;
+
+    for (uint8_t i = 0; i < SIM_BUS_NUM; i++)
+    {
+        if (simBus[i].sock < 0) continue;
+        pfd[n].fd     = simBus[i].sock;
+        pfd[n].events = POLLIN;
+        map[n++]      = i;
+    }
+    struct timespec ts = {(time_t)(timeoutNs / 1000000000ULL), (long)(timeoutNs % 1000000000ULL)};
+    if (n == 0U)
+    {
+        nanosleep(&ts, NULL);
+        return 0;
+    }
+    if (ppoll(pfd, n, &ts, NULL) <= 0) return 0;
+
+    for (nfds_t k = 0; k < n; k++)
+    {
+        Sim_Bus_t *b = &simBus[map[k]];
+        struct canfd_frame fd;
+        ssize_t nbytes;
+
+        if ((pfd[k].revents & POLLIN) == 0) continue;
+        while ((nbytes = read(b->sock, &fd, sizeof(fd))) > 0)
+        {
+            if (b->sock_head - b->sock_tail >= SIM_SOCK_RX_SIZE) continue;
+            if (fd.can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) continue;
+
+            Sim_Frame_t *frame = &b->sock_rx[b->sock_head & (SIM_SOCK_RX_SIZE - 1U)];
+            frame->flags = (fd.can_id & CAN_EFF_FLAG) ? SIM_FRAME_FLAG_EXT : 0U;
+            frame->id    = fd.can_id & ((fd.can_id & CAN_EFF_FLAG) ? CAN_EFF_MASK : CAN_SFF_MASK);
+            frame->len   = fd.len > SIM_FRAME_DATA_MAX ? SIM_FRAME_DATA_MAX : fd.len;
+            if (nbytes == CANFD_MTU)
+            {
+                frame->flags |= SIM_FRAME_FLAG_FD;
+                if (fd.flags & CANFD_BRS) frame->flags |= SIM_FRAME_FLAG_BRS;
+            }
+            memcpy(frame->data, fd.data, frame->len);
+            b->sock_head++;
+            got++;
+        }
+    }
+    return (uint8_t)(got > 255U ? 255U : got);
+}
+#else
+uint8_t SimBus_OpenSocketCan(uint8_t bus, const char *ifname)
+{
+    (void)bus;
+    (void)ifname;
+    return 1;
+}
+
+uint8_t SimBus_PollSockets(uint64_t timeoutNs)
+{
+    struct timespec ts = {(time_t)(timeoutNs / 1000000000ULL), (long)(timeoutNs % 1000000000ULL)};
+    nanosleep(&ts, NULL);
+    return 0;
+}
+#endif
@@ -0,0 +1,258 @@
+/**
+ **********************************************************************************
+ * @file        sim_cantp.c
+ * @brief       仿真层，分段传输回环吞吐基准
+ * @details     FDCAN1 与 FDCAN2 挂到同一条仿真总线上，两端各打开一条经典帧链路和一条FD链路，
+ *              每端按 txCallback 连续发送若干条消息（默认50条×1000字节），接收端逐字节校验。
+ *              依次运行经典帧单向、经典帧双向、FD单向、FD双向四种情况，输出每个方向送达的消息数、
+ *              有效吞吐量、序号错误/超时/溢出次数，以及软件发送队列的覆盖次数和总线仲裁失败次数。
+ *              双向时接收会话的流控帧与发送会话的连续帧共用同一发送ID，用于检查两者在发送队列中互不覆盖。
+ *              固件默认关闭自动重发，两端同时发送时仲裁失败的帧会被丢弃，基准中两个控制器都打开自动重发。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * How to use：
+ * 1. ./build-sim/cubot_cantp [-m 每端消息数] [-l 消息字节数]
+ * 2. 任一情况下有消息未送达、校验失败或发送结束回调报告错误时返回非零值
+ **********************************************************************************
+ */
+#include "sim.h"
+#include "driver_can.h"
+#include "driver_can_tp.h"
+#include "driver_can_rec.h"
+#include "driver_timebase.h"
+#include "driver_monitor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BENCH_SIDE_NUM    2U
+#define BENCH_TIMEOUT_NS  20000000000ULL //< 每种情况的仿真时长上限
+#define BENCH_STEP_NS     1000000ULL
+
+/**
+ * @brief 回环的一端：一条链路及其收发统计
+ */
+typedef struct
+{
+    CANTP_Link_t link;
+    uint8_t rxBuf[CANTP_MSG_MAX];
+    uint8_t txBuf[CANTP_MSG_MAX];
+    uint8_t side;
+    uint32_t tx_target;  //< 本情况要发送的消息数
+    uint32_t tx_started; //< 已开始发送的消息数
+    uint32_t tx_done;    //< 发送结束回调报告成功的消息数
+    uint32_t tx_err;     //< 发送结束回调报告失败的次数
+    uint32_t rx_ok;      //< 校验通过的消息数
+    uint32_t rx_bad;     //< 长度或内容不符的消息数
+    uint64_t rx_last_ns; //< 最后一条消息接收完成的仿真时刻
+} Bench_Side_t;
+
+static Bench_Side_t classicSide[BENCH_SIDE_NUM], fdSide[BENCH_SIDE_NUM];
+static uint16_t msgLen = 1000;
+
+/* 经典帧走FIFO0，FD帧走FIFO1 */
+static const CAN_FilterConfig_t benchFilter[] = {
+    {FDCAN_FILTER_RANGE, 0x700, 0x701, FDCAN_FILTER_TO_RXFIFO0},
+    {FDCAN_FILTER_RANGE, 0x710, 0x711, FDCAN_FILTER_TO_RXFIFO1},
+};
+
+/**
+ * @brief 第 side 端第 msg 条消息的第 pos 个字节
+ */
+static uint8_t Bench_Byte(uint8_t side, uint32_t msg, uint16_t pos)
+{
+    return (uint8_t)(pos * 7U + msg * 13U + side * 101U + (pos >> 8));
+}
+
+/**
+ * @brief 填写并开始发送本端的下一条消息
+ */
+static void Bench_SendNext(Bench_Side_t *s)
+{
+    if (s->tx_started >= s->tx_target) return;
+    for (uint16_t i = 0; i < msgLen; i++) s->txBuf[i] = Bench_Byte(s->side, s->tx_started, i);
+    if (CANTP_Send(&s->link, s->txBuf, msgLen) == 0U) s->tx_started++;
+    else                                              s->tx_err++;
+}
+
+static void Bench_TxDone(CANTP_Link_t *link, uint8_t result)
+{
+    Bench_Side_t *s = link->ctx;
+
+    if (result == CANTP_OK) s->tx_done++;
+    else                    s->tx_err++;
+    Bench_SendNext(s);
+}
+
+static void Bench_RxDone(CANTP_Link_t *link, uint8_t *data, uint16_t len)
+{
+    Bench_Side_t *s  = link->ctx;
+    uint8_t peer     = s->side ^ 1U;
+    uint32_t msg     = s->rx_ok + s->rx_bad;
+    uint8_t ok       = (len == msgLen);
+
+    for (uint16_t i = 0; ok && i < len; i++) ok = (data[i] == Bench_Byte(peer, msg, i));
+    if (ok) s->rx_ok++;
+    else    s->rx_bad++;
+    s->rx_last_ns = Sim_NowNs();
+}
+
+/**
+ * @brief CAN任务循环体，与 can_task.c 中 CanTask_Process() 的 while(1) 一致
+ */
+static void Bench_CanTaskStep(void *arg)
+{
+    CAN_Instance_t *can = arg;
+    const CAN_RxFrame_t *frame;
+
+    while ((frame = CAN_RxPeek(can)) != NULL)
+    {
+        CAN_Dispatch(can, frame);
+        CAN_RxRelease(can, frame);
+    }
+    CANTP_Poll(can);
+    CAN_HealthPoll(can);
+}
+
+static uint8_t Bench_OpenPair(Bench_Side_t *side, uint16_t baseId, uint8_t fd)
+{
+    for (uint8_t k = 0; k < BENCH_SIDE_NUM; k++)
+    {
+        Bench_Side_t *s = &side[k];
+        s->side = k;
+        if (CANTP_Open(&s->link, k ? &can2 : &can1, (uint16_t)(baseId + k), (uint16_t)(baseId + (k ^ 1U)), fd,
+                       s->rxBuf, sizeof(s->rxBuf), Bench_RxDone))
+            return 1;
+        s->link.ctx        = s;
+        s->link.txCallback = Bench_TxDone;
+    }
+    return 0;
+}
+
+/**
+ * @brief 运行一种情况
+ * @param side: 链路对
+ * @param duplex: 0表示只有第0端发送，1表示两端同时发送
+ * @retval 0表示全部消息送达且校验通过
+ */
+static uint8_t Bench_Run(const char *name, Bench_Side_t *side, uint8_t duplex, uint32_t msgNum)
+{
+    uint32_t replace0   = can1.txQueue.replace_cnt + can2.txQueue.replace_cnt;
+    uint32_t arbLost0   = SimBus_GetStats(0)->arb_lost_cnt;
+    uint32_t frames0    = SimBus_GetStats(0)->frame_cnt;
+    uint64_t busy0      = SimBus_GetStats(0)->busy_ns;
+    uint64_t start      = Sim_NowNs();
+    uint8_t fail        = 0;
+
+    for (uint8_t k = 0; k < BENCH_SIDE_NUM; k++)
+    {
+        Bench_Side_t *s = &side[k];
+        s->tx_target = (k == 0U || duplex) ? msgNum : 0U;
+        s->tx_started = s->tx_done = s->tx_err = s->rx_ok = s->rx_bad = 0;
+        s->rx_last_ns = start;
+        s->link.seq_err_cnt = s->link.timeout_cnt = s->link.overflow_cnt = 0;
+    }
+    for (uint8_t k = 0; k < BENCH_SIDE_NUM; k++) Bench_SendNext(&side[k]);
+
+    while (Sim_NowNs() - start < BENCH_TIMEOUT_NS)
+    {
+        uint8_t busy = 0;
+        for (uint8_t k = 0; k < BENCH_SIDE_NUM; k++)
+        {
+            Bench_Side_t *s = &side[k];
+            if (s->link.txState != CANTP_IDLE || side[k ^ 1U].rx_ok + side[k ^ 1U].rx_bad < s->tx_started
+                || s->tx_started < s->tx_target)
+                busy = 1;
+        }
+        if (!busy) break;
+        Sim_RunFor(BENCH_STEP_NS);
+    }
+
+    const Sim_BusStats_t *bus = SimBus_GetStats(0);
+    uint64_t elapsed = Sim_NowNs() - start;
+    printf("%s\n", name);
+    for (uint8_t k = 0; k < BENCH_SIDE_NUM; k++)
+    {
+        Bench_Side_t *tx = &side[k], *rx = &side[k ^ 1U];
+        if (tx->tx_target == 0U) continue;
+
+        double sec = (rx->rx_last_ns - start) / 1e9;
+        printf("  can%u->can%u: %3u/%u delivered, %u bad, %7.1f kB/s, tx err %u, seq err %u, timeout %u, overflow %u\n",
+               k + 1U, (k ^ 1U) + 1U, rx->rx_ok, tx->tx_target, rx->rx_bad,
+               sec > 0.0 ? rx->rx_ok * (double)msgLen / sec / 1e3 : 0.0, tx->tx_err,
+               rx->link.seq_err_cnt, rx->link.timeout_cnt + tx->link.timeout_cnt,
+               rx->link.overflow_cnt + tx->link.overflow_cnt);
+        if (rx->rx_ok != tx->tx_target || rx->rx_bad != 0U || tx->tx_err != 0U || tx->tx_done != tx->tx_target)
+            fail = 1;
+    }
+    printf("  %.3f s, bus %u frames, load %.1f%%, %u arbitration losses, tx queue replaced %u\n", elapsed / 1e9,
+           bus->frame_cnt - frames0, (bus->busy_ns - busy0) * 100.0 / (elapsed ? elapsed : 1),
+           bus->arb_lost_cnt - arbLost0, can1.txQueue.replace_cnt + can2.txQueue.replace_cnt - replace0);
+    if (fail) printf("  FAIL\n");
+    return fail;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t msgNum = 50;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:l:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'm': msgNum = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l': msgLen = (uint16_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-m messages] [-l bytes]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (msgNum == 0U || msgLen == 0U || msgLen > CANTP_MSG_MAX)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    Sim_Init();
+    Timebase_Init();
+    Monitor_Init();
+    CAN_RecInit();
+    SimFdcan_SetBus(1, 0);
+    MX_FDCAN1_Init();
+    MX_FDCAN2_Init();
+    hfdcan1.Init.AutoRetransmission = ENABLE;
+    hfdcan2.Init.AutoRetransmission = ENABLE;
+    if (HAL_FDCAN_Init(&hfdcan1) != HAL_OK || HAL_FDCAN_Init(&hfdcan2) != HAL_OK)
+    {
+        fprintf(stderr, "HAL_FDCAN_Init failed\n");
+        return 1;
+    }
+    CANx_Init(&hfdcan1, CAN1_rxCallBack);
+    CANx_Init(&hfdcan2, CAN2_rxCallBack);
+    if (CAN_Open(&can1, benchFilter, 2) || CAN_Open(&can2, benchFilter, 2))
+    {
+        fprintf(stderr, "CAN_Open failed\n");
+        return 1;
+    }
+    can1.rxTask = SimTask_Create(Bench_CanTaskStep, &can1, CAN_HEALTH_POLL_MS);
+    can2.rxTask = SimTask_Create(Bench_CanTaskStep, &can2, CAN_HEALTH_POLL_MS);
+
+    if (Bench_OpenPair(classicSide, 0x700, 0) || Bench_OpenPair(fdSide, 0x710, 1))
+    {
+        fprintf(stderr, "CANTP_Open failed\n");
+        return 1;
+    }
+
+    printf("%u x %u bytes per side, FDCAN1 and FDCAN2 on one bus\n", msgNum, msgLen);
+    uint8_t fail = 0;
+    fail |= Bench_Run("classic one-way", classicSide, 0, msgNum);
+    fail |= Bench_Run("classic duplex", classicSide, 1, msgNum);
+    fail |= Bench_Run("FD+BRS one-way", fdSide, 0, msgNum);
+    fail |= Bench_Run("FD+BRS duplex", fdSide, 1, msgNum);
+    return fail;
+}
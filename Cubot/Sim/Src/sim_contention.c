@@ -0,0 +1,283 @@
+/**
+ **********************************************************************************
+ * @file        sim_contention.c
+ * @brief       仿真层，电机反馈快照的读写竞争基准
+ * @details     用三个线程在同一个CPU上按固定优先级（SCHED_FIFO）模拟单核 MCU 上的任务：
+ *              高优先级“CAN任务”周期性调用固件的 MotorProcess() 写入反馈；
+ *              中优先级“其他任务”周期性占用CPU一段时间；
+ *              低优先级“Shoot_Task”不停读取反馈快照并检查各字段是否来自同一帧。
+ *              分别用 MotorGetSnapshot()（顺序锁）、原先的普通互斥量和带优先级继承（PTHREAD_PRIO_INHERIT）的
+ *              互斥量运行，对比CAN任务的响应时间：
+ *              普通互斥量下，低优先级读者持锁时被中优先级任务抢占，CAN任务随之被阻塞（优先级反转）；
+ *              优先级继承的互斥量下，CAN任务等锁时读者临时升到CAN任务的优先级，不再被中优先级任务抢占，
+ *              CAN任务最多等待读者的一次临界区（与FreeRTOS互斥量的优先级继承相同）；
+ *              快照方式下写者从不等待，读者读取期间有写入时重读。
+ *              主机上的最大响应时间受其他进程和中断的干扰，单次运行中任一方式都可能偶尔出现毫秒级的值，
+ *              应多次运行比较平均响应时间和超时次数。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * How to use：
+ * 1. ./build-sim/cubot_contention [-t 每种方式的秒数]
+ *    需要 SCHED_FIFO 权限（root 或 CAP_SYS_NICE），否则按普通调度运行并给出提示，结果只作参考
+ * 2. 依次运行 snapshot、mutex、mutex-pi 三种方式，快照方式读到不一致的数据时返回非零值
+ **********************************************************************************
+ */
+#define _GNU_SOURCE //< sched_setaffinity()
+#include "sim.h"
+#include "rm_motor.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WRITER_PERIOD_NS  200000L  //< CAN任务写入周期
+#define MEDIUM_PERIOD_NS  4730000L //< 中优先级任务周期，与读者周期不成整数倍，抢占点遍历读者的各个阶段
+#define MEDIUM_BUSY_NS    1000000L //< 中优先级任务每周期占用CPU的时间
+#define READER_PERIOD_NS  1000000L //< Shoot_Task周期
+#define READER_BUSY_NS    400000L  //< Shoot_Task每周期读取反馈的时间
+#define DEADLINE_NS       500000L  //< CAN任务响应超过该时间计为超时（FIFO深度约对应0.5ms的反馈）
+#define PRIO_WRITER       30
+#define PRIO_MEDIUM       20
+#define PRIO_READER       10
+
+typedef enum {
+    MODE_SNAPSHOT = 0,
+    MODE_MUTEX    = 1,
+    MODE_MUTEX_PI = 2
+} Bench_Mode;
+
+static const char *const modeName[] = {"snapshot", "mutex", "mutex-pi"};
+
+static Motor_t motor;
+static pthread_mutex_t dataMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t piMutex; //< 优先级继承的互斥量，在 main() 中初始化
+static pthread_mutex_t *lock;   //< 本次运行使用的互斥量，快照方式为NULL
+static volatile int running;
+static uint8_t fifoOk = 1;
+
+static uint32_t writerFrames, writerLate;
+static uint64_t writerRespSum, writerRespMax;
+static uint64_t readerReads, readerRetries, readerTorn;
+
+static uint64_t Bench_Ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void Bench_SpinNs(uint64_t ns)
+{
+    uint64_t end = Bench_Ns() + ns;
+    while (Bench_Ns() < end) {}
+}
+
+static void Bench_SleepUntil(struct timespec *next, long periodNs)
+{
+    next->tv_nsec += periodNs;
+    if (next->tv_nsec >= 1000000000L) { next->tv_nsec -= 1000000000L; next->tv_sec++; }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, next, NULL);
+}
+
+/**
+ * @brief 内部函数：把线程设为 SCHED_FIFO 并固定在 CPU0 上，模拟单核按优先级抢占
+ */
+static void Bench_SetPriority(int prio)
+{
+    cpu_set_t cpus;
+    struct sched_param sp = {.sched_priority = prio};
+
+    CPU_ZERO(&cpus);
+    CPU_SET(0, &cpus);
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0) fifoOk = 0;
+}
+
+/**
+ * @brief 内部函数：第k帧的反馈数据，各字段都由k得出，读者据此检查是否来自同一帧
+ */
+static void Bench_MakeFrame(CAN_RxFrame_t *frame, uint32_t k)
+{
+    uint16_t v = (uint16_t)k;
+
+    memset(frame, 0, sizeof(*frame));
+    frame->id        = 0x201;
+    frame->len       = 8;
+    frame->timestamp = k;
+    frame->data[0]   = (uint8_t)((v & 0x1FFFU) >> 8);
+    frame->data[1]   = (uint8_t)v;
+    frame->data[2]   = (uint8_t)(v >> 8);
+    frame->data[3]   = (uint8_t)v;
+    frame->data[4]   = (uint8_t)((v ^ 0x5555U) >> 8);
+    frame->data[5]   = (uint8_t)(v ^ 0x5555U);
+    frame->data[6]   = (uint8_t)v;
+}
+
+static uint8_t Bench_Consistent(int16_t ecd, int16_t speed, int16_t current, uint8_t temp, uint32_t timestamp)
+{
+    uint16_t v = (uint16_t)speed;
+    return (uint16_t)ecd == (v & 0x1FFFU) && (uint16_t)current == (v ^ 0x5555U) && temp == (uint8_t)v
+        && (uint16_t)timestamp == v;
+}
+
+/* 高优先级：CAN任务，响应时间从计划释放时刻算起，包含被阻塞的时间 */
+static void *Bench_Writer(void *arg)
+{
+    CAN_RxFrame_t frame;
+    struct timespec next;
+    (void)arg;
+
+    Bench_SetPriority(PRIO_WRITER);
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (uint32_t k = 1; running; k++)
+    {
+        Bench_SleepUntil(&next, WRITER_PERIOD_NS);
+        uint64_t release = (uint64_t)next.tv_sec * 1000000000ULL + (uint64_t)next.tv_nsec;
+
+        Bench_MakeFrame(&frame, k);
+        if (lock != NULL) pthread_mutex_lock(lock);
+        MotorProcess(&can1, &frame, &motor);
+        if (lock != NULL) pthread_mutex_unlock(lock);
+
+        uint64_t resp = Bench_Ns() - release;
+        writerRespSum += resp;
+        if (resp > DEADLINE_NS) writerLate++;
+        if (resp > writerRespMax) writerRespMax = resp;
+        writerFrames++;
+    }
+    return NULL;
+}
+
+/* 中优先级：与电机数据无关、周期性占用CPU的任务 */
+static void *Bench_Medium(void *arg)
+{
+    struct timespec next;
+    (void)arg;
+
+    Bench_SetPriority(PRIO_MEDIUM);
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (running)
+    {
+        Bench_SleepUntil(&next, MEDIUM_PERIOD_NS);
+        Bench_SpinNs(MEDIUM_BUSY_NS);
+    }
+    return NULL;
+}
+
+/* 低优先级：Shoot_Task，不停读取反馈 */
+static void *Bench_Reader(void *arg)
+{
+    struct timespec next;
+    (void)arg;
+
+    Bench_SetPriority(PRIO_READER);
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (running)
+    {
+        Bench_SleepUntil(&next, READER_PERIOD_NS);
+        /* 每个周期连续读取一段时间，留出CPU，避免三个实时线程占满CPU触发内核的实时限流 */
+        uint64_t end = Bench_Ns() + READER_BUSY_NS;
+        while (Bench_Ns() < end)
+        {
+        int16_t ecd, speed, current;
+        uint8_t temp;
+        uint32_t timestamp;
+
+        if (lock == NULL)
+        {
+            MotorSnapshot_t snap;
+            readerRetries += MotorGetSnapshot(&motor, &snap);
+            ecd = snap.raw_ecd; speed = snap.speed_rpm; current = snap.torque_current;
+            temp = snap.temperature; timestamp = snap.timestamp;
+        }
+        else
+        {
+            pthread_mutex_lock(lock);
+            ecd = motor.rawData.raw_ecd; speed = motor.rawData.speed_rpm; current = motor.rawData.torque_current;
+            temp = motor.rawData.temperature; timestamp = motor.treatedData.rx_timestamp;
+            pthread_mutex_unlock(lock);
+        }
+
+        if (timestamp != 0U && !Bench_Consistent(ecd, speed, current, temp, timestamp)) readerTorn++;
+        readerReads++;
+        }
+    }
+    return NULL;
+}
+
+static void Bench_Run(Bench_Mode m, double seconds)
+{
+    pthread_t writer, medium, reader;
+
+    memset(&motor.feedback, 0, sizeof(motor.feedback));
+    motor.treatedData.rx_timestamp = 0;
+    writerFrames = 0; writerLate = 0; writerRespSum = 0; writerRespMax = 0;
+    readerReads = 0; readerRetries = 0; readerTorn = 0;
+    lock    = (m == MODE_SNAPSHOT) ? NULL : (m == MODE_MUTEX_PI) ? &piMutex : &dataMutex;
+    running = 1;
+
+    pthread_create(&reader, NULL, Bench_Reader, NULL);
+    pthread_create(&medium, NULL, Bench_Medium, NULL);
+    pthread_create(&writer, NULL, Bench_Writer, NULL);
+    struct timespec ts = {(time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9)};
+    nanosleep(&ts, NULL);
+    running = 0;
+    pthread_join(writer, NULL);
+    pthread_join(medium, NULL);
+    pthread_join(reader, NULL);
+
+    printf("%-8s: CAN task %u frames, response avg %.1f us max %.1f us, %u over %ld us; Shoot_Task %llu reads, %llu retries, %llu torn\n",
+           modeName[m], writerFrames,
+           writerFrames ? writerRespSum / 1e3 / writerFrames : 0.0, writerRespMax / 1e3,
+           writerLate, DEADLINE_NS / 1000L,
+           (unsigned long long)readerReads, (unsigned long long)readerRetries, (unsigned long long)readerTorn);
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 2.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': seconds = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-t seconds]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (seconds <= 0.0)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    if (pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT) != 0 || pthread_mutex_init(&piMutex, &attr) != 0)
+    {
+        fprintf(stderr, "PTHREAD_PRIO_INHERIT not supported\n");
+        return 2;
+    }
+    pthread_mutexattr_destroy(&attr);
+
+    Sim_Init();
+    Motor_DriverInit();
+    MotorInit(&motor, 0, Motor3508, 19, CAN1, 0x201);
+
+    Bench_Run(MODE_SNAPSHOT, seconds);
+    uint64_t snapshotTorn = readerTorn;
+    Bench_Run(MODE_MUTEX, seconds);
+    Bench_Run(MODE_MUTEX_PI, seconds);
+
+    if (!fifoOk) printf("warning: SCHED_FIFO not permitted, threads ran under the default scheduler\n");
+    return snapshotTorn != 0U;
+}
@@ -0,0 +1,172 @@
+/**
+ **********************************************************************************
+ * @file        sim_core.c
+ * @brief       仿真层，仿真时钟和离散事件循环
+ * @details     仿真时间以纳秒推进，每个时刻依次处理总线事件（触发FDCAN中断）、定时器和就绪任务，
+ *              直到该时刻没有新的事件，再跳到下一个最早的事件时刻。TIM2 计数值随仿真时间更新，
+ *              Timebase_Us() 读到的即为仿真时间。实时模式下按墙上时间推进，用于对接 SocketCAN。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ */
+#include "sim.h"
+#include "stm32h7xx_hal.h"
+#include <time.h>
+
+#define SIM_TIM_CLK_HZ 240000000ULL //< 与 sim_hal.c 中 PCLK1 和 APB1 分频的设置一致
+
+extern TIM_TypeDef simTim2Reg;
+
+static uint64_t simNowNs;
+static uint64_t simWallStartNs;
+static double simRealtime; //< 仿真时间与墙上时间之比，0表示不跟随墙上时间
+static Sim_Timer_t *simTimerList;
+
+/**
+ * @brief 读取单调时钟（纳秒），用于测量被测代码的CPU耗时
+ */
+uint64_t Sim_CpuNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 内部函数：推进仿真时间并同步 TIM2 计数值
+ */
+static void Sim_SetNow(uint64_t ns)
+{
+    simNowNs = ns;
+    if (simTim2Reg.CR1 & TIM_CR1_CEN)
+        simTim2Reg.CNT = (uint32_t)((unsigned __int128)ns * SIM_TIM_CLK_HZ / 1000000000ULL / (simTim2Reg.PSC + 1U));
+}
+
+void Sim_Init(void)
+{
+    simNowNs     = 0;
+    simTimerList = NULL;
+    simRealtime  = 0;
+}
+
+/**
+ * @brief 切换实时模式，SocketCAN 后端需要仿真时间跟随墙上时间，回放可按倍速跟随
+ * @param scale: 仿真时间与墙上时间之比，1为实时，0表示尽快运行
+ */
+void Sim_SetRealtime(double scale)
+{
+    simRealtime    = scale;
+    simWallStartNs = Sim_CpuNs() - (scale > 0.0 ? (uint64_t)(simNowNs / scale) : 0U);
+}
+
+/**
+ * @brief 内部函数：墙上时间对应的仿真时刻
+ */
+static uint64_t Sim_WallNs(void)
+{
+    return (uint64_t)((Sim_CpuNs() - simWallStartNs) * simRealtime);
+}
+
+uint64_t Sim_NowNs(void)
+{
+    return simNowNs;
+}
+
+/**
+ * @brief 启动周期定时器
+ * @param timer: 定时器，由调用者提供存储
+ * @param firstNs: 首次触发的仿真时刻
+ * @param periodNs: 触发周期，为0时只触发一次
+ * @param callback: 定时器回调
+ * @param ctx: 回调参数
+ */
+void Sim_TimerStart(Sim_Timer_t *timer, uint64_t firstNs, uint64_t periodNs, void (*callback)(void *), void *ctx)
+{
+    Sim_TimerStop(timer);
+    timer->due_ns    = firstNs;
+    timer->period_ns = periodNs;
+    timer->Callback  = callback;
+    timer->ctx       = ctx;
+    timer->next      = simTimerList;
+    simTimerList     = timer;
+}
+
+void Sim_TimerStop(Sim_Timer_t *timer)
+{
+    for (Sim_Timer_t **p = &simTimerList; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == timer)
+        {
+            *p = timer->next;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 内部函数：触发所有到期的定时器
+ * @retval 1表示有定时器触发
+ */
+static uint8_t Sim_TimerFire(uint64_t nowNs)
+{
+    uint8_t fired = 0;
+    Sim_Timer_t *t = simTimerList;
+
+    while (t != NULL)
+    {
+        Sim_Timer_t *next = t->next;
+        if (t->due_ns <= nowNs)
+        {
+            if (t->period_ns != 0U) t->due_ns += t->period_ns;
+            else                    Sim_TimerStop(t);
+            t->Callback(t->ctx);
+            fired = 1;
+        }
+        t = next;
+    }
+    return fired;
+}
+
+/**
+ * @brief 运行仿真
+ * @param durationNs: 推进的仿真时间
+ */
+void Sim_RunFor(uint64_t durationNs)
+{
+    uint64_t end = simNowNs + durationNs;
+
+    Sim_SetNow(simNowNs);
+    for (;;)
+    {
+        /* 处理当前时刻的全部事件，中断先于定时器，定时器先于任务 */
+        while (SimBus_Process(simNowNs) | SimFdcan_Service() | Sim_TimerFire(simNowNs) | SimTask_RunReady(simNowNs)) {}
+
+        uint64_t next = end;
+        uint64_t t    = SimBus_NextEventNs();
+        if (t < next) next = t;
+        t = SimTask_NextWakeNs();
+        if (t < next) next = t;
+        for (Sim_Timer_t *timer = simTimerList; timer != NULL; timer = timer->next)
+        {
+            if (timer->due_ns < next) next = timer->due_ns;
+        }
+
+        if (simNowNs >= end) break;
+
+        if (simRealtime > 0.0)
+        {
+            /* 等待到下一事件时刻，期间从 SocketCAN 收到的帧按到达时刻注入 */
+            uint64_t wall = Sim_WallNs();
+            uint8_t got = 0;
+            while (wall < next && !got)
+            {
+                got  = SimBus_PollSockets((uint64_t)((next - wall) / simRealtime));
+                wall = Sim_WallNs();
+                if (got) next = (wall < next) ? wall : next;
+            }
+        }
+
+        Sim_SetNow(next);
+    }
+}
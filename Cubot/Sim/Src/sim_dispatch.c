@@ -0,0 +1,232 @@
+/**
+ **********************************************************************************
+ * @file        sim_dispatch.c
+ * @brief       仿真层，CAN接收分发耗时基准
+ * @details     对比固件当前的 CAN_Dispatch()（2048项ID索引表 + 订阅者处理函数）与最初的
+ *              Motor_QuickMap 写法（0x200~0x20B窗口内按 [CAN][ID-0x200] 取电机指针后直接处理）每帧的耗时。
+ *              最初的写法在本文件中照原样复制，作为对照；耗时在x86上为TSC周期数，其他平台为纳秒。
+ *              分两组测量：
+ *              1. 只计路由：CAN2上订阅8个电机ID和窗口外的2个ID（超级电容、板间分段传输），处理函数只计数，
+ *                 窗口外的帧最初的写法无法分发，计数应为0，其余ID两种写法的计数应一致；
+ *              2. 含解算：CAN1上8个M3508电机，两种写法都调用 MotorProcess()。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * How to use：
+ * 1. ./build-sim/cubot_dispatch [-n 帧数]
+ * 2. 两种写法分发到各ID的帧数不一致时返回非零值
+ **********************************************************************************
+ */
+#include "sim.h"
+#include "driver_can.h"
+#include "driver_timebase.h"
+#include "driver_monitor.h"
+#include "rm_motor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+/* 不包含 x86intrin.h：其中的参数名与CMSIS的 __I/__O 等宏冲突 */
+#define BENCH_UNIT "cycles"
+static inline uint64_t Bench_Clock(void) { return __builtin_ia32_rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t Bench_Clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define MOTOR_NUM   8U
+#define EXTRA_NUM   2U
+#define NODE_NUM    (MOTOR_NUM + EXTRA_NUM)
+#define FRAME_NUM   1024U //< 帧序列长度，2的幂
+
+/**
+ * @brief 只计路由时的订阅者
+ */
+typedef struct
+{
+    uint16_t id;
+    uint32_t cnt;
+    uint32_t sum;
+} Bench_Node_t;
+
+static Bench_Node_t node[NODE_NUM];
+static Motor_t motor[MOTOR_NUM];
+static CAN_RxFrame_t frame[FRAME_NUM];
+static CAN_RxFrame_t motorFrame[FRAME_NUM];
+
+/* 对照：最初的写法，[CAN][ID-0x200] 直接存放订阅对象 */
+static void *Legacy_QuickMap[2][0x0C];
+
+__attribute__((noinline)) static void Bench_Count(CAN_Instance_t *can, const CAN_RxFrame_t *rx, void *ctx)
+{
+    Bench_Node_t *n = ctx;
+    (void)can;
+    n->cnt++;
+    n->sum += rx->data[0];
+}
+
+/**
+ * @brief 对照：最初 MotorProcess() 开头的路由部分，处理函数在编译期确定
+ */
+__attribute__((noinline)) static void Legacy_Route(CAN_Instance_t *can, const CAN_RxFrame_t *rx)
+{
+    uint32_t id = rx->id;
+
+    if (id < 0x200 || id > 0x20B) return;
+
+    uint8_t can_idx = (can->canHandler == &hfdcan2) ? 1 : 0;
+    void *obj       = Legacy_QuickMap[can_idx][id - 0x200];
+
+    if (obj != NULL) Bench_Count(can, rx, obj);
+}
+
+__attribute__((noinline)) static void Legacy_RouteMotor(CAN_Instance_t *can, const CAN_RxFrame_t *rx)
+{
+    uint32_t id = rx->id;
+
+    if (id < 0x200 || id > 0x20B) return;
+
+    uint8_t can_idx = (can->canHandler == &hfdcan2) ? 1 : 0;
+    Motor_t *m      = Legacy_QuickMap[can_idx][id - 0x200];
+
+    if (m != NULL) MotorProcess(can, rx, m);
+}
+
+/**
+ * @brief 分段计时取最小值，排除中断和调度的干扰
+ */
+static double Bench_Run(const char *name, void (*route)(CAN_Instance_t *, const CAN_RxFrame_t *),
+                        CAN_Instance_t *can, const CAN_RxFrame_t *seq, uint32_t frames)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t r = 0; r < frames; r += FRAME_NUM)
+    {
+        uint64_t t0 = Bench_Clock();
+        for (uint32_t k = 0; k < FRAME_NUM; k++) route(can, &seq[k]);
+        uint64_t t = Bench_Clock() - t0;
+        if (t < best) best = t;
+    }
+
+    double perFrame = (double)best / FRAME_NUM;
+    printf("%-34s %6.2f %s/frame\n", name, perFrame, BENCH_UNIT);
+    return perFrame;
+}
+
+static void Bench_ResetCount(void)
+{
+    for (uint32_t i = 0; i < NODE_NUM; i++) node[i].cnt = node[i].sum = 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = 1U << 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-n frames]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (frames < FRAME_NUM)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    Sim_Init();
+    Timebase_Init();
+    Monitor_Init();
+    MX_FDCAN1_Init();
+    MX_FDCAN2_Init();
+    CANx_Init(&hfdcan1, CAN1_rxCallBack);
+    CANx_Init(&hfdcan2, CAN2_rxCallBack);
+    Motor_DriverInit();
+
+    /* 第一组：CAN2上只计数的订阅者，最后两个ID在最初写法的窗口之外 */
+    const uint16_t extraId[EXTRA_NUM] = {0x211, 0x700};
+    for (uint32_t i = 0; i < NODE_NUM; i++)
+    {
+        node[i].id = (i < MOTOR_NUM) ? (uint16_t)(0x201U + i) : extraId[i - MOTOR_NUM];
+        if (CAN_Subscribe(&can2, node[i].id, Bench_Count, &node[i]))
+        {
+            fprintf(stderr, "CAN_Subscribe failed\n");
+            return 2;
+        }
+        if (node[i].id >= 0x200U && node[i].id <= 0x20BU) Legacy_QuickMap[1][node[i].id - 0x200U] = &node[i];
+    }
+
+    /* 第二组：CAN1上的M3508电机，按在线电机处理 */
+    for (uint32_t i = 0; i < MOTOR_NUM; i++)
+    {
+        if (MotorInit(&motor[i], 0, Motor3508, 19, CAN1, (uint16_t)(0x201U + i)))
+        {
+            fprintf(stderr, "MotorInit failed\n");
+            return 2;
+        }
+        Legacy_QuickMap[0][i + 1U] = &motor[i];
+    }
+
+    /* 帧序列：电机反馈为主，夹杂窗口外的ID和无人订阅的ID */
+    srand(1);
+    for (uint32_t k = 0; k < FRAME_NUM; k++)
+    {
+        int r = rand() % 16;
+        CAN_RxFrame_t *f = &frame[k];
+
+        memset(f, 0, sizeof(*f));
+        if (r < 12)       f->id = (uint32_t)(0x201 + rand() % MOTOR_NUM);
+        else if (r < 15)  f->id = extraId[rand() % EXTRA_NUM];
+        else              f->id = 0x20AU; // 无人订阅
+        f->len = 8;
+        for (uint8_t b = 0; b < 8; b++) f->data[b] = (uint8_t)rand();
+
+        motorFrame[k]    = *f;
+        motorFrame[k].id = (uint32_t)(0x201 + k % MOTOR_NUM);
+    }
+
+    printf("%u frames, %u motor IDs + %u IDs outside 0x200-0x20B\n", frames, MOTOR_NUM, EXTRA_NUM);
+
+    /* 两种写法对同一序列的分发结果：窗口内ID的计数一致，窗口外ID只有CAN_Dispatch()送达 */
+    uint32_t legacyCnt[NODE_NUM];
+    int fail = 0;
+    Bench_ResetCount();
+    for (uint32_t k = 0; k < FRAME_NUM; k++) Legacy_Route(&can2, &frame[k]);
+    for (uint32_t i = 0; i < NODE_NUM; i++) legacyCnt[i] = node[i].cnt;
+    Bench_ResetCount();
+    for (uint32_t k = 0; k < FRAME_NUM; k++) CAN_Dispatch(&can2, &frame[k]);
+    for (uint32_t i = 0; i < NODE_NUM; i++)
+    {
+        uint32_t expect = 0;
+        for (uint32_t k = 0; k < FRAME_NUM; k++) expect += (frame[k].id == node[i].id);
+        if (node[i].cnt != expect || (i < MOTOR_NUM && legacyCnt[i] != expect) || (i >= MOTOR_NUM && legacyCnt[i] != 0U))
+        {
+            printf("FAIL: id 0x%03X dispatched %u, legacy %u, expected %u\n", node[i].id, node[i].cnt, legacyCnt[i],
+                   expect);
+            fail = 1;
+        }
+    }
+
+    double legacy = Bench_Run("Motor_QuickMap, routing only", Legacy_Route, &can2, frame, frames);
+    double table  = Bench_Run("CAN_Dispatch, routing only", CAN_Dispatch, &can2, frame, frames);
+    printf("CAN_Dispatch vs Motor_QuickMap: %.2fx\n", legacy / table);
+
+    double legacyMotor = Bench_Run("Motor_QuickMap + MotorProcess", Legacy_RouteMotor, &can1, motorFrame, frames);
+    double tableMotor  = Bench_Run("CAN_Dispatch + MotorProcess", CAN_Dispatch, &can1, motorFrame, frames);
+    printf("CAN_Dispatch vs Motor_QuickMap: %.2fx\n", legacyMotor / tableMotor);
+    return fail;
+}
@@ -0,0 +1,614 @@
+/**
+ **********************************************************************************
+ * @file        sim_fdcan.c
+ * @brief       仿真层，FDCAN 控制器和 HAL_FDCAN 接口
+ * @details     实现驱动层用到的 HAL_FDCAN_xxx 接口，控制器以节点身份挂在仿真总线上。
+ *              IR/IE/ILS/ILE/PSR/ECR/CCCR 在寄存器镜像中按硬件语义维护，驱动直接读写寄存器的代码
+ *              （中断服务函数、总线关闭恢复）无需修改；置位中断标志后按中断线优先级调用
+ *              FDCANx_ITy_IRQHandler()，与硬件中断向量一致。
+ *              按 Message RAM 参数模拟接收FIFO深度（阻塞模式，满时置报文丢失标志）、元素大小和发送FIFO深度；
+ *              关闭自动重发（AutoRetransmission = DISABLE）时仲裁失败的帧不再重发，与硬件一致。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ */
+#include "sim.h"
+#include "fdcan.h"
+#include "stm32h7xx_it.h"
+#include <string.h>
+
+#define SIM_FDCAN_CLK_HZ  120000000U //< FDCAN 内核时钟，与 CubeMX 中 PLL 配置一致
+#define SIM_FDCAN_RX_MAX  64U
+#define SIM_FDCAN_TX_MAX  32U
+#define SIM_FDCAN_IRQ_MAX 16U        //< 一次触发内最多连续进入中断的次数，防止标志未清除时死循环
+
+FDCAN_GlobalTypeDef simFdcanReg[2];
+FDCAN_ClockCalibrationUnit_TypeDef simFdcanCcuReg;
+
+typedef struct
+{
+    FDCAN_RxHeaderTypeDef header;
+    uint8_t data[SIM_FRAME_DATA_MAX];
+} SimFdcan_RxElmt_t;
+
+typedef struct
+{
+    FDCAN_TxHeaderTypeDef header;
+    uint8_t data[SIM_FRAME_DATA_MAX];
+} SimFdcan_TxElmt_t;
+
+typedef struct
+{
+    FDCAN_HandleTypeDef *hfdcan;
+    Sim_Node_t node;
+    FDCAN_FilterTypeDef stdFilter[128];
+    FDCAN_FilterTypeDef extFilter[64];
+    uint32_t nonMatchingStd;
+    uint32_t nonMatchingExt;
+    uint32_t nominal_bit_ns;
+    uint8_t ts_enable;
+    uint32_t ts_presc;
+    SimFdcan_RxElmt_t rx[2][SIM_FDCAN_RX_MAX];
+    uint32_t rx_get[2];
+    uint32_t rx_put[2];
+    SimFdcan_TxElmt_t tx[SIM_FDCAN_TX_MAX];
+    uint32_t tx_get;
+    uint32_t tx_put;
+    Sim_Timer_t recoverTimer;
+    uint8_t in_irq;
+    uint32_t tx_abort_cnt;
+    uint64_t isr_ns;
+} SimFdcan_t;
+
+static SimFdcan_t simFdcan[2];
+static uint8_t simFdcanBus[2] = {0, 1}; //< 各控制器挂接的总线，默认FDCAN1接总线0、FDCAN2接总线1
+
+static const uint8_t simDlcToLen[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+static SimFdcan_t *SimFdcan_Get(const FDCAN_HandleTypeDef *hfdcan)
+{
+    return (hfdcan->Instance == FDCAN2) ? &simFdcan[1] : &simFdcan[0];
+}
+
+/**
+ * @brief 内部函数：FDCAN_DATA_BYTES_x（元素字数）换算为数据区字节数
+ */
+static uint32_t SimFdcan_ElmtBytes(uint32_t elmtSize)
+{
+    return (elmtSize - 2U) * 4U;
+}
+
+/**
+ * @brief 内部函数：按中断线触发中断服务函数，中断线0优先级高于中断线1
+ *
+ * 中断服务函数中再次置位的标志在返回后继续处理；中断服务函数内部触发的事件不嵌套调用，
+ * 与同一中断线不可重入的硬件行为一致。
+ * @retval 1表示有中断服务函数运行
+ */
+static uint8_t SimFdcan_Irq(SimFdcan_t *c)
+{
+    FDCAN_GlobalTypeDef *reg = c->hfdcan->Instance;
+    uint8_t idx = (uint8_t)(c - simFdcan);
+    uint8_t ran = 0;
+
+    if (c->in_irq) return 0;
+    c->in_irq = 1;
+
+    for (uint8_t n = 0; n < SIM_FDCAN_IRQ_MAX; n++)
+    {
+        uint32_t entry   = reg->IR;
+        uint32_t pending = entry & reg->IE;
+        uint64_t start   = Sim_CpuNs();
+
+        if ((reg->ILE & FDCAN_INTERRUPT_LINE0) && (pending & ~reg->ILS))
+        {
+            if (idx == 0U) FDCAN1_IT0_IRQHandler();
+            else           FDCAN2_IT0_IRQHandler();
+        }
+        else if ((reg->ILE & FDCAN_INTERRUPT_LINE1) && (pending & reg->ILS))
+        {
+            if (idx == 0U) FDCAN1_IT1_IRQHandler();
+            else           FDCAN2_IT1_IRQHandler();
+        }
+        else break;
+
+        c->isr_ns += Sim_CpuNs() - start;
+
+        /* IR为写1清零：中断服务函数写入IR的值在镜像中表现为直接覆盖，按写入值清除进入中断时的标志 */
+        reg->IR = entry & ~reg->IR;
+        ran = 1;
+    }
+
+    c->in_irq = 0;
+    return ran;
+}
+
+/**
+ * @brief 检查挂起的中断，NVIC为电平触发，使能中断时标志已置位也会立即进入中断
+ * @retval 1表示有中断服务函数运行
+ */
+uint8_t SimFdcan_Service(void)
+{
+    uint8_t ran = 0;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (simFdcan[i].hfdcan != NULL) ran |= SimFdcan_Irq(&simFdcan[i]);
+    }
+    return ran;
+}
+
+/**
+ * @brief 内部函数：由标准/扩展过滤器和全局过滤器决定接收位置
+ * @retval 0/1为FIFO编号，其余表示拒收
+ */
+static uint8_t SimFdcan_Filter(const SimFdcan_t *c, const Sim_Frame_t *frame, uint32_t *filterIndex)
+{
+    uint8_t ext = (frame->flags & SIM_FRAME_FLAG_EXT) != 0U;
+    const FDCAN_FilterTypeDef *table = ext ? c->extFilter : c->stdFilter;
+    uint32_t num = ext ? c->hfdcan->Init.ExtFiltersNbr : c->hfdcan->Init.StdFiltersNbr;
+
+    for (uint32_t i = 0; i < num; i++)
+    {
+        const FDCAN_FilterTypeDef *f = &table[i];
+        uint8_t match;
+
+        if (f->FilterConfig == FDCAN_FILTER_DISABLE) continue;
+        switch (f->FilterType)
+        {
+            case FDCAN_FILTER_RANGE:
+            case FDCAN_FILTER_RANGE_NO_EIDM: match = frame->id >= f->FilterID1 && frame->id <= f->FilterID2; break;
+            case FDCAN_FILTER_DUAL:          match = frame->id == f->FilterID1 || frame->id == f->FilterID2; break;
+            case FDCAN_FILTER_MASK:          match = (frame->id & f->FilterID2) == (f->FilterID1 & f->FilterID2); break;
+            default:                         match = 0; break;
+        }
+        if (!match) continue;
+
+        *filterIndex = i;
+        switch (f->FilterConfig)
+        {
+            case FDCAN_FILTER_TO_RXFIFO0:
+            case FDCAN_FILTER_TO_RXFIFO0_HP: return 0;
+            case FDCAN_FILTER_TO_RXFIFO1:
+            case FDCAN_FILTER_TO_RXFIFO1_HP: return 1;
+            default:                         return 2;
+        }
+    }
+
+    *filterIndex = 0;
+    switch (ext ? c->nonMatchingExt : c->nonMatchingStd)
+    {
+        case FDCAN_ACCEPT_IN_RX_FIFO0: return 0;
+        case FDCAN_ACCEPT_IN_RX_FIFO1: return 1;
+        default:                       return 2;
+    }
+}
+
+/**
+ * @brief 内部函数：当前时间戳计数值，每个标称位时间加一
+ */
+static uint16_t SimFdcan_Timestamp(const SimFdcan_t *c, uint64_t ns)
+{
+    if (!c->ts_enable || c->nominal_bit_ns == 0U) return 0;
+    return (uint16_t)(ns / c->nominal_bit_ns / c->ts_presc);
+}
+
+/* ---------------------------------- 总线节点 ---------------------------------- */
+
+static uint8_t SimFdcan_PeekTx(Sim_Node_t *node, Sim_Frame_t *frame)
+{
+    SimFdcan_t *c = node->ctx;
+    const SimFdcan_TxElmt_t *e;
+
+    if (c->hfdcan == NULL || (c->hfdcan->Instance->CCCR & FDCAN_CCCR_INIT) || c->tx_get == c->tx_put) return 0;
+
+    /* 队列模式下最高优先级（最小ID）先发，FIFO模式按写入顺序 */
+    uint32_t pick = c->tx_get;
+    if (c->hfdcan->Init.TxFifoQueueMode == FDCAN_TX_QUEUE_OPERATION)
+    {
+        for (uint32_t i = c->tx_get; i != c->tx_put; i++)
+        {
+            if (c->tx[i % SIM_FDCAN_TX_MAX].header.Identifier < c->tx[pick % SIM_FDCAN_TX_MAX].header.Identifier) pick = i;
+        }
+        if (pick != c->tx_get)
+        {
+            SimFdcan_TxElmt_t tmp = c->tx[c->tx_get % SIM_FDCAN_TX_MAX];
+            c->tx[c->tx_get % SIM_FDCAN_TX_MAX] = c->tx[pick % SIM_FDCAN_TX_MAX];
+            c->tx[pick % SIM_FDCAN_TX_MAX]      = tmp;
+        }
+    }
+
+    e = &c->tx[c->tx_get % SIM_FDCAN_TX_MAX];
+    frame->id    = e->header.Identifier;
+    frame->flags = ((e->header.IdType == FDCAN_EXTENDED_ID) ? SIM_FRAME_FLAG_EXT : 0U)
+                 | ((e->header.FDFormat == FDCAN_FD_CAN) ? SIM_FRAME_FLAG_FD : 0U)
+                 | ((e->header.BitRateSwitch == FDCAN_BRS_ON) ? SIM_FRAME_FLAG_BRS : 0U);
+    frame->len   = simDlcToLen[e->header.DataLength & 0x0FU];
+    memcpy(frame->data, e->data, frame->len);
+    return 1;
+}
+
+static void SimFdcan_TxDone(Sim_Node_t *node, uint8_t won)
+{
+    SimFdcan_t *c = node->ctx;
+    FDCAN_GlobalTypeDef *reg = c->hfdcan->Instance;
+
+    if (!won && c->hfdcan->Init.AutoRetransmission == ENABLE) return;
+
+    c->tx_get++;
+    if (!won)
+    {
+        c->tx_abort_cnt++;
+        return;
+    }
+
+    if (reg->TXBTIE != 0U)
+    {
+        reg->IR |= FDCAN_IR_TC;
+        SimFdcan_Irq(c);
+    }
+}
+
+static void SimFdcan_Rx(Sim_Node_t *node, const Sim_Frame_t *frame, uint64_t sofNs)
+{
+    SimFdcan_t *c = node->ctx;
+    FDCAN_GlobalTypeDef *reg = c->hfdcan->Instance;
+    uint32_t filterIndex;
+
+    if (reg->CCCR & FDCAN_CCCR_INIT) return;
+    /* 未开启FD的控制器收到FD帧视为格式错误 */
+    if ((frame->flags & SIM_FRAME_FLAG_FD) && (c->hfdcan->Init.FrameFormat & FDCAN_CCCR_FDOE) == 0U) return;
+
+    uint8_t fifo = SimFdcan_Filter(c, frame, &filterIndex);
+    if (fifo > 1U) return;
+
+    uint32_t depth = (fifo == 0U) ? c->hfdcan->Init.RxFifo0ElmtsNbr : c->hfdcan->Init.RxFifo1ElmtsNbr;
+    uint32_t elmt  = (fifo == 0U) ? c->hfdcan->Init.RxFifo0ElmtSize : c->hfdcan->Init.RxFifo1ElmtSize;
+
+    if (c->rx_put[fifo] - c->rx_get[fifo] >= depth)
+    {
+        /* 阻塞模式：FIFO满时新报文丢弃 */
+        reg->IR |= (fifo == 0U) ? FDCAN_IR_RF0L : FDCAN_IR_RF1L;
+        SimFdcan_Irq(c);
+        return;
+    }
+
+    SimFdcan_RxElmt_t *e = &c->rx[fifo][c->rx_put[fifo] % SIM_FDCAN_RX_MAX];
+    uint32_t stored = SimFdcan_ElmtBytes(elmt);
+
+    memset(&e->header, 0, sizeof(e->header));
+    e->header.Identifier            = frame->id;
+    e->header.IdType                = (frame->flags & SIM_FRAME_FLAG_EXT) ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+    e->header.RxFrameType           = FDCAN_DATA_FRAME;
+    e->header.DataLength            = frame->len <= 8U ? frame->len : 0U;
+    for (uint32_t dlc = 9U; dlc < 16U && frame->len > 8U; dlc++)
+    {
+        if (simDlcToLen[dlc] >= frame->len) { e->header.DataLength = dlc; break; }
+    }
+    e->header.ErrorStateIndicator   = FDCAN_ESI_ACTIVE;
+    e->header.BitRateSwitch         = (frame->flags & SIM_FRAME_FLAG_BRS) ? FDCAN_BRS_ON : FDCAN_BRS_OFF;
+    e->header.FDFormat              = (frame->flags & SIM_FRAME_FLAG_FD) ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
+    e->header.RxTimestamp           = SimFdcan_Timestamp(c, sofNs);
+    e->header.FilterIndex           = filterIndex;
+    e->header.IsFilterMatchingFrame = 0;
+
+    /* 超出元素大小的数据不存储 */
+    memset(e->data, 0, sizeof(e->data));
+    memcpy(e->data, frame->data, frame->len < stored ? frame->len : stored);
+
+    c->rx_put[fifo]++;
+    reg->IR |= (fifo == 0U) ? FDCAN_IR_RF0N : FDCAN_IR_RF1N;
+    SimFdcan_Irq(c);
+}
+
+/* -------------------------------- 错误注入 -------------------------------- */
+
+/**
+ * @brief 内部函数：总线关闭恢复，清除INIT后经过129次11个隐性位重新入网
+ */
+static void SimFdcan_RecoverCheck(void *ctx)
+{
+    SimFdcan_t *c = ctx;
+    FDCAN_GlobalTypeDef *reg = c->hfdcan->Instance;
+
+    if (reg->CCCR & FDCAN_CCCR_INIT) return;
+
+    Sim_TimerStop(&c->recoverTimer);
+    reg->PSR &= ~(FDCAN_PSR_BO | FDCAN_PSR_EP | FDCAN_PSR_EW);
+    reg->ECR  = 0;
+}
+
+/**
+ * @brief 使控制器进入总线关闭状态：TEC超过255，控制器自动置位INIT
+ */
+void SimFdcan_InjectBusOff(uint8_t bus)
+{
+    SimFdcan_t *c = &simFdcan[bus];
+    FDCAN_GlobalTypeDef *reg = c->hfdcan->Instance;
+
+    reg->ECR   = (reg->ECR & ~FDCAN_ECR_TEC) | (0xFFU << FDCAN_ECR_TEC_Pos);
+    reg->PSR  |= FDCAN_PSR_BO | FDCAN_PSR_EP | FDCAN_PSR_EW;
+    reg->CCCR |= FDCAN_CCCR_INIT;
+    reg->IR   |= FDCAN_IR_BO | FDCAN_IR_EP | FDCAN_IR_EW;
+
+    /* 恢复时长为129次11个隐性位，清除INIT后开始计 */
+    uint64_t recoverNs = 129ULL * 11ULL * c->nominal_bit_ns;
+    Sim_TimerStart(&c->recoverTimer, Sim_NowNs() + recoverNs, recoverNs, SimFdcan_RecoverCheck, c);
+
+    SimFdcan_Irq(c);
+}
+
+/**
+ * @brief 设置错误计数器，并按阈值置位错误警告/错误被动状态及中断
+ */
+void SimFdcan_SetErrorCounters(uint8_t bus, uint8_t tec, uint8_t rec)
+{
+    SimFdcan_t *c = &simFdcan[bus];
+    FDCAN_GlobalTypeDef *reg = c->hfdcan->Instance;
+    uint32_t psr = reg->PSR & ~(FDCAN_PSR_EW | FDCAN_PSR_EP);
+
+    reg->ECR = ((uint32_t)tec << FDCAN_ECR_TEC_Pos) | ((uint32_t)(rec & 0x7FU) << FDCAN_ECR_REC_Pos)
+             | ((rec >= 128U) ? FDCAN_ECR_RP : 0U);
+    if (tec >= 96U || rec >= 96U)   psr |= FDCAN_PSR_EW;
+    if (tec >= 128U || rec >= 128U) psr |= FDCAN_PSR_EP;
+
+    if ((psr ^ reg->PSR) & FDCAN_PSR_EW) reg->IR |= FDCAN_IR_EW;
+    if ((psr ^ reg->PSR) & FDCAN_PSR_EP) reg->IR |= FDCAN_IR_EP;
+    reg->PSR = psr;
+    SimFdcan_Irq(c);
+}
+
+uint32_t SimFdcan_TxAbortCount(uint8_t bus)
+{
+    return simFdcan[bus].tx_abort_cnt;
+}
+
+/**
+ * @brief 控制器中断服务函数累计耗时（主机纳秒）
+ */
+uint64_t SimFdcan_IsrNs(uint8_t bus)
+{
+    return simFdcan[bus].isr_ns;
+}
+
+/**
+ * @brief 把控制器挂到指定总线，两个控制器挂到同一总线即为板间回环；须在首次 HAL_FDCAN_Init() 之前调用
+ * @param ctrl: 0为FDCAN1，1为FDCAN2
+ * @param bus: 总线编号
+ */
+void SimFdcan_SetBus(uint8_t ctrl, uint8_t bus)
+{
+    if (ctrl < 2U && bus < SIM_BUS_NUM && simFdcan[ctrl].hfdcan == NULL) simFdcanBus[ctrl] = bus;
+}
+
+/* --------------------------------- HAL 接口 --------------------------------- */
+
+HAL_StatusTypeDef HAL_FDCAN_Init(FDCAN_HandleTypeDef *hfdcan)
+{
+    SimFdcan_t *c;
+    uint8_t bus;
+
+    if (hfdcan == NULL) return HAL_ERROR;
+    if (hfdcan->State == HAL_FDCAN_STATE_RESET)
+    {
+        hfdcan->Lock = HAL_UNLOCKED;
+        HAL_FDCAN_MspInit(hfdcan);
+    }
+
+    c   = SimFdcan_Get(hfdcan);
+    bus = simFdcanBus[c - simFdcan];
+    if (hfdcan->Init.RxFifo0ElmtsNbr > SIM_FDCAN_RX_MAX || hfdcan->Init.RxFifo1ElmtsNbr > SIM_FDCAN_RX_MAX
+        || hfdcan->Init.TxFifoQueueElmtsNbr > SIM_FDCAN_TX_MAX)
+        return HAL_ERROR;
+
+    memset(hfdcan->Instance, 0, sizeof(FDCAN_GlobalTypeDef));
+    hfdcan->Instance->CCCR = FDCAN_CCCR_INIT | FDCAN_CCCR_CCE | hfdcan->Init.FrameFormat
+                           | ((hfdcan->Init.AutoRetransmission == ENABLE) ? 0U : FDCAN_CCCR_DAR);
+
+    if (c->hfdcan == NULL)
+    {
+        c->node.PeekTx = SimFdcan_PeekTx;
+        c->node.TxDone = SimFdcan_TxDone;
+        c->node.Rx     = SimFdcan_Rx;
+        c->node.ctx    = c;
+        SimBus_Attach(&c->node, bus);
+    }
+    c->hfdcan         = hfdcan;
+    c->nonMatchingStd = FDCAN_ACCEPT_IN_RX_FIFO0;
+    c->nonMatchingExt = FDCAN_ACCEPT_IN_RX_FIFO0;
+    c->ts_enable      = 0;
+    c->ts_presc       = 1;
+    c->rx_get[0] = c->rx_put[0] = c->rx_get[1] = c->rx_put[1] = 0;
+    c->tx_get = c->tx_put = 0;
+    memset(c->stdFilter, 0, sizeof(c->stdFilter));
+    memset(c->extFilter, 0, sizeof(c->extFilter));
+
+    c->nominal_bit_ns = (uint32_t)(1000000000ULL * hfdcan->Init.NominalPrescaler
+                                   * (1U + hfdcan->Init.NominalTimeSeg1 + hfdcan->Init.NominalTimeSeg2) / SIM_FDCAN_CLK_HZ);
+    SimBus_SetBitTiming(bus, c->nominal_bit_ns,
+                        (uint32_t)(1000000000ULL * hfdcan->Init.DataPrescaler
+                                   * (1U + hfdcan->Init.DataTimeSeg1 + hfdcan->Init.DataTimeSeg2) / SIM_FDCAN_CLK_HZ));
+
+    hfdcan->ErrorCode = HAL_FDCAN_ERROR_NONE;
+    hfdcan->State     = HAL_FDCAN_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigFilter(FDCAN_HandleTypeDef *hfdcan, const FDCAN_FilterTypeDef *sFilterConfig)
+{
+    SimFdcan_t *c = SimFdcan_Get(hfdcan);
+
+    if (hfdcan->State != HAL_FDCAN_STATE_READY && hfdcan->State != HAL_FDCAN_STATE_BUSY) return HAL_ERROR;
+
+    if (sFilterConfig->IdType == FDCAN_STANDARD_ID)
+    {
+        if (sFilterConfig->FilterIndex >= hfdcan->Init.StdFiltersNbr) return HAL_ERROR;
+        c->stdFilter[sFilterConfig->FilterIndex] = *sFilterConfig;
+    }
+    else
+    {
+        if (sFilterConfig->FilterIndex >= hfdcan->Init.ExtFiltersNbr) return HAL_ERROR;
+        c->extFilter[sFilterConfig->FilterIndex] = *sFilterConfig;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigGlobalFilter(FDCAN_HandleTypeDef *hfdcan, uint32_t NonMatchingStd,
+                                               uint32_t NonMatchingExt, uint32_t RejectRemoteStd,
+                                               uint32_t RejectRemoteExt)
+{
+    SimFdcan_t *c = SimFdcan_Get(hfdcan);
+    (void)RejectRemoteStd;
+    (void)RejectRemoteExt;
+
+    if (hfdcan->State != HAL_FDCAN_STATE_READY) return HAL_ERROR;
+    c->nonMatchingStd = NonMatchingStd;
+    c->nonMatchingExt = NonMatchingExt;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigInterruptLines(FDCAN_HandleTypeDef *hfdcan, uint32_t ITList, uint32_t InterruptLine)
+{
+    if (InterruptLine == FDCAN_INTERRUPT_LINE0) CLEAR_BIT(hfdcan->Instance->ILS, ITList);
+    else                                        SET_BIT(hfdcan->Instance->ILS, ITList);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigTimestampCounter(FDCAN_HandleTypeDef *hfdcan, uint32_t TimestampPrescaler)
+{
+    SimFdcan_t *c = SimFdcan_Get(hfdcan);
+
+    if (hfdcan->State != HAL_FDCAN_STATE_READY) return HAL_ERROR;
+    c->ts_presc = (TimestampPrescaler >> FDCAN_TSCC_TCP_Pos) + 1U;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_EnableTimestampCounter(FDCAN_HandleTypeDef *hfdcan, uint32_t TimestampOperation)
+{
+    if (hfdcan->State != HAL_FDCAN_STATE_READY) return HAL_ERROR;
+    SimFdcan_Get(hfdcan)->ts_enable = (TimestampOperation == FDCAN_TIMESTAMP_INTERNAL);
+    return HAL_OK;
+}
+
+uint16_t HAL_FDCAN_GetTimestampCounter(const FDCAN_HandleTypeDef *hfdcan)
+{
+    return SimFdcan_Timestamp(SimFdcan_Get(hfdcan), Sim_NowNs());
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigTxDelayCompensation(FDCAN_HandleTypeDef *hfdcan, uint32_t TdcOffset,
+                                                      uint32_t TdcFilter)
+{
+    if (hfdcan->State != HAL_FDCAN_STATE_READY) return HAL_ERROR;
+    hfdcan->Instance->TDCR = (TdcFilter << FDCAN_TDCR_TDCF_Pos) | (TdcOffset << FDCAN_TDCR_TDCO_Pos);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_EnableTxDelayCompensation(FDCAN_HandleTypeDef *hfdcan)
+{
+    if (hfdcan->State != HAL_FDCAN_STATE_READY) return HAL_ERROR;
+    SET_BIT(hfdcan->Instance->DBTP, FDCAN_DBTP_TDC);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_Start(FDCAN_HandleTypeDef *hfdcan)
+{
+    if (hfdcan->State != HAL_FDCAN_STATE_READY) return HAL_ERROR;
+    hfdcan->State = HAL_FDCAN_STATE_BUSY;
+    CLEAR_BIT(hfdcan->Instance->CCCR, FDCAN_CCCR_INIT | FDCAN_CCCR_CCE);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_Stop(FDCAN_HandleTypeDef *hfdcan)
+{
+    SimFdcan_t *c = SimFdcan_Get(hfdcan);
+
+    if (hfdcan->State != HAL_FDCAN_STATE_BUSY) return HAL_ERROR;
+    SET_BIT(hfdcan->Instance->CCCR, FDCAN_CCCR_INIT);
+    c->tx_get = c->tx_put;
+    hfdcan->State = HAL_FDCAN_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ActivateNotification(FDCAN_HandleTypeDef *hfdcan, uint32_t ActiveITs,
+                                                 uint32_t BufferIndexes)
+{
+    FDCAN_GlobalTypeDef *reg = hfdcan->Instance;
+
+    if (hfdcan->State != HAL_FDCAN_STATE_READY && hfdcan->State != HAL_FDCAN_STATE_BUSY) return HAL_ERROR;
+
+    if ((ActiveITs & reg->ILS) == 0U)             SET_BIT(reg->ILE, FDCAN_INTERRUPT_LINE0);
+    else if ((ActiveITs & reg->ILS) == ActiveITs) SET_BIT(reg->ILE, FDCAN_INTERRUPT_LINE1);
+    else                                          reg->ILE = FDCAN_INTERRUPT_LINE0 | FDCAN_INTERRUPT_LINE1;
+
+    if (ActiveITs & FDCAN_IT_TX_COMPLETE) SET_BIT(reg->TXBTIE, BufferIndexes);
+    __HAL_FDCAN_ENABLE_IT(hfdcan, ActiveITs);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_DeactivateNotification(FDCAN_HandleTypeDef *hfdcan, uint32_t InactiveITs)
+{
+    FDCAN_GlobalTypeDef *reg = hfdcan->Instance;
+
+    if (hfdcan->State != HAL_FDCAN_STATE_READY && hfdcan->State != HAL_FDCAN_STATE_BUSY) return HAL_ERROR;
+
+    __HAL_FDCAN_DISABLE_IT(hfdcan, InactiveITs);
+    if (InactiveITs & FDCAN_IT_TX_COMPLETE) reg->TXBTIE = 0;
+    if ((reg->IE & ~reg->ILS) == 0U) CLEAR_BIT(reg->ILE, FDCAN_INTERRUPT_LINE0);
+    if ((reg->IE & reg->ILS) == 0U)  CLEAR_BIT(reg->ILE, FDCAN_INTERRUPT_LINE1);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef *hfdcan, const FDCAN_TxHeaderTypeDef *pTxHeader,
+                                                const uint8_t *pTxData)
+{
+    SimFdcan_t *c = SimFdcan_Get(hfdcan);
+
+    if (hfdcan->State != HAL_FDCAN_STATE_BUSY) return HAL_ERROR;
+    if (c->tx_put - c->tx_get >= hfdcan->Init.TxFifoQueueElmtsNbr)
+    {
+        hfdcan->ErrorCode |= HAL_FDCAN_ERROR_FIFO_FULL;
+        return HAL_ERROR;
+    }
+
+    SimFdcan_TxElmt_t *e = &c->tx[c->tx_put % SIM_FDCAN_TX_MAX];
+    e->header = *pTxHeader;
+    memcpy(e->data, pTxData, simDlcToLen[pTxHeader->DataLength & 0x0FU]);
+    c->tx_put++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef *hfdcan, uint32_t RxLocation,
+                                         FDCAN_RxHeaderTypeDef *pRxHeader, uint8_t *pRxData)
+{
+    SimFdcan_t *c = SimFdcan_Get(hfdcan);
+    uint8_t fifo = (RxLocation == FDCAN_RX_FIFO1) ? 1U : 0U;
+
+    if (hfdcan->State != HAL_FDCAN_STATE_BUSY) return HAL_ERROR;
+    if (c->rx_get[fifo] == c->rx_put[fifo])
+    {
+        hfdcan->ErrorCode |= HAL_FDCAN_ERROR_FIFO_EMPTY;
+        return HAL_ERROR;
+    }
+
+    const SimFdcan_RxElmt_t *e = &c->rx[fifo][c->rx_get[fifo] % SIM_FDCAN_RX_MAX];
+    *pRxHeader = e->header;
+    memcpy(pRxData, e->data, simDlcToLen[e->header.DataLength & 0x0FU]);
+    c->rx_get[fifo]++;
+    return HAL_OK;
+}
+
+uint32_t HAL_FDCAN_GetRxFifoFillLevel(const FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo)
+{
+    const SimFdcan_t *c = SimFdcan_Get(hfdcan);
+    uint8_t fifo = (RxFifo == FDCAN_RX_FIFO1) ? 1U : 0U;
+
+    return c->rx_put[fifo] - c->rx_get[fifo];
+}
+
+uint32_t HAL_FDCAN_GetTxFifoFreeLevel(const FDCAN_HandleTypeDef *hfdcan)
+{
+    const SimFdcan_t *c = SimFdcan_Get(hfdcan);
+
+    return hfdcan->Init.TxFifoQueueElmtsNbr - (c->tx_put - c->tx_get);
+}
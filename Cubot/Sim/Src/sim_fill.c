@@ -0,0 +1,198 @@
+/**
+ **********************************************************************************
+ * @file        sim_fill.c
+ * @brief       仿真层，MotorFillData() 耗时基准
+ * @details     四个大疆电机分布在0x200、0x1FF、0x2FF三个控制帧上，每轮各填一次控制量，对比三种写法每次调用的耗时：
+ *              最初按反馈ID逐段判断控制帧和字节偏移的写法、按操作表和槽位写入并判断控制帧是否存在的写法，
+ *              以及固件当前在MotorInit()中确定写入位置和限幅、填写时只做离线判断、限幅和写入的写法。
+ *              前两种写法在本文件中照原样复制，作为对照；另复制一份去掉离线判断的当前写法，单独给出离线判断的开销
+ *              （最初的写法没有离线判断）。耗时在x86上为TSC周期数，其他平台为纳秒。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * How to use：
+ * 1. ./build-sim/cubot_fill [-n 轮数]
+ * 2. 主机耗时只用于比较各写法的相对开销。目标板上在DEBUG构建中由Shoot_Task用DWT->CYCCNT
+ *    测量四个电机的填写耗时，结果在 shootFillCycles / shootFillCyclesMax 中，可用调试器查看
+ **********************************************************************************
+ */
+#include "sim.h"
+#include "rm_motor.h"
+#include "user_lib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+/* 不包含 x86intrin.h：其中的参数名与CMSIS的 __I/__O 等宏冲突 */
+#define BENCH_UNIT "cycles"
+static inline uint64_t Bench_Clock(void) { return __builtin_ia32_rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t Bench_Clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define MOTOR_NUM  4U
+#define OUTPUT_NUM 1024U //< 控制量序列长度，含超出限幅的值
+#define LEGACY_GROUP_NUM 3U //< 最初的写法只有 0x1FF/0x200/0x2FF 三个控制帧
+
+static const uint16_t motorId[MOTOR_NUM] = {0x201, 0x206, 0x20A, 0x204}; //< 覆盖三个控制帧，判断分支各不相同
+static Motor_t motor[MOTOR_NUM];
+static int32_t output[OUTPUT_NUM];
+static CAN_TxBuffer_t legacyBuffer[2][LEGACY_GROUP_NUM];
+
+/**
+ * @brief 对照一：最初的写法，每次按反馈ID判断控制帧和字节偏移
+ */
+__attribute__((noinline)) static void Legacy_FillData(Motor_t *m, int32_t out)
+{
+    m->treatedData.motor_output = out;
+    m->treatedData.motor_output = LIMIT(m->treatedData.motor_output, -m->param.current_limit, m->param.current_limit);
+
+    uint8_t can_idx = (m->param.can_number == CAN2) ? 1 : 0;
+    uint16_t id     = m->param.can_id;
+    int16_t val     = (int16_t)m->treatedData.motor_output;
+    int buf_idx = -1;
+    int offset  = 0;
+
+    if (id >= 0x201 && id <= 0x204) {
+        buf_idx = 1;
+        offset  = (id - 0x201) * 2;
+    }
+    else if (id >= 0x205 && id <= 0x208) {
+        buf_idx = 0;
+        offset  = (id - 0x205) * 2;
+    }
+    else if (id >= 0x209 && id <= 0x20B) {
+        buf_idx = 2;
+        offset  = (id - 0x209) * 2;
+    }
+
+    if (buf_idx >= 0) {
+        legacyBuffer[can_idx][buf_idx].data[offset]     = (val >> 8) & 0xFF;
+        legacyBuffer[can_idx][buf_idx].data[offset + 1] = val & 0xFF;
+    }
+}
+
+/**
+ * @brief 对照二：按操作表写入，每次判断控制帧是否存在并由槽位计算偏移
+ */
+static void Slot_Encode(uint8_t *data, uint8_t slot, int16_t out)
+{
+    data[slot * 2]     = (out >> 8) & 0xFF;
+    data[slot * 2 + 1] = out & 0xFF;
+}
+
+static void (*volatile slotEncode)(uint8_t *data, uint8_t slot, int16_t out) = Slot_Encode;
+
+__attribute__((noinline)) static void Slot_FillData(Motor_t *m, int32_t out)
+{
+    m->treatedData.motor_output = Monitor_IsOffline(&m->monitor) ? 0 : out;
+    m->treatedData.motor_output = LIMIT(m->treatedData.motor_output, -m->param.current_limit, m->param.current_limit);
+
+    MotorTxGroup_t *group = m->txGroup;
+    if (group != NULL) {
+        slotEncode(group->buffer.data, m->tx_slot, (int16_t)m->treatedData.motor_output);
+        group->dirty = 1;
+    }
+}
+
+/**
+ * @brief 对照三：当前写法去掉离线判断，只限幅和写入
+ */
+__attribute__((noinline)) static void Bound_FillDataNoOffline(Motor_t *m, int32_t out)
+{
+    out = LIMIT(out, m->out_min, m->out_max);
+    m->treatedData.motor_output = out;
+
+    uint16_t field = (uint16_t)(out + m->tx_bias);
+    *m->tx_hi    = (uint8_t)(field >> 8);
+    *m->tx_lo    = (uint8_t)field;
+    *m->tx_dirty = 1;
+}
+
+static double Bench_Run(const char *name, void (*fill)(Motor_t *, int32_t), uint32_t rounds)
+{
+    uint64_t best = UINT64_MAX;
+
+    /* 分段计时取最小值，排除中断和调度的干扰 */
+    for (uint32_t r = 0; r < rounds; r += OUTPUT_NUM)
+    {
+        uint64_t t0 = Bench_Clock();
+        for (uint32_t k = 0; k < OUTPUT_NUM; k++)
+            for (uint32_t i = 0; i < MOTOR_NUM; i++)
+                fill(&motor[i], output[(k + i) & (OUTPUT_NUM - 1U)]);
+        uint64_t t = Bench_Clock() - t0;
+        if (t < best) best = t;
+    }
+
+    double perCall = (double)best / (OUTPUT_NUM * MOTOR_NUM);
+    printf("%-32s %6.2f %s/call\n", name, perCall, BENCH_UNIT);
+    return perCall;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t rounds = 1U << 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': rounds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-n rounds]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (rounds < OUTPUT_NUM)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    Sim_Init();
+    Motor_DriverInit();
+    srand(1);
+    for (uint32_t k = 0; k < OUTPUT_NUM; k++) output[k] = rand() % 40001 - 20000;
+    for (uint32_t i = 0; i < MOTOR_NUM; i++)
+    {
+        MotorInit(&motor[i], 0, Motor3508, 19, CAN1, motorId[i]);
+        motor[i].monitor.state = MONITOR_ONLINE; // 按在线电机计时，限幅和写入都会执行
+    }
+
+    printf("%u motors x %u rounds\n", MOTOR_NUM, rounds);
+    double legacy = Bench_Run("if-ladder on can_id", Legacy_FillData, rounds);
+    double slot   = Bench_Run("ops table, slot lookup", Slot_FillData, rounds);
+    double bare   = Bench_Run("bound slot, no offline test", Bound_FillDataNoOffline, rounds);
+    double bound  = Bench_Run("bound slot (MotorFillData)", MotorFillData, rounds);
+    printf("bound slot vs if-ladder: %.2fx, vs slot lookup: %.2fx, offline test %+.2f %s/call\n", legacy / bound,
+           slot / bound, bound - bare, BENCH_UNIT);
+
+    /* 最初的写法与当前写法写出的控制帧应一致 */
+    for (uint32_t i = 0; i < MOTOR_NUM; i++)
+    {
+        Legacy_FillData(&motor[i], output[i]);
+        MotorFillData(&motor[i], output[i]);
+    }
+    const uint16_t txId[LEGACY_GROUP_NUM] = {0x1FF, 0x200, 0x2FF};
+    for (uint32_t g = 0; g < LEGACY_GROUP_NUM; g++)
+    {
+        const MotorTxGroup_t *group = MotorTxGroupGet(CAN1, txId[g]);
+        for (uint32_t b = 0; b < 8U; b++)
+            if (group->buffer.data[b] != legacyBuffer[0][g].data[b])
+            {
+                printf("mismatch in 0x%03X at byte %u\n", txId[g], b);
+                return 1;
+            }
+    }
+    return 0;
+}
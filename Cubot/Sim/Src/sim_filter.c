@@ -0,0 +1,169 @@
+/**
+ **********************************************************************************
+ * @file        sim_filter.c
+ * @brief       仿真层，转速估计器基准
+ * @details     生成一段已知真实转速的电机反馈：加减速、正弦变速与匀速段，编码器按真实转速积分并量化到13位，
+ *              上报转速为真实转速加高斯噪声后取整，帧间隔带抖动并偶尔丢帧。
+ *              对每种估计方式统计每次更新的耗时（x86上为TSC周期数，其他平台为纳秒）、
+ *              全程与匀速段相对真实转速的均方根误差，以及阶跃后达到90%的时间。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * How to use：
+ * 1. ./build-sim/cubot_filter [-n 帧数] [-r 上报转速噪声标准差rpm]
+ * 2. 主机耗时只用于比较各方式的相对开销，目标板上的耗时用DWT->CYCCNT测量
+ **********************************************************************************
+ */
+#include "speed_filter.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+/* 不包含 x86intrin.h：其中的参数名与CMSIS的 __I/__O 等宏冲突 */
+#define BENCH_UNIT "cycles"
+static inline uint64_t Bench_Clock(void) { return __builtin_ia32_rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t Bench_Clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define ECD_PER_REV     8192
+#define STEP_RPM        3000.0
+#define STEP_START_S    0.2
+#define STEP_TAU_S      0.02      //< 电机转速响应时间常数
+#define SINE_START_S    1.0
+#define SINE_RPM        800.0
+#define SINE_HZ         5.0
+#define SINE_END_S      2.0
+#define STEADY_START_S  2.1       //< 正弦段结束后留出100ms，之后统计匀速段的噪声
+#define PERIOD_S        3.0       //< 转速曲线周期
+
+typedef struct
+{
+    int64_t ecd;     //< 编码器累计刻度（已量化）
+    int16_t rpm;     //< 上报转速
+    uint32_t dt;     //< 与上一帧的间隔（微秒）
+    double truth;    //< 真实转速
+    double t;        //< 时刻（秒，相对转速曲线周期）
+} Bench_Frame_t;
+
+static double Bench_Gauss(void)
+{
+    double u1 = (rand() + 1.0) / (RAND_MAX + 2.0), u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static double Bench_Truth(double t)
+{
+    if (t < STEP_START_S) return 0.0;
+    double v = STEP_RPM * (1.0 - exp(-(t - STEP_START_S) / STEP_TAU_S));
+    if (t >= SINE_START_S && t < SINE_END_S) v += SINE_RPM * sin(2.0 * M_PI * SINE_HZ * (t - SINE_START_S));
+    return v;
+}
+
+static Bench_Frame_t *Bench_Generate(uint32_t num, double noiseRpm)
+{
+    Bench_Frame_t *frame = malloc(sizeof(*frame) * num);
+    double t = 0.0, pos = 0.0;
+
+    for (uint32_t i = 0; i < num; i++)
+    {
+        /* 1ms ± 20us，约千分之五的帧丢失 */
+        uint32_t dt = (i == 0U) ? 0U : 1000U + (uint32_t)(rand() % 41) - 20U;
+        if (i > 0U && rand() % 200 == 0) dt += 1000U;
+        t += dt * 1e-6;
+
+        double phase = fmod(t, PERIOD_S);
+        double v     = Bench_Truth(phase);
+        pos += v / 60.0 * ECD_PER_REV * dt * 1e-6;
+
+        frame[i].ecd   = (int64_t)floor(pos);
+        frame[i].rpm   = (int16_t)lrint(v + noiseRpm * Bench_Gauss());
+        frame[i].dt    = dt;
+        frame[i].truth = v;
+        frame[i].t     = phase;
+    }
+    return frame;
+}
+
+static void Bench_Run(const char *name, SpeedFilter_t *filter, const Bench_Frame_t *frame, uint32_t num)
+{
+    static float out[1 << 22];
+    double errAll = 0.0, errSteady = 0.0, rise = -1.0;
+    uint32_t nSteady = 0;
+
+    /* 计时只包含更新本身，结果存入数组避免被优化掉 */
+    uint64_t t0 = Bench_Clock();
+    for (uint32_t i = 0; i < num; i++)
+        out[i] = SpeedFilter_Update(filter, frame[i].ecd, frame[i].rpm, frame[i].dt);
+    uint64_t t1 = Bench_Clock();
+
+    for (uint32_t i = 0; i < num; i++)
+    {
+        double e = out[i] - frame[i].truth;
+        errAll += e * e;
+        if (frame[i].t >= STEADY_START_S) { errSteady += e * e; nSteady++; }
+        /* 第一个周期里阶跃后首次达到90% */
+        if (rise < 0.0 && frame[i].t >= STEP_START_S && out[i] >= 0.9 * STEP_RPM && i < num / 2U)
+            rise = (frame[i].t - STEP_START_S) * 1e3;
+    }
+
+    printf("%-28s %6.1f %s/update  rms %6.2f rpm  steady rms %6.2f rpm  90%% rise %5.1f ms\n", name,
+           (double)(t1 - t0) / num, BENCH_UNIT, sqrt(errAll / num), nSteady ? sqrt(errSteady / nSteady) : 0.0, rise);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t num = 600000;
+    double noise = 10.0;
+    int opt;
+    SpeedFilter_t filter;
+
+    while ((opt = getopt(argc, argv, "n:r:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': num = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': noise = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n frames] [-r rpm noise]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (num < 2U * (uint32_t)(PERIOD_S * 1000.0) || num > (1U << 22) || noise < 0.0)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    srand(1);
+    Bench_Frame_t *frame = Bench_Generate(num, noise);
+    printf("%u frames, reported rpm noise %.1f rpm (1 sigma)\n", num, noise);
+
+    SpeedFilter_t none = {0};
+    Bench_Run("none (reported rpm)", &none, frame, num);
+    SpeedFilter_InitMA(&filter, 4);
+    Bench_Run("moving average 4", &filter, frame, num);
+    SpeedFilter_InitMA(&filter, 16);
+    Bench_Run("moving average 16", &filter, frame, num);
+    SpeedFilter_InitIIR(&filter, 2.0f);
+    Bench_Run("IIR tau 2 ms", &filter, frame, num);
+    SpeedFilter_InitIIR(&filter, 8.0f);
+    Bench_Run("IIR tau 8 ms", &filter, frame, num);
+    SpeedFilter_InitKalman(&filter, ECD_PER_REV, 1.0e5f, 1.0f, (float)(noise * noise));
+    Bench_Run("Kalman q 1e5", &filter, frame, num);
+    SpeedFilter_InitKalman(&filter, ECD_PER_REV, 1.0e6f, 1.0f, (float)(noise * noise));
+    Bench_Run("Kalman q 1e6", &filter, frame, num);
+
+    free(frame);
+    return 0;
+}
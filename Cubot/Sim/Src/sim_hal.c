@@ -0,0 +1,82 @@
+/**
+ **********************************************************************************
+ * @file        sim_hal.c
+ * @brief       仿真层，时钟、GPIO、NVIC 等 HAL 接口和寄存器镜像
+ * @details     时钟频率与 CubeMX 配置一致（APB1 120MHz 且二分频，FDCAN 内核时钟 120MHz），
+ *              Timebase_Init() 和 CAN_Open() 按同样的公式得到 1MHz 时基和位时间。
+ *              GPIO 和 NVIC 配置在仿真中没有意义，只接受调用；读取输入引脚总是返回高电平（开关未按下）。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ */
+#include "sim.h"
+#include "main.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SIM_PCLK1_HZ     120000000U
+#define SIM_FDCAN_CLK_HZ 120000000U
+
+TIM_TypeDef simTim2Reg;
+RCC_TypeDef simRccReg = {.D2CFGR = RCC_D2CFGR_D2PPRE1_DIV2};
+DWT_Type simDwtReg;
+CoreDebug_Type simCoreDebugReg;
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return SIM_PCLK1_HZ;
+}
+
+uint32_t HAL_RCCEx_GetPeriphCLKFreq(uint64_t PeriphClk)
+{
+    return (PeriphClk == RCC_PERIPHCLK_FDCAN) ? SIM_FDCAN_CLK_HZ : 0U;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit)
+{
+    (void)PeriphClkInit;
+    return HAL_OK;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    (void)GPIOx;
+    (void)GPIO_Init;
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+    (void)GPIOx;
+    (void)GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    (void)GPIOx;
+    (void)GPIO_Pin;
+    return GPIO_PIN_SET;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    (void)IRQn;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    (void)IRQn;
+}
+
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler() called\n");
+    exit(1);
+}
@@ -0,0 +1,33 @@
+/**
+ **********************************************************************************
+ * @file        sim_it.c
+ * @brief       仿真层，FDCAN 中断向量
+ * @details     与 Core/Src/stm32h7xx_it.c 中 FDCANx_ITy_IRQHandler() 的用户代码保持一致，
+ *              由 sim_fdcan.c 在中断标志置位时调用。修改固件中断入口时须同步修改此文件。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ */
+#include "stm32h7xx_it.h"
+#include "driver_can.h"
+
+void FDCAN1_IT0_IRQHandler(void)
+{
+    CAN_IT0_IRQHandler(&can1);
+}
+
+void FDCAN2_IT0_IRQHandler(void)
+{
+    CAN_IT0_IRQHandler(&can2);
+}
+
+void FDCAN1_IT1_IRQHandler(void)
+{
+    CAN_IT1_IRQHandler(&can1);
+}
+
+void FDCAN2_IT1_IRQHandler(void)
+{
+    CAN_IT1_IRQHandler(&can2);
+}
@@ -0,0 +1,119 @@
+/**
+ **********************************************************************************
+ * @file        sim_motor.c
+ * @brief       仿真层，大疆电机（M3508/GM6020/M2006）电调
+ * @details     反馈ID 0x201-0x204 对应控制帧0x200，0x205-0x208 对应0x1FF，0x209-0x20B 对应0x2FF，
+ *              每个控制值占两字节大端。反馈帧：编码器（2字节）、转速rpm（2字节）、转矩电流（2字节）、温度（1字节）。
+ *              电调之间的反馈时刻按ID错开，与实际电调互不同步的情况一致。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ */
+#include "sim_motor.h"
+#include <string.h>
+
+#define SIM_MOTOR_ECD_RANGE   8192.0f
+#define SIM_MOTOR_CMD_FULL    16384.0f
+#define SIM_MOTOR_AMBIENT     25.0f
+#define SIM_MOTOR_PHASE_NS    37000ULL //< 相邻ID电调的反馈相位差
+
+static uint8_t SimMotor_PeekTx(Sim_Node_t *node, Sim_Frame_t *frame)
+{
+    Sim_Motor_t *motor = node->ctx;
+
+    if (!motor->pending) return 0;
+    *frame = motor->feedback;
+    return 1;
+}
+
+/* 电调自动重发仲裁失败的帧 */
+static void SimMotor_TxDone(Sim_Node_t *node, uint8_t won)
+{
+    Sim_Motor_t *motor = node->ctx;
+
+    if (!won) return;
+    motor->pending = 0;
+    motor->feedback_cnt++;
+}
+
+static void SimMotor_Rx(Sim_Node_t *node, const Sim_Frame_t *frame, uint64_t sofNs)
+{
+    Sim_Motor_t *motor = node->ctx;
+    (void)sofNs;
+
+    if (frame->id != motor->command_id || (frame->flags & (SIM_FRAME_FLAG_EXT | SIM_FRAME_FLAG_FD))) return;
+    if (frame->len < (uint8_t)(motor->slot * 2U + 2U)) return;
+
+    motor->command = (int16_t)(frame->data[motor->slot * 2U] << 8 | frame->data[motor->slot * 2U + 1U]);
+    motor->command_cnt++;
+}
+
+/**
+ * @brief 内部函数：推进电机模型一个反馈周期并准备反馈帧
+ */
+static void SimMotor_Tick(void *ctx)
+{
+    Sim_Motor_t *motor = ctx;
+    const float dt = 1.0f / SIM_MOTOR_FEEDBACK_HZ;
+    float target = motor->command / SIM_MOTOR_CMD_FULL * motor->max_rpm;
+
+    motor->speed_rpm   += (target - motor->speed_rpm) * dt / motor->tau_s;
+    motor->position    += motor->speed_rpm / 60.0f * SIM_MOTOR_ECD_RANGE * dt;
+    motor->position    -= SIM_MOTOR_ECD_RANGE * (float)(int32_t)(motor->position / SIM_MOTOR_ECD_RANGE);
+    if (motor->position < 0.0f) motor->position += SIM_MOTOR_ECD_RANGE;
+    motor->temperature += (motor->command * motor->command / (SIM_MOTOR_CMD_FULL * SIM_MOTOR_CMD_FULL) * 0.5f
+                           - (motor->temperature - SIM_MOTOR_AMBIENT) * 0.002f) * dt;
+
+    uint16_t ecd  = (uint16_t)motor->position & 0x1FFFU;
+    int16_t speed = (int16_t)motor->speed_rpm;
+    int16_t cur   = motor->command;
+
+    if (motor->pending) motor->overrun_cnt++;
+
+    motor->feedback.id      = motor->feedback_id;
+    motor->feedback.flags   = 0;
+    motor->feedback.len     = 8;
+    motor->feedback.data[0] = (uint8_t)(ecd >> 8);
+    motor->feedback.data[1] = (uint8_t)ecd;
+    motor->feedback.data[2] = (uint8_t)((uint16_t)speed >> 8);
+    motor->feedback.data[3] = (uint8_t)speed;
+    motor->feedback.data[4] = (uint8_t)((uint16_t)cur >> 8);
+    motor->feedback.data[5] = (uint8_t)cur;
+    motor->feedback.data[6] = (uint8_t)motor->temperature;
+    motor->feedback.data[7] = 0;
+    motor->pending = 1;
+}
+
+/**
+ * @brief 创建仿真电机并挂到总线上
+ * @param motor: 电机
+ * @param bus: 总线编号
+ * @param feedbackId: 反馈帧ID，0x201-0x20B
+ * @retval 0表示成功，1表示ID无效
+ */
+uint8_t SimMotor_Init(Sim_Motor_t *motor, uint8_t bus, uint16_t feedbackId)
+{
+    if (feedbackId < 0x201U || feedbackId > 0x20BU) return 1;
+
+    memset(motor, 0, sizeof(*motor));
+    motor->feedback_id = feedbackId;
+    if (feedbackId <= 0x204U)      { motor->command_id = 0x200; motor->slot = (uint8_t)(feedbackId - 0x201U); }
+    else if (feedbackId <= 0x208U) { motor->command_id = 0x1FF; motor->slot = (uint8_t)(feedbackId - 0x205U); }
+    else                           { motor->command_id = 0x2FF; motor->slot = (uint8_t)(feedbackId - 0x209U); }
+
+    motor->max_rpm     = 9000.0f;
+    motor->tau_s       = 0.05f;
+    motor->temperature = SIM_MOTOR_AMBIENT;
+    motor->position    = (float)((feedbackId * 1237U) % 8192U);
+
+    motor->node.PeekTx = SimMotor_PeekTx;
+    motor->node.TxDone = SimMotor_TxDone;
+    motor->node.Rx     = SimMotor_Rx;
+    motor->node.ctx    = motor;
+    SimBus_Attach(&motor->node, bus);
+
+    Sim_TimerStart(&motor->timer, Sim_NowNs() + (feedbackId - 0x200U) * SIM_MOTOR_PHASE_NS,
+                   1000000000ULL / SIM_MOTOR_FEEDBACK_HZ, SimMotor_Tick, motor);
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ **********************************************************************************
+ * @file        sim_pid.c
+ * @brief       仿真层，PID组与单环PID的一致性检查和耗时基准
+ * @details     一组单环PID（3个摩擦轮、拨弹盘、4个底盘轮、2个云台轴）分别用 One_Pid_Ctrl() 逐个计算和
+ *              加入 PIDBank_t 后用 PIDBank_Update() 一次计算，输入为随机的目标和反馈，
+ *              参数覆盖积分分离、各部分限幅饱和、上下限颠倒、零增益，输入偶尔为NaN和负零。
+ *              定期用 PIDBank_Reset() 和清零单环PID的状态清除积分，每一步逐位比较两者的输出、积分累加值和上次误差，
+ *              并统计每个PID的平均耗时（x86上为TSC周期数，其他平台为纳秒）。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * How to use：
+ * 1. ./build-sim/cubot_pid [-n 步数]
+ * 2. 任一步结果不一致时输出该步和PID下标并返回非零值
+ * 3. 目标板上在DEBUG构建中由Init_Task调用PIDBank_Benchmark()用DWT->CYCCNT测量，结果在 pidBankBench 中
+ **********************************************************************************
+ */
+#include "pid.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+/* 不包含 x86intrin.h：其中的参数名与CMSIS的 __I/__O 等宏冲突 */
+#define BENCH_UNIT "cycles"
+static inline uint64_t Bench_Clock(void) { return __builtin_ia32_rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t Bench_Clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define PID_NUM     10U
+#define RESET_STEPS 1000U //< 每隔该步数清除全部积分，NaN输入进入积分后不会一直停留在NaN
+
+static SinglePID_t pid[PID_NUM];
+static PIDBank_t bank;
+
+static float Bench_Rand(float range)
+{
+    return ((float)rand() / (float)RAND_MAX * 2.0f - 1.0f) * range;
+}
+
+/**
+ * @brief 随机输入，约十万分之一为NaN、千分之一为负零
+ */
+static float Bench_Input(float range)
+{
+    int r = rand() % 100000;
+    if (r == 0) return NAN;
+    if (r <= 100) return -0.0f;
+    return Bench_Rand(range);
+}
+
+static uint8_t Bench_Same(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t steps = 1000000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': steps = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-n steps]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (steps == 0U)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    srand(1);
+    for (uint32_t k = 0; k < PID_NUM; k++)
+    {
+        BasePID_Init(&pid[k], 5.0f + Bench_Rand(5.0f), 0.2f + Bench_Rand(0.2f), Bench_Rand(2.0f),
+                     8000.0f + Bench_Rand(8000.0f), 3000.0f + Bench_Rand(3000.0f), 2000.0f + Bench_Rand(2000.0f),
+                     (k % 3U == 0U) ? 5.0f : 0.0f, (k % 2U == 0U) ? 500.0f : 1.0e9f, 12000.0f + Bench_Rand(4000.0f));
+    }
+    pid[7].D         = 0.0f;     // 零增益
+    pid[8].max_limit = -3000.0f; // 上下限颠倒，LIMIT宏的结果取决于比较顺序
+    for (uint32_t k = 0; k < PID_NUM; k++)
+        if (PIDBank_Add(&bank, &pid[k]))
+        {
+            fprintf(stderr, "PIDBank_Add failed\n");
+            return 2;
+        }
+
+    float target[PID_NUM], feedback[PID_NUM];
+    uint64_t scalarClock = 0, bankClock = 0;
+    for (uint32_t s = 0; s < steps; s++)
+    {
+        if (s % RESET_STEPS == RESET_STEPS - 1U)
+            for (uint8_t k = 0; k < PID_NUM; k++)
+            {
+                PIDBank_Reset(&bank, k);
+                pid[k].i_delta_sum = 0.0f;
+                pid[k].delta_last  = 0.0f;
+                pid[k].out         = 0.0f;
+            }
+        for (uint32_t k = 0; k < PID_NUM; k++)
+        {
+            target[k]   = Bench_Input(3000.0f);
+            feedback[k] = Bench_Input(3000.0f);
+        }
+
+        uint64_t t0 = Bench_Clock();
+        for (uint32_t k = 0; k < PID_NUM; k++) One_Pid_Ctrl(target[k], feedback[k], &pid[k]);
+        uint64_t t1 = Bench_Clock();
+        PIDBank_Update(&bank, target, feedback);
+        uint64_t t2 = Bench_Clock();
+        scalarClock += t1 - t0;
+        bankClock   += t2 - t1;
+
+        for (uint32_t k = 0; k < PID_NUM; k++)
+            if (!Bench_Same(pid[k].out, bank.out[k]) || !Bench_Same(pid[k].i_delta_sum, bank.i_delta_sum[k])
+                || !Bench_Same(pid[k].delta_last, bank.delta_last[k]))
+            {
+                printf("mismatch at step %u pid %u: out %.9g/%.9g, i_sum %.9g/%.9g\n", s, k, pid[k].out, bank.out[k],
+                       pid[k].i_delta_sum, bank.i_delta_sum[k]);
+                return 1;
+            }
+    }
+
+    double perScalar = (double)scalarClock / ((double)steps * PID_NUM);
+    double perBank   = (double)bankClock / ((double)steps * PID_NUM);
+    printf("%u PIDs x %u steps, outputs and state bit-identical\n", PID_NUM, steps);
+    printf("One_Pid_Ctrl   %6.2f %s/pid\n", perScalar, BENCH_UNIT);
+    printf("PIDBank_Update %6.2f %s/pid (%.2fx)\n", perBank, BENCH_UNIT, perScalar / perBank);
+    return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ **********************************************************************************
+ * @file        sim_power.c
+ * @brief       仿真层，底盘功率控制检查
+ * @details     四个M3508底盘轮按速度环跟踪一段加减速、平移、自旋的目标转速，功率上限中途由60W升到100W。
+ *              仿真功率计用与控制器不同的“真实”电机参数（铜损、转速损耗和静态功率均偏大）计算底盘电功率，
+ *              裁判系统按功率超出上限的部分扣减缓冲能量（上限60J），以50Hz取整后发给控制器。
+ *              对比不限功率、按上限固定限制（不用缓冲能量）和按缓冲能量分配三种方式的
+ *              缓冲能量耗尽时间（扣血）、平均功率和转速跟踪误差，以及每次PowerLimit_Apply()的耗时。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * How to use：
+ * 1. ./build-sim/cubot_power [-t 秒] [-e 模型误差比例]
+ * 2. 按缓冲能量分配的方式出现缓冲能量耗尽，或固定限制未耗尽缓冲能量而按缓冲能量分配的跟踪误差不小于它时返回非零值
+ **********************************************************************************
+ */
+#include "power_limit.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+/* 不包含 x86intrin.h：其中的参数名与CMSIS的 __I/__O 等宏冲突 */
+#define BENCH_UNIT "cycles"
+static inline uint64_t Bench_Clock(void) { return __builtin_ia32_rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t Bench_Clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define WHEEL_NUM        4U
+#define CTRL_DT_S        0.001f    //< 控制周期
+#define REFEREE_PERIOD   20U       //< 裁判系统功率热量数据周期（控制周期数），50Hz
+#define BUFFER_MAX_J     60.0      //< 缓冲能量上限
+#define CURRENT_MAX      16384.0f  //< 控制量满量程
+#define ACCEL_PER_UNIT   1.0       //< 每单位净电流的转子加速度（rpm/s），含整车惯量
+#define DRAG_PER_RPM     0.15      //< 摩擦和滚阻折算的电流（控制量/rpm）
+#define SPEED_KP         12.0f     //< 速度环比例系数
+#define PROFILE_STEP_S   1.5       //< 每段目标转速的持续时间
+
+/**
+ * @brief 一种限制方式的运行结果
+ */
+typedef struct
+{
+    double empty_ms;     //< 缓冲能量耗尽且仍超功率的时间（ms），裁判系统按此扣血
+    double buffer_min;   //< 最低缓冲能量（J）
+    double power_avg;    //< 平均实际功率（W）
+    double limit_avg;    //< 平均功率上限（W）
+    double err_rms;      //< 转速跟踪均方根误差（rpm）
+    double apply_clock;  //< 每次PowerLimit_Apply()的耗时
+} Bench_Result_t;
+
+/**
+ * @brief 目标转速：麦轮底盘依次静止、前进、自旋、斜移、后退，四个轮的符号按麦轮安装方向
+ */
+static void Bench_Target(double t, float *target)
+{
+    static const float profile[][WHEEL_NUM] = {
+        {0, 0, 0, 0},
+        {7000, 7000, -7000, -7000},
+        {5000, 5000, 5000, 5000},
+        {8000, 0, 0, -8000},
+        {-7000, -7000, 7000, 7000},
+        {0, 0, 0, 0},
+        {6000, -6000, -6000, 6000},
+        {-5000, -5000, -5000, -5000},
+    };
+    uint32_t n   = sizeof(profile) / sizeof(profile[0]);
+    uint32_t seg = (uint32_t)(t / PROFILE_STEP_S) % n;
+    for (uint32_t i = 0; i < WHEEL_NUM; i++) target[i] = profile[seg][i];
+}
+
+/**
+ * @brief 仿真功率计：实际底盘电功率，参数为控制器模型乘以误差比例
+ */
+static double Bench_PowerMeter(const PowerLimit_Config_t *model, double err, const float *current, const double *rpm)
+{
+    double p = model->p_static * (1.0 + err);
+
+    for (uint32_t i = 0; i < WHEEL_NUM; i++)
+        p += fmax(model->k_mech * current[i] * rpm[i], 0.0) + model->k_copper * (1.0 + err) * current[i] * current[i]
+             + model->k_iron * (1.0 + 2.0 * err) * rpm[i] * rpm[i];
+    return p;
+}
+
+static Bench_Result_t Bench_Run(const char *name, const PowerLimit_Config_t *config, double seconds, double err)
+{
+    PowerLimit_t power;
+    Bench_Result_t res = {.buffer_min = BUFFER_MAX_J};
+    double rpm[WHEEL_NUM] = {0};
+    double buffer = BUFFER_MAX_J, powerSum = 0.0, limitSum = 0.0, errSum = 0.0;
+    uint64_t clockSum = 0;
+    uint32_t steps = (uint32_t)(seconds / CTRL_DT_S);
+
+    PowerLimit_Init(&power, &POWER_LIMIT_CONFIG_3508);
+    if (config != NULL) power.config = *config;
+
+    for (uint32_t k = 0; k < steps; k++)
+    {
+        double t     = k * CTRL_DT_S;
+        uint16_t lim = (t < seconds / 2.0) ? 60U : 100U; // 中途升级，功率上限提高
+
+        // 裁判系统50Hz发送功率上限和取整后的缓冲能量
+        if (k % REFEREE_PERIOD == 0U) PowerLimit_SetReferee(&power, lim, (uint16_t)buffer);
+
+        float target[WHEEL_NUM], current[WHEEL_NUM], speed[WHEEL_NUM];
+        Bench_Target(t, target);
+        for (uint32_t i = 0; i < WHEEL_NUM; i++)
+        {
+            float e    = target[i] - (float)rpm[i];
+            current[i] = fminf(fmaxf(SPEED_KP * e + (float)DRAG_PER_RPM * target[i], -CURRENT_MAX), CURRENT_MAX);
+            speed[i]   = (float)rpm[i];
+            errSum    += (double)e * e;
+        }
+
+        if (config != NULL)
+        {
+            uint64_t c0 = Bench_Clock();
+            PowerLimit_Apply(&power, current, speed, WHEEL_NUM, CTRL_DT_S);
+            clockSum += Bench_Clock() - c0;
+        }
+
+        // 实际功率按缓冲能量结算，超功率时扣减，低于上限时回充
+        double p = Bench_PowerMeter(&POWER_LIMIT_CONFIG_3508, err, current, rpm);
+        buffer  -= (p - lim) * CTRL_DT_S;
+        if (buffer > BUFFER_MAX_J) buffer = BUFFER_MAX_J;
+        if (buffer <= 0.0)
+        {
+            buffer = 0.0;
+            if (p > lim) res.empty_ms += CTRL_DT_S * 1e3;
+        }
+        if (buffer < res.buffer_min) res.buffer_min = buffer;
+        powerSum += p;
+        limitSum += lim;
+
+        for (uint32_t i = 0; i < WHEEL_NUM; i++)
+            rpm[i] += (current[i] - DRAG_PER_RPM * rpm[i]) * ACCEL_PER_UNIT * CTRL_DT_S;
+    }
+
+    res.power_avg   = powerSum / steps;
+    res.limit_avg   = limitSum / steps;
+    res.err_rms     = sqrt(errSum / (steps * WHEEL_NUM));
+    res.apply_clock = (double)clockSum / steps;
+    printf("%-22s empty %7.0f ms  buffer min %5.1f J  power avg %6.1f W (limit %5.1f)  speed rms err %6.0f rpm",
+           name, res.empty_ms, res.buffer_min, res.power_avg, res.limit_avg, res.err_rms);
+    if (config != NULL) printf("  %5.1f %s/apply", res.apply_clock, BENCH_UNIT);
+    printf("\n");
+    return res;
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 24.0, err = 0.15;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:e:")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': seconds = atof(optarg); break;
+            case 'e': err = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-t seconds] [-e model error]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (seconds < 2.0 * PROFILE_STEP_S || err < -0.5 || err > 1.0)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    // 固定限制：允许功率始终等于上限，不使用缓冲能量
+    PowerLimit_Config_t capped = POWER_LIMIT_CONFIG_3508;
+    capped.buffer_reserve = 0.0f;
+    capped.buffer_spend_s = 1.0e9f;
+    capped.boost_max      = 0.0f;
+    capped.trim_gain      = 0.0f;
+
+    printf("%.1f s, 4 x M3508, limit 60 W -> 100 W, power meter model error %+.0f%%\n", seconds, err * 100.0);
+    Bench_Run("unlimited", NULL, seconds, err);
+    Bench_Result_t cap = Bench_Run("fixed cap at limit", &capped, seconds, err);
+    Bench_Result_t buf = Bench_Run("buffer-aware", &POWER_LIMIT_CONFIG_3508, seconds, err);
+
+    if (buf.empty_ms > 0.0)
+    {
+        printf("FAIL: buffer energy exhausted with power control\n");
+        return 1;
+    }
+    // 固定限制耗尽缓冲能量时已被扣血，跟踪误差不可比
+    if (cap.empty_ms == 0.0 && buf.err_rms >= cap.err_rms)
+    {
+        printf("FAIL: buffer energy did not improve speed tracking\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,477 @@
+/**
+ **********************************************************************************
+ * @file        sim_replay.c
+ * @brief       仿真层，CAN记录回放工具
+ * @details     读取 driver_can_rec.c 导出的记录，按原始时间间隔把每一帧重新放到虚拟总线上，
+ *              经 FDCAN 接收中断、接收环形缓冲区、CAN任务和 CAN_Dispatch() 送进 MotorProcess()，
+ *              与机器人上的处理路径一致。本机发出的帧同样放回总线，保持原始的总线占用。
+ *              仿真时间与原始时间一一对应，回放结果与运行速度无关，可反复复现。
+ *              加 -c 时同时运行固件的控制任务：ShootInit() 注册发射机构电机，Shoot_Task 和 Control_Task 的循环体
+ *              ShootStep()/ControlStep() 与机器人上一样由控制周期协调器在反馈到齐（或超时）时唤醒，
+ *              按 Shoot_Task 在前、Control_Task 在后的顺序运行，发出的控制帧代替记录中的本机发送帧。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ * @attention
+ * How to use：
+ * 1. 机器人上记录器冻结后，CanRecTask_Process() 从 USART6 导出，主机端保存串口数据，
+ *    如 stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > match.crec
+ * 2. ./build-sim/cubot_replay [-x 倍速] [-o motor.csv] [-R] [-c] [-m 总线:ID:类型:减速比]... match.crec
+ *    -x 按原始速度的倍数回放，1为原速，默认0（尽快运行）
+ *    -o 每帧电机反馈解算后的数据写入CSV，含当时的控制量
+ *    -R 只回放接收帧，不把本机发出的帧放回总线
+ *    -c 运行 ShootStep()/ControlStep() 复现控制过程，隐含 -R；发射机构电机按 ShootInit() 注册，-m 不能再指定这些ID
+ *    -m 指定电机类型和减速比，如 -m 1:0x205:6020:1；未指定时0x201-0x204按3508（19:1），其余按6020（1:1）
+ * 3. 输出每帧接收路径的CPU耗时和各电机的回放帧数，加 -c 时另输出控制周期数和发出的控制帧数
+ * 4. 固件默认不编译记录器，采集前以 cmake -DCAN_REC=ON 配置固件
+ **********************************************************************************
+ */
+#include "sim.h"
+#include "driver_can.h"
+#include "driver_can_tp.h"
+#include "driver_can_rec.h"
+#include "driver_timebase.h"
+#include "driver_monitor.h"
+#include "rm_motor.h"
+#include "motor_cycle.h"
+#include "shoot_task.h"
+#include "control_task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define REPLAY_MOTOR_ID_MIN 0x201U
+#define REPLAY_MOTOR_ID_NUM 11U
+#define REPLAY_START_NS     1000000ULL //< 第一帧的仿真时刻，留出初始化时间
+
+/**
+ * @brief 待回放的一帧
+ */
+typedef struct
+{
+    uint64_t t_ns;     //< 仿真时刻
+    uint8_t bus;       //< 0：CAN1，1：CAN2
+    uint8_t rec_flags; //< CAN_REC_FLAG_x
+    Sim_Frame_t frame;
+} Replay_Frame_t;
+
+/**
+ * @brief 每条总线一个回放节点，按时间顺序依次发出该总线上的帧
+ */
+typedef struct
+{
+    Sim_Node_t node;
+    Sim_Timer_t wake;
+    uint8_t bus;
+    uint32_t next;  //< 下一帧在 replayFrame 中的下标
+    uint32_t sent;
+} Replay_Node_t;
+
+static Replay_Frame_t *replayFrame;
+static uint32_t replayFrameNum;
+static Replay_Node_t replayNode[SIM_BUS_NUM];
+static uint32_t replayTs0;   //< 第一帧的原始时间戳
+
+static Motor_t motor[SIM_BUS_NUM][REPLAY_MOTOR_ID_NUM];
+static Motor_t *motorAt[SIM_BUS_NUM][REPLAY_MOTOR_ID_NUM]; //< 各反馈ID对应的电机，-c 时发射机构电机指向 heroShoot
+static uint32_t motorFrames[SIM_BUS_NUM][REPLAY_MOTOR_ID_NUM];
+static FILE *csv;
+static uint64_t taskNs;
+
+static const CAN_FilterConfig_t replayFilter[] = {
+    {FDCAN_FILTER_RANGE, 0x201, 0x20B, FDCAN_FILTER_TO_RXFIFO0},
+};
+
+/**
+ * @brief 内部函数：找到该总线上从 from 开始的下一帧
+ */
+static uint32_t Replay_NextOnBus(uint8_t bus, uint32_t from)
+{
+    while (from < replayFrameNum && replayFrame[from].bus != bus) from++;
+    return from;
+}
+
+static void Replay_Wake(void *ctx)
+{
+    (void)ctx;
+}
+
+static uint8_t Replay_PeekTx(Sim_Node_t *node, Sim_Frame_t *frame)
+{
+    Replay_Node_t *rn = node->ctx;
+
+    if (rn->next >= replayFrameNum || replayFrame[rn->next].t_ns > Sim_NowNs()) return 0;
+    *frame = replayFrame[rn->next].frame;
+    return 1;
+}
+
+/* 记录中的帧都已在总线上成功发出，仲裁失败时原样重发 */
+static void Replay_TxDone(Sim_Node_t *node, uint8_t won)
+{
+    Replay_Node_t *rn = node->ctx;
+
+    if (!won) return;
+    rn->sent++;
+    rn->next = Replay_NextOnBus(rn->bus, rn->next + 1U);
+    if (rn->next < replayFrameNum && replayFrame[rn->next].t_ns > Sim_NowNs())
+        Sim_TimerStart(&rn->wake, replayFrame[rn->next].t_ns, 0, Replay_Wake, rn);
+}
+
+/**
+ * @brief 内部函数：读取记录文件，跳过文件头之前的串口杂散数据，把分段条目拼回整帧
+ * @param skipTx: 1表示丢弃本机发出的帧
+ * @retval 0表示成功
+ */
+static uint8_t Replay_Load(const char *path, uint8_t skipTx)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) return 1;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *raw = malloc((size_t)size);
+    if (raw == NULL || fread(raw, 1, (size_t)size, f) != (size_t)size)
+    {
+        fclose(f);
+        free(raw);
+        return 1;
+    }
+    fclose(f);
+
+    CAN_RecHeader_t header;
+    long off = 0;
+    for (; off + (long)sizeof(header) <= size; off++)
+    {
+        memcpy(&header, &raw[off], sizeof(header));
+        if (header.magic == CAN_REC_MAGIC) break;
+    }
+    if (off + (long)sizeof(header) > size || header.version != CAN_REC_VERSION
+        || header.entry_size != sizeof(CAN_RecEntry_t))
+    {
+        fprintf(stderr, "%s: no CAN recorder header (version %u, entry size %zu)\n",
+                path, CAN_REC_VERSION, sizeof(CAN_RecEntry_t));
+        free(raw);
+        return 1;
+    }
+    off += (long)sizeof(header);
+
+    uint32_t avail = (uint32_t)((size - off) / (long)sizeof(CAN_RecEntry_t));
+    uint32_t num   = header.entry_num < avail ? header.entry_num : avail;
+    if (num < header.entry_num)
+        fprintf(stderr, "%s: truncated, %u of %u entries\n", path, num, header.entry_num);
+
+    replayFrame = calloc(num ? num : 1U, sizeof(Replay_Frame_t));
+    replayFrameNum = 0;
+
+    Replay_Frame_t *cur = NULL;
+    uint8_t expectSeg   = 0;
+    uint32_t prevTs     = 0;
+    uint64_t t          = REPLAY_START_NS;
+    uint8_t started     = 0;
+    int64_t elapsedUs   = 0;
+
+    for (uint32_t i = 0; i < num; i++)
+    {
+        CAN_RecEntry_t e;
+        memcpy(&e, &raw[off + (long)i * (long)sizeof(e)], sizeof(e));
+
+        if (e.seg == 0U)
+        {
+            if (cur != NULL && expectSeg * 8U < cur->frame.len) replayFrameNum--;
+            cur = NULL;
+            if (e.len > SIM_FRAME_DATA_MAX) continue;
+
+            /* 原始时间戳按有符号差值展开，容忍32位回绕；发送帧记录的是压入FIFO的时刻，
+               可能略早于前一条接收帧的帧起始时刻，回放时刻取不早于前一帧 */
+            if (!started)
+            {
+                replayTs0 = e.timestamp;
+                started   = 1;
+            }
+            elapsedUs += (int32_t)(e.timestamp - prevTs);
+            prevTs     = e.timestamp;
+            if (elapsedUs > 0 && REPLAY_START_NS + (uint64_t)elapsedUs * 1000ULL > t)
+                t = REPLAY_START_NS + (uint64_t)elapsedUs * 1000ULL;
+
+            if (skipTx && (e.flags & CAN_REC_FLAG_TX)) continue;
+
+            cur = &replayFrame[replayFrameNum++];
+            cur->t_ns        = t;
+            cur->bus         = (e.flags & CAN_REC_FLAG_CAN2) ? 1U : 0U;
+            cur->rec_flags   = e.flags;
+            cur->frame.id    = e.id;
+            cur->frame.len   = e.len;
+            cur->frame.flags = ((e.flags & CAN_REC_FLAG_EXT) ? SIM_FRAME_FLAG_EXT : 0U)
+                             | ((e.flags & CAN_REC_FLAG_FD) ? SIM_FRAME_FLAG_FD : 0U)
+                             | ((e.flags & CAN_REC_FLAG_BRS) ? SIM_FRAME_FLAG_BRS : 0U);
+            expectSeg = 0;
+        }
+        else if (cur == NULL || e.seg != expectSeg || e.id != cur->frame.id)
+        {
+            /* 读者从帧中间开始或缺段，丢弃不完整的帧 */
+            if (cur != NULL) replayFrameNum--;
+            cur = NULL;
+            continue;
+        }
+
+        memcpy(&cur->frame.data[e.seg * 8U], e.data, 8U);
+        expectSeg = (uint8_t)(e.seg + 1U);
+    }
+    if (cur != NULL && expectSeg * 8U < cur->frame.len) replayFrameNum--;
+
+    free(raw);
+    return 0;
+}
+
+/**
+ * @brief CAN任务循环体，与 can_task.c 一致，额外把电机反馈解算结果写入CSV
+ */
+static void Replay_CanTaskStep(void *arg)
+{
+    CAN_Instance_t *can = arg;
+    uint8_t bus = (can == &can2) ? 1U : 0U;
+    const CAN_RxFrame_t *frame;
+    uint64_t start = Sim_CpuNs();
+
+    while ((frame = CAN_RxPeek(can)) != NULL)
+    {
+        CAN_Dispatch(can, frame);
+
+        uint32_t idx = frame->id - REPLAY_MOTOR_ID_MIN;
+        if (idx < REPLAY_MOTOR_ID_NUM && motorAt[bus][idx] != NULL)
+        {
+            Motor_t *m = motorAt[bus][idx];
+            motorFrames[bus][idx]++;
+            if (csv != NULL)
+            {
+                fprintf(csv, "%u,%u,0x%03X,%d,%d,%d,%u,%d,%.3f,%u,%d\n",
+                        frame->timestamp - (uint32_t)(REPLAY_START_NS / 1000U) + replayTs0, bus + 1U,
+                        (unsigned)frame->id, m->rawData.raw_ecd, m->rawData.speed_rpm, m->rawData.torque_current,
+                        m->rawData.temperature, m->treatedData.angle_speed, m->treatedData.angle,
+                        m->treatedData.sample_dt_us, (int)m->treatedData.motor_output);
+            }
+        }
+
+        CAN_RxRelease(can, frame);
+    }
+    CANTP_Poll(can);
+    CAN_HealthPoll(can);
+
+    taskNs += Sim_CpuNs() - start;
+}
+
+/**
+ * @brief Shoot_Task 循环体，MotorCycle_Wait() 的等待由 SimTask 代替
+ */
+static void Replay_ShootStep(void *arg)
+{
+    ShootStep(arg);
+}
+
+/**
+ * @brief Control_Task 循环体，MotorCycle_Wait() 的等待由 SimTask 代替
+ */
+static void Replay_ControlStep(void *arg)
+{
+    (void)arg;
+    ControlStep();
+}
+
+/**
+ * @brief 内部函数：把已注册的电机登记到回放的电机表中
+ */
+static void Replay_Adopt(Motor_t *m)
+{
+    uint8_t bus  = (m->param.can_number == CAN2) ? 1U : 0U;
+    uint32_t idx = (uint32_t)m->param.can_id - REPLAY_MOTOR_ID_MIN;
+
+    if (idx < REPLAY_MOTOR_ID_NUM) motorAt[bus][idx] = m;
+}
+
+/**
+ * @brief 内部函数：解析 -m 总线:ID:类型:减速比
+ * @retval 0表示成功，1表示格式错误或该ID已注册
+ */
+static uint8_t Replay_ParseMotor(const char *arg)
+{
+    unsigned bus, id, type, ratio;
+    if (sscanf(arg, "%u:%i:%u:%u", &bus, &id, &type, &ratio) != 4) return 1;
+    if (bus < 1U || bus > SIM_BUS_NUM || id < REPLAY_MOTOR_ID_MIN || id >= REPLAY_MOTOR_ID_MIN + REPLAY_MOTOR_ID_NUM)
+        return 1;
+
+    motor_type t;
+    if (type == 3508U)      t = Motor3508;
+    else if (type == 6020U) t = Motor6020;
+    else if (type == 2006U) t = Motor2006;
+    else return 1;
+
+    Motor_t *m = &motor[bus - 1U][id - REPLAY_MOTOR_ID_MIN];
+    if (MotorInit(m, 0, t, (uint16_t)ratio, bus == 1U ? CAN1 : CAN2, (uint16_t)id)) return 1;
+    motorAt[bus - 1U][id - REPLAY_MOTOR_ID_MIN] = m;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    double scale = 0.0;
+    const char *csvPath = NULL;
+    uint8_t skipTx = 0;
+    uint8_t control = 0;
+    const char *motorArg[SIM_BUS_NUM * REPLAY_MOTOR_ID_NUM];
+    uint8_t motorArgNum = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "x:o:Rcm:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'x': scale = atof(optarg); break;
+            case 'o': csvPath = optarg; break;
+            case 'R': skipTx = 1; break;
+            case 'c': control = skipTx = 1; break;
+            case 'm':
+                if (motorArgNum < SIM_BUS_NUM * REPLAY_MOTOR_ID_NUM) motorArg[motorArgNum++] = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-x scale] [-o motor.csv] [-R] [-c] [-m bus:id:type:ratio]... capture\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind >= argc || scale < 0.0)
+    {
+        fprintf(stderr, "usage: %s [-x scale] [-o motor.csv] [-R] [-c] [-m bus:id:type:ratio]... capture\n", argv[0]);
+        return 2;
+    }
+    if (Replay_Load(argv[optind], skipTx))
+    {
+        fprintf(stderr, "cannot load %s\n", argv[optind]);
+        return 1;
+    }
+
+    Sim_Init();
+    Timebase_Init();
+    Monitor_Init();
+    MX_FDCAN1_Init();
+    MX_FDCAN2_Init();
+    CANx_Init(&hfdcan1, CAN1_rxCallBack);
+    CANx_Init(&hfdcan2, CAN2_rxCallBack);
+    if (CAN_Open(&can1, replayFilter, 1) || CAN_Open(&can2, replayFilter, 1))
+    {
+        fprintf(stderr, "CAN_Open failed\n");
+        return 1;
+    }
+    can1.rxTask = SimTask_Create(Replay_CanTaskStep, &can1, CAN_HEALTH_POLL_MS);
+    can2.rxTask = SimTask_Create(Replay_CanTaskStep, &can2, CAN_HEALTH_POLL_MS);
+    Motor_DriverInit();
+
+    /* 与 Init_Task 相同注册发射机构电机；任务按优先级顺序创建，CAN任务最先运行 */
+    if (control)
+    {
+        if (ShootInit(&heroShoot))
+        {
+            fprintf(stderr, "ShootInit failed\n");
+            return 1;
+        }
+        Replay_Adopt(&heroShoot.booster.top.m3508);
+        Replay_Adopt(&heroShoot.booster.left.m3508);
+        Replay_Adopt(&heroShoot.booster.right.m3508);
+        Replay_Adopt(&heroShoot.loader.m3508);
+        MotorCycle_Subscribe(SimTask_Create(Replay_ShootStep, &heroShoot, MOTOR_CYCLE_TIMEOUT_MS));
+        MotorCycle_Subscribe(SimTask_Create(Replay_ControlStep, NULL, MOTOR_CYCLE_TIMEOUT_MS));
+    }
+
+    for (uint8_t i = 0; i < motorArgNum; i++)
+    {
+        if (Replay_ParseMotor(motorArg[i]))
+        {
+            fprintf(stderr, "invalid motor %s, expected bus:id:type:ratio (e.g. 1:0x205:6020:1) not already registered\n",
+                    motorArg[i]);
+            return 2;
+        }
+    }
+    /* 未指定的电机按反馈ID取默认类型 */
+    for (uint32_t i = 0; i < replayFrameNum; i++)
+    {
+        const Replay_Frame_t *rf = &replayFrame[i];
+        uint32_t idx = rf->frame.id - REPLAY_MOTOR_ID_MIN;
+
+        if ((rf->rec_flags & (CAN_REC_FLAG_TX | CAN_REC_FLAG_EXT)) || idx >= REPLAY_MOTOR_ID_NUM) continue;
+        if (motorAt[rf->bus][idx] != NULL) continue;
+        MotorInit(&motor[rf->bus][idx], 0, idx < 4U ? Motor3508 : Motor6020, idx < 4U ? 19 : 1,
+                  rf->bus == 0U ? CAN1 : CAN2, (uint16_t)rf->frame.id);
+        motorAt[rf->bus][idx] = &motor[rf->bus][idx];
+    }
+
+    if (csvPath != NULL)
+    {
+        csv = fopen(csvPath, "w");
+        if (csv == NULL)
+        {
+            fprintf(stderr, "cannot open %s\n", csvPath);
+            return 1;
+        }
+        fprintf(csv, "t_us,bus,id,ecd,speed_rpm,current,temperature,angle_speed,angle,sample_dt_us,output\n");
+    }
+
+    for (uint8_t b = 0; b < SIM_BUS_NUM; b++)
+    {
+        Replay_Node_t *rn = &replayNode[b];
+        rn->bus         = b;
+        rn->next        = Replay_NextOnBus(b, 0);
+        rn->node.PeekTx = Replay_PeekTx;
+        rn->node.TxDone = Replay_TxDone;
+        rn->node.ctx    = rn;
+        SimBus_Attach(&rn->node, b);
+        if (rn->next < replayFrameNum) Sim_TimerStart(&rn->wake, replayFrame[rn->next].t_ns, 0, Replay_Wake, rn);
+    }
+
+    uint64_t spanNs = replayFrameNum ? replayFrame[replayFrameNum - 1U].t_ns - REPLAY_START_NS : 0U;
+    if (scale > 0.0) Sim_SetRealtime(scale);
+
+    uint64_t wallStart = Sim_CpuNs();
+    Sim_RunFor(REPLAY_START_NS + spanNs + 10000000ULL);
+    uint64_t wallNs = Sim_CpuNs() - wallStart;
+
+    if (csv != NULL) fclose(csv);
+
+    uint32_t rxFrames = 0, dropFrames = 0, unhandled = 0;
+    uint64_t isrNs = 0;
+    for (uint8_t b = 0; b < SIM_BUS_NUM; b++)
+    {
+        CAN_Instance_t *can = b ? &can2 : &can1;
+        rxFrames   += can->rxRing[0].frame_cnt + can->rxRing[1].frame_cnt;
+        dropFrames += can->rxRing[0].drop_cnt + can->rxRing[1].drop_cnt;
+        unhandled  += can->rx_unhandled_cnt;
+        isrNs      += SimFdcan_IsrNs(b);
+    }
+
+    printf("replayed %u frames (%u on CAN1, %u on CAN2) spanning %.3f s in %.3f s wall\n",
+           replayNode[0].sent + replayNode[1].sent, replayNode[0].sent, replayNode[1].sent, spanNs / 1e9, wallNs / 1e9);
+    printf("rx: %u frames, %.0f ns/frame (isr %.0f + task %.0f), ring drop %u, unhandled %u\n",
+           rxFrames, rxFrames ? (double)(isrNs + taskNs) / rxFrames : 0.0,
+           rxFrames ? (double)isrNs / rxFrames : 0.0, rxFrames ? (double)taskNs / rxFrames : 0.0, dropFrames, unhandled);
+    for (uint8_t b = 0; b < SIM_BUS_NUM; b++)
+    {
+        for (uint8_t i = 0; i < REPLAY_MOTOR_ID_NUM; i++)
+        {
+            const Motor_t *m = motorAt[b][i];
+            if (m == NULL) continue;
+            printf("CAN%u motor 0x%03X: %u frames, last speed %d rpm, last output %d, max latency %u us\n", b + 1U,
+                   REPLAY_MOTOR_ID_MIN + i, motorFrames[b][i], m->rawData.speed_rpm, (int)m->treatedData.motor_output,
+                   m->treatedData.rx_latency_max);
+        }
+    }
+    if (control)
+    {
+        const MotorCycle_t *cycle = MotorCycle_Get();
+        const MotorTxGroup_t *group = MotorTxGroupGet(CAN1, 0x200);
+        printf("control: %u feedback-triggered cycles (%u partial), %u control frames 0x200 sent\n",
+               cycle->cycle_cnt, cycle->partial_cnt, group ? group->sent_cnt : 0U);
+    }
+
+    free(replayFrame);
+    return 0;
+}
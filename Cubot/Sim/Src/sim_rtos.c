@@ -0,0 +1,208 @@
+/**
+ **********************************************************************************
+ * @file        sim_rtos.c
+ * @brief       仿真层，被测代码用到的 FreeRTOS 接口
+ * @details     仿真为单线程，任务以“每轮主循环一次 Step”的方式运行：被任务通知唤醒或等待超时后
+ *              执行一次 Step，相当于任务从 ulTaskNotifyTake() 返回后跑完一轮循环再次阻塞。
+ *              系统节拍由仿真时间换算，与 configTICK_RATE_HZ 一致。
+ * @date        2026-10-16
+ * @version     V1.0
+ * @copyright   Copyright (c) 2021-2121  中国矿业大学CUBOT战队
+ **********************************************************************************
+ */
+#include "sim.h"
+#include "timers.h"
+
+#define SIM_TASK_MAX  8U
+#define SIM_TIMER_MAX 8U
+
+struct tskTaskControlBlock
+{
+    void (*Step)(void *arg);
+    void *arg;
+    uint64_t timeout_ns; //< 0表示只等通知
+    uint64_t wake_ns;
+    volatile uint32_t notify;
+};
+
+static struct tskTaskControlBlock simTask[SIM_TASK_MAX];
+static uint8_t simTaskNum;
+static TaskHandle_t simCurrentTask;
+
+/* 软件定时器直接在仿真时间上触发，回调相当于在定时器服务任务中运行 */
+struct tmrTimerControl
+{
+    Sim_Timer_t timer;
+    TickType_t period;
+    UBaseType_t autoReload;
+    void *id;
+    TimerCallbackFunction_t Callback;
+};
+
+static struct tmrTimerControl simSwTimer[SIM_TIMER_MAX];
+static uint8_t simSwTimerNum;
+
+/**
+ * @brief 创建仿真任务
+ * @param step: 任务主循环的一轮
+ * @param arg: Step 的参数
+ * @param timeoutMs: 等待通知的超时时间（毫秒），为0时只在收到通知后运行
+ * @retval 任务句柄，可写入 CAN_Instance_t.rxTask 等需要通知的地方，任务数已满时返回NULL
+ */
+TaskHandle_t SimTask_Create(void (*step)(void *), void *arg, uint32_t timeoutMs)
+{
+    if (simTaskNum >= SIM_TASK_MAX) return NULL;
+
+    TaskHandle_t task = &simTask[simTaskNum++];
+    task->Step       = step;
+    task->arg        = arg;
+    task->timeout_ns = (uint64_t)timeoutMs * 1000000ULL;
+    task->wake_ns    = Sim_NowNs();
+    task->notify     = 0;
+    return task;
+}
+
+uint64_t SimTask_NextWakeNs(void)
+{
+    uint64_t next = UINT64_MAX;
+
+    for (uint8_t i = 0; i < simTaskNum; i++)
+    {
+        if (simTask[i].notify != 0U) return Sim_NowNs();
+        if (simTask[i].timeout_ns != 0U && simTask[i].wake_ns < next) next = simTask[i].wake_ns;
+    }
+    return next;
+}
+
+/**
+ * @brief 按创建顺序运行所有就绪的任务
+ * @retval 1表示有任务运行
+ */
+uint8_t SimTask_RunReady(uint64_t nowNs)
+{
+    uint8_t ran = 0;
+
+    for (uint8_t i = 0; i < simTaskNum; i++)
+    {
+        TaskHandle_t task = &simTask[i];
+        if (task->notify == 0U && (task->timeout_ns == 0U || nowNs < task->wake_ns)) continue;
+
+        task->notify   = 0;
+        simCurrentTask = task;
+        task->Step(task->arg);
+        simCurrentTask = NULL;
+        task->wake_ns  = nowNs + task->timeout_ns;
+        ran = 1;
+    }
+    return ran;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(Sim_NowNs() / (1000000000ULL / configTICK_RATE_HZ));
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return simCurrentTask;
+}
+
+/* 仿真任务没有独立的栈 */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+{
+    (void)xTask;
+    return 0;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    xTaskToNotify->notify++;
+    if (pxHigherPriorityTaskWoken != NULL) *pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+/* 任务的阻塞等待由 SimTask 的通知/超时调度代替，Step 中不应调用，这里只取走已有的通知 */
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    (void)xTicksToWait;
+    if (simCurrentTask == NULL) return 0;
+
+    uint32_t value = simCurrentTask->notify;
+    simCurrentTask->notify = xClearCountOnExit ? 0U : (value ? value - 1U : 0U);
+    return value;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    (void)xTicksToDelay;
+}
+
+/* 只用到 xTaskNotifyGive() 的计数语义 */
+BaseType_t xTaskGenericNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction,
+                              uint32_t *pulPreviousNotificationValue)
+{
+    (void)ulValue;
+    (void)eAction;
+    if (pulPreviousNotificationValue != NULL) *pulPreviousNotificationValue = xTaskToNotify->notify;
+    xTaskToNotify->notify++;
+    return pdPASS;
+}
+
+static void SimSwTimer_Expired(void *ctx)
+{
+    TimerHandle_t timer = ctx;
+    timer->Callback(timer);
+}
+
+TimerHandle_t xTimerCreate(const char *const pcTimerName, const TickType_t xTimerPeriodInTicks,
+                           const UBaseType_t uxAutoReload, void *const pvTimerID, TimerCallbackFunction_t pxCallbackFunction)
+{
+    (void)pcTimerName;
+    if (simSwTimerNum >= SIM_TIMER_MAX || xTimerPeriodInTicks == 0U) return NULL;
+
+    TimerHandle_t timer = &simSwTimer[simSwTimerNum++];
+    timer->period     = xTimerPeriodInTicks;
+    timer->autoReload = uxAutoReload;
+    timer->id         = pvTimerID;
+    timer->Callback   = pxCallbackFunction;
+    return timer;
+}
+
+/* 只支持启动/复位/停止/修改周期，命令立即生效 */
+BaseType_t xTimerGenericCommand(TimerHandle_t xTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue,
+                                BaseType_t *const pxHigherPriorityTaskWoken, const TickType_t xTicksToWait)
+{
+    const uint64_t tickNs = 1000000000ULL / configTICK_RATE_HZ;
+    (void)xTicksToWait;
+
+    if (pxHigherPriorityTaskWoken != NULL) *pxHigherPriorityTaskWoken = pdFALSE;
+    switch (xCommandID)
+    {
+        case tmrCOMMAND_CHANGE_PERIOD:
+        case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR:
+            xTimer->period = xOptionalValue;
+            /* fall through */
+        case tmrCOMMAND_START:
+        case tmrCOMMAND_START_FROM_ISR:
+        case tmrCOMMAND_RESET:
+        case tmrCOMMAND_RESET_FROM_ISR:
+            Sim_TimerStart(&xTimer->timer, Sim_NowNs() + xTimer->period * tickNs,
+                           xTimer->autoReload ? xTimer->period * tickNs : 0U, SimSwTimer_Expired, xTimer);
+            return pdPASS;
+        case tmrCOMMAND_STOP:
+        case tmrCOMMAND_STOP_FROM_ISR:
+            Sim_TimerStop(&xTimer->timer);
+            return pdPASS;
+        default:
+            return pdFAIL;
+    }
+}
+
+void *pvTimerGetTimerID(const TimerHandle_t xTimer)
+{
+    return xTimer->id;
+}
@@ -2,6 +2,7 @@
 #define _CAN_TASK_H_
 
 void CanTask_Process(void *argument);
+void CanRecTask_Process(void *argument);
 
 
 
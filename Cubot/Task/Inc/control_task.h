@@ -2,6 +2,7 @@
 #define _CONTROL_TASK_H_
 
 
+void ControlStep(void);
 void Control_Task(void *argument);
 
 
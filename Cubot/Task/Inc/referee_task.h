@@ -3,6 +3,7 @@
 
 #include "stm32h7xx_hal.h"
 #include "driver_usart.h"
+#include "driver_monitor.h"
 
 #define OPEN_REFEREE 1
 
@@ -12,6 +13,8 @@
 #define frame_header_len 5
 #define pack_len 7 + referee2024.frame_info.head.data_len + 2
 #define BSP_USART3_DMA_RX_BUF_LEN 256
+#define REFEREE_DEGRADED_MS 200   // 超过该时间没有通过校验的数据包，裁判系统数据降级
+#define REFEREE_OFFLINE_MS  1000  // 超过该时间没有通过校验的数据包，判为离线
 
 #define BYTE0(dwTemp) (*(char *)(&dwTemp))
 #define BYTE1(dwTemp) (*((char *)(&dwTemp) + 1))
@@ -20,7 +23,7 @@
 
 typedef struct
 {
-	int16_t online_cnt;
+	Monitor_Node_t monitor; // 离线检测节点，每个通过校验的数据包为一次心跳
 	struct
 	{
 		struct
@@ -94,6 +94,7 @@ void Chassis_Task(void *argument);
 void Holder_Task(void *argument);
 void Print_Task(void *argument);
 void Brain_Task(void *argument);
-void ShootInit(Shoot_t *shoot);
+uint8_t ShootInit(Shoot_t *shoot);
+void ShootStep(Shoot_t *shoot);
 #endif
 
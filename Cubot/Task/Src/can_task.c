@@ -1,5 +1,7 @@
 #include "can_task.h"
 #include "driver_can.h"
+#include "driver_can_tp.h"
+#include "driver_can_rec.h"
 #include "rm_motor.h"
 #include "init_task.h"
 
@@ -7,25 +9,36 @@ UBaseType_t uxHighWaterMark_can;
 /**
  * @brief 解算CAN通信数据任务函数
  * @param argument 任务参数，指向CAN实例结构体的指针
- * @note 该函数为RTOS任务函数，用于处理CAN总线数据接收和处理
+ * @note 该函数为RTOS任务函数，用于处理CAN总线数据接收和处理。
+ *       接收中断每搬运完一批报文发送一次任务通知，本任务被唤醒后一次性取完环形缓冲区。
  */
 void CanTask_Process(void *argument)
 {
     CAN_Instance_t *can = argument;
-    CAN_RxBuffer_t task_local_buffer;
+    const CAN_RxFrame_t *frame;
+
+    /* 登记为该CAN设备接收环形缓冲区的消费者 */
+    can->rxTask = xTaskGetCurrentTaskHandle();
+
     /* 任务主循环 */
     while(1)
     {
-        /* 等待并从CAN接收队列中获取数据，获取成功后进行相应处理 */
-        if (xQueueReceive(can->xQueueCan, &task_local_buffer, portMAX_DELAY) == pdTRUE)
-        {   
-            /* 根据CAN实例类型调用对应的电机接收回调函数 */
-            if(can == &can1)
-                MotorProcess(&can1, &task_local_buffer);
-            else if(can == &can2)
-                MotorProcess(&can2, &task_local_buffer);
+        /* 取完当前环形缓冲区内的所有报文 */
+        while ((frame = CAN_RxPeek(can)) != NULL)
+        {
+            CAN_Dispatch(can, frame);
+            CAN_RxRelease(can, frame);
         }
-        
+
+        /* 推进分段传输的连续帧发送和超时检测 */
+        CANTP_Poll(can);
+
+        /* 更新总线健康统计，处理总线关闭恢复 */
+        CAN_HealthPoll(can);
+
+        /* 等待接收中断通知下一批报文，总线静默时也按 CAN_HEALTH_POLL_MS 醒来检查总线状态 */
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CAN_HEALTH_POLL_MS));
+
         /* 获取任务堆栈使用情况，用于监控任务堆栈使用峰值 */
         #ifdef DEBUG
         uxHighWaterMark_can = uxTaskGetStackHighWaterMark(NULL);
@@ -33,3 +46,42 @@ void CanTask_Process(void *argument)
     }
 }
 
+#if CAN_REC_ENABLE
+#define CAN_REC_DUMP_CHUNK   32U   // 每次串口发送的条目数
+#define CAN_REC_DUMP_POLL_MS 100U  // 查询记录器是否冻结的间隔
+
+/**
+ * @brief CAN记录导出任务函数
+ * @param argument 任务参数，指向导出用串口句柄的指针
+ * @note  记录器冻结（CAN_REC_HOLD）后以阻塞方式从串口发出 CAN_RecHeader_t 和全部条目，完成后重新开始记录。
+ *        主机端保存串口数据后用 Cubot/Sim 中的 cubot_replay 回放
+ */
+void CanRecTask_Process(void *argument)
+{
+    UART_HandleTypeDef *huart = argument;
+    static CAN_RecEntry_t chunk[CAN_REC_DUMP_CHUNK];
+    CAN_RecReader_t reader;
+    CAN_RecHeader_t header = {
+        .magic      = CAN_REC_MAGIC,
+        .version    = CAN_REC_VERSION,
+        .entry_size = sizeof(CAN_RecEntry_t),
+    };
+    uint32_t n;
+
+    while(1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(CAN_REC_DUMP_POLL_MS));
+        if (CAN_RecGetState() != CAN_REC_HOLD) continue;
+
+        /* 冻结期间不再写入，条目数即导出数 */
+        header.entry_num = CAN_RecReaderInit(&reader);
+        HAL_UART_Transmit(huart, (uint8_t *)&header, sizeof(header), HAL_MAX_DELAY);
+        while ((n = CAN_RecRead(&reader, chunk, CAN_REC_DUMP_CHUNK)) > 0U)
+        {
+            HAL_UART_Transmit(huart, (uint8_t *)chunk, n * sizeof(CAN_RecEntry_t), HAL_MAX_DELAY);
+        }
+
+        CAN_RecStart();
+    }
+}
+#endif
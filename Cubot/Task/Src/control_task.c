@@ -3,30 +3,42 @@
 #include "init_task.h"
 #include "projdefs.h"
 #include "rm_motor.h"
+#include "motor_cycle.h"
+#include "motor_derate.h"
 
 UBaseType_t uxHighWaterMark_control_task;
 
 /**
- * @brief 控制任务函数，周期性执行电机控制逻辑
+ * @brief 控制任务的一个周期：发出本周期填写过的控制帧并更新降额，不阻塞
+ * @note  Control_Task 每次被反馈唤醒（或等待超时）后调用一次；主机端回放工具 cubot_replay 按同样的触发调用
+ */
+void ControlStep(void)
+{
+    // 通过CAN总线输出电机控制指令，只发送有电机注册且本周期填写过的控制帧
+    MotorFlush(&can1);
+    MotorFlush(&can2);
+    MotorCycle_Actuated();
+
+    // 控制帧发出后更新温度与电流降额，新的限幅从下一周期生效
+    MotorDerate_Update();
+}
+
+/**
+ * @brief 控制任务函数，电机反馈到齐后输出电机控制指令
  * @param argument 任务参数指针（未使用）
- * @note 该函数为FreeRTOS任务函数，周期性执行PID控制算法并输出电机控制指令
+ * @note 该函数为FreeRTOS任务函数，优先级低于填写控制量的任务，同一周期被唤醒时在它们之后发送；
+ *       反馈未到齐时按 MOTOR_CYCLE_TIMEOUT_MS 超时继续运行
  */
 void Control_Task(void *argument) { 
     (void) argument;
-    TickType_t xLastWakeTime  = xTaskGetTickCount();
+    MotorCycle_Subscribe(xTaskGetCurrentTaskHandle());
     while(1) {
 
-        // 通过CAN总线输出电机控制指令
-        MotorCanOutput(can1, 0x200);
-        MotorCanOutput(can1, 0x1FF);
-        MotorCanOutput(can2, 0x200);
-        MotorCanOutput(can2, 0x1FF);
+        // 等待本周期所有电机的反馈到齐
+        MotorCycle_Wait();
 
-        
-        // 任务延时，确保1ms周期执行
-        vTaskDelayUntil(&xLastWakeTime , pdMS_TO_TICKS(1));
+        ControlStep();
 
-        
         uxHighWaterMark_control_task = uxTaskGetStackHighWaterMark(NULL);
     }
 }
@@ -3,14 +3,36 @@
 #include "control_task.h"
 #include "driver_usart.h"
 #include "driver_can.h"
+#include "driver_can_rec.h"
+#include "driver_timebase.h"
+#include "driver_monitor.h"
 #include "referee_task.h"
 #include "rm_motor.h"
 #include "shoot_task.h"
 #include "uart_task.h"
 #include "can_task.h"
 #include "control_task.h"
+#include "pid.h"
 
 UBaseType_t uxHighWaterMark_init;
+#ifdef DEBUG
+PIDBank_Bench_t pidBankBench; //< PID组与逐个单环PID的DWT耗时对比，用调试器查看
+#endif
+
+/**
+ * @brief CAN硬件过滤器表
+ * @note  高频的电机反馈（0x201-0x20B）进入FIFO0；低频报文（超级电容、板间通信等）按需追加表项指向FIFO1，
+ *        FIFO0元素只有8字节，板间CAN FD报文必须指向FIFO1；
+ *        表外报文由全局过滤器拒收，不占用中断
+ */
+static const CAN_FilterConfig_t can1Filter[] = {
+    {FDCAN_FILTER_RANGE, 0x201, 0x20B, FDCAN_FILTER_TO_RXFIFO0},
+};
+static const CAN_FilterConfig_t can2Filter[] = {
+    {FDCAN_FILTER_RANGE, 0x201, 0x20B, FDCAN_FILTER_TO_RXFIFO0},
+};
+_Static_assert(sizeof(can1Filter) / sizeof(can1Filter[0]) <= CAN1_STD_FILTER_NUM, "can1Filter exceeds CAN1_STD_FILTER_NUM");
+_Static_assert(sizeof(can2Filter) / sizeof(can2Filter[0]) <= CAN2_STD_FILTER_NUM, "can2Filter exceeds CAN2_STD_FILTER_NUM");
 
 static void BasePID_Init_All(void)
 {
@@ -33,11 +55,27 @@ void Init_Task(void *argument)
     UARTx_Init(&uart3);
     UARTx_Init(&uart4);
     UARTx_Init(&uart5);
-    /* 初始化CAN硬件并打开CAN设备 */
+    /* 微秒时基须先于CAN启动，接收时间戳依赖它 */
+    Timebase_Init();
+    #ifdef DEBUG
+    PIDBank_Benchmark(&pidBankBench);
+    #endif
+    #if CAN_REC_ENABLE
+    /* CAN收发记录器，总线关闭时自动冻结 */
+    CAN_RecInit();
+    CAN_RecStart();
+    #endif
+    /* 节点离线检测定时器 */
+    Monitor_Init();
+    /* 初始化CAN硬件并打开CAN设备；过滤器超出硬件容量或控制器启动失败时在上电时暴露 */
     CANx_Init(&hfdcan1, CAN1_rxCallBack);
 	CANx_Init(&hfdcan2, CAN2_rxCallBack);
-	CAN_Open(&can1);
-	CAN_Open(&can2);
+	if (CAN_Open(&can1, can1Filter, sizeof(can1Filter) / sizeof(can1Filter[0]))) Error_Handler();
+	if (CAN_Open(&can2, can2Filter, sizeof(can2Filter) / sizeof(can2Filter[0]))) Error_Handler();
+    /* 初始化电机驱动，须在注册电机之前 */
+    Motor_DriverInit();
+    /* 注册发射机构电机，Shoot_Task 每个周期向它们填写控制量；电机ID冲突等配置错误在上电时暴露 */
+    if (ShootInit(&heroShoot)) Error_Handler();
 
     BasePID_Init_All();
     /* 创建UART任务用于收发数据 */
@@ -47,13 +85,17 @@ void Init_Task(void *argument)
     /* 创建CAN任务用于接收数据 */
     xTaskCreate(CanTask_Process, "CanTask_Process", 256, &can1, osPriorityNormal+1, NULL);
     xTaskCreate(CanTask_Process, "CanTask_Process", 256, &can2, osPriorityNormal+1, NULL);
+    #if CAN_REC_ENABLE
+    /* 创建CAN记录导出任务，冻结后从USART6导出 */
+    xTaskCreate(CanRecTask_Process, "CanRecTask", 256, &huart6, osPriorityLow, NULL);
+    #endif
     /* 创建运动学解算任务用于处理数据 */
     xTaskCreate(Shoot_Task,"Shoot_Task",256,NULL,osPriorityNormal,NULL);
     xTaskCreate(Chassis_Task,"Chassis_Task",256,NULL,osPriorityNormal,NULL);
     xTaskCreate(Holder_Task,"Holder_Task",512,NULL,osPriorityNormal,NULL);
+    /* 创建控制输出任务，优先级低于上面的解算任务，同一控制周期内在它们填写控制量之后发送 */
+    xTaskCreate(Control_Task,"Control_Task",256,NULL,osPriorityNormal-1,NULL);
 
-    /* 初始化电机驱动任务 */
-    Motor_DriverInit();
     xTaskResumeAll();
 
     #ifdef DEBUG
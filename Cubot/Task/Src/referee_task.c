@@ -14,7 +14,6 @@ uint8_t meta_data[BSP_USART3_DMA_RX_BUF_LEN];
 uint8_t temp[15];
 static uint8_t Refereedata_process(uint8_t *data, uint16_t len) 
 {
-    referee2024.online_cnt = 0;
     static uint32_t Verify_CRC8_OK;
     static uint32_t Verify_CRC16_OK;
     uint16_t i = 0;
@@ -49,6 +48,7 @@ static uint8_t Refereedata_process(uint8_t *data, uint16_t len)
 
 		if (Verify_CRC8_OK && Verify_CRC16_OK) 
 		{
+			Monitor_Beat(&referee2024.monitor);
 			if (i < 200) 
 			{
 				memcpy(ref_packge[i], data, total_packet_size);
@@ -393,6 +393,7 @@ void Referee_Task(void *argument)
 	(void)argument;
 	size_t receivedBytes;
 	uint8_t task_local_buffer[200];
+	Monitor_Register(&referee2024.monitor, "referee", REFEREE_DEGRADED_MS, REFEREE_OFFLINE_MS);
 	while(1)
     {
 		receivedBytes = xStreamBufferReceive(uart3.stream_buffer, task_local_buffer, sizeof(task_local_buffer), portMAX_DELAY);
@@ -1,6 +1,8 @@
 #include "shoot_task.h"
 #include "user_lib.h"
 #include "referee_task.h"
+#include "motor_cycle.h"
+#include "motor_derate.h"
 
 void Chassis_Task(void *argument)
 {
@@ -37,13 +39,24 @@ Shoot_t heroShoot=
 /**
  * @brief 电机初始化
  * @param shoot	
+ * @retval 0 成功，1 有电机注册失败（反馈ID重复、超出订阅/监测表容量）或降额表已满
  */
-void ShootInit(Shoot_t *shoot)
+uint8_t ShootInit(Shoot_t *shoot)
 {
-    MotorInit(&shoot->booster.top.m3508   , 0, Motor3508, 1, CAN1, 0x201);
-	MotorInit(&shoot->booster.left.m3508  , 0, Motor3508, 1, CAN1, 0x202);
-	MotorInit(&shoot->booster.right.m3508 , 0, Motor3508, 1, CAN1, 0x203);
-	MotorInit(&shoot->loader.m3508        , 0, Motor3508, 1, CAN1, 0x204);	
+	uint8_t ret = 0;
+
+    ret |= MotorInit(&shoot->booster.top.m3508   , 0, Motor3508, 1, CAN1, 0x201);
+	ret |= MotorInit(&shoot->booster.left.m3508  , 0, Motor3508, 1, CAN1, 0x202);
+	ret |= MotorInit(&shoot->booster.right.m3508 , 0, Motor3508, 1, CAN1, 0x203);
+	ret |= MotorInit(&shoot->loader.m3508        , 0, Motor3508, 27, CAN1, 0x204);	
+	if (ret) return 1;
+
+	// 摩擦轮长时间高速运行，按温度和电流降额，避免过热后电调保护断电
+	ret |= MotorDerate_Register(&shoot->booster.top.m3508  , NULL);
+	ret |= MotorDerate_Register(&shoot->booster.left.m3508 , NULL);
+	ret |= MotorDerate_Register(&shoot->booster.right.m3508, NULL);
+	ret |= MotorDerate_Register(&shoot->loader.m3508       , NULL);
+	return ret;
 }
 
 /**
@@ -152,20 +165,13 @@ void ShootInit(Shoot_t *shoot)
  */
 static void GetLoadData(Shoot_t *shoot)
 {
-	if(xSemaphoreTake(shoot->loader.m3508.treatedData.dataMutex, portMAX_DELAY) == pdTRUE)
-	{
-		shoot->loader.angle = shoot->loader.m3508.treatedData.angle;
-		
-		xSemaphoreGive(shoot->loader.m3508.treatedData.dataMutex);
-	}
-		if((shoot->loader.angle < -100) && (shoot->loader.last_angle > 100))
-			shoot->loader.total_angle += 360 + shoot->loader.angle - shoot->loader.last_angle;
-		else if(( shoot->loader.angle > 100) && (shoot->loader.last_angle < -100))
-			shoot->loader.total_angle += -360 + shoot->loader.angle - shoot->loader.last_angle;
-		else 
-			shoot->loader.total_angle += shoot->loader.angle-shoot->loader.last_angle;
-		shoot->loader.last_angle = shoot->loader.angle;
-		shoot->loader.axis_angle = shoot->loader.total_angle/27.0f;
+	MotorSnapshot_t snap;
+
+	MotorGetSnapshot(&shoot->loader.m3508, &snap);
+	shoot->loader.last_angle  = shoot->loader.angle;
+	shoot->loader.angle       = snap.angle;
+	shoot->loader.total_angle = snap.total_angle;
+	shoot->loader.axis_angle  = snap.axis_total_angle; // 拨弹盘减速比27，在ShootInit()中设置
 		
 		if(shoot->shootFlag.load_start == 1 && shoot->shootFlag.jam == 0)
 		{
@@ -290,27 +296,49 @@ static void ShootOutputCtrl(Shoot_t *shoot)
 }
 
 UBaseType_t uxHighWaterMark_shoot;
+uint32_t shootFillCycles;      //< 最近一次ShootOutputCtrl()的耗时（内核周期，DWT测量）
+uint32_t shootFillCyclesMax;   //< 上述耗时的最大值
+
+/**
+ * @brief 发射机构的一个控制周期：读取反馈、计算并填写控制量，不阻塞
+ * @param shoot
+ * @note  Shoot_Task 每次被反馈唤醒时调用一次；主机端回放工具 cubot_replay 按同样的触发调用，复现控制过程
+ */
+void ShootStep(Shoot_t *shoot)
+{
+	// if (rc_Ctrl.is_online == 1)
+	// 	Loadcontrol(shoot);
+	// else
+	// {
+	// 	shoot->loader.m3508.treatedData.motor_output = 0;
+	// 	shoot->loader.axis_angle                     = 0;
+	// 	shoot->loader.total_angle                    = 0;
+	// 	shoot->shootFlag.load_start                  = 0;
+	// }
+	ShootGetData(shoot);
+	// ShootControl(shoot,&rc_Ctrl);
+	#ifdef DEBUG
+	uint32_t fillStart = Timebase_Cycles();
+	#endif
+	ShootOutputCtrl(shoot);
+	#ifdef DEBUG
+	shootFillCycles = Timebase_Cycles() - fillStart;
+	if (shootFillCycles > shootFillCyclesMax) shootFillCyclesMax = shootFillCycles;
+	#endif
+}
+
 void Shoot_Task(void *argument)
 {
     (void)argument;
 
 #if(SHOOT_ENABLE == 1)
+	MotorCycle_Subscribe(xTaskGetCurrentTaskHandle());
 	while(1)
 	{
-		// if (rc_Ctrl.is_online == 1)
-		// 	Loadcontrol(&heroShoot);
-		// else
-		// {
-		// 	heroShoot.loader.m3508.treatedData.motor_output = 0;
-		// 	heroShoot.loader.axis_angle                     = 0;
-		// 	heroShoot.loader.total_angle                    = 0;
-		// 	heroShoot.shootFlag.load_start                  = 0;
-		// }
-		ShootGetData(&heroShoot);
-		// ShootControl(&heroShoot,&rc_Ctrl);
-		ShootOutputCtrl(&heroShoot);
+		ShootStep(&heroShoot);
 
-		vTaskDelay(1);
+		// 等待下一批电机反馈到齐
+		MotorCycle_Wait();
 
 		#ifdef DEBUG
     	uxHighWaterMark_shoot = uxTaskGetStackHighWaterMark(NULL);